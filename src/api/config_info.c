@@ -995,6 +995,13 @@ extern void *slurm_ctl_conf_2_key_pairs (slurm_ctl_conf_t* slurm_ctl_conf_ptr)
 	key_pair->value = xstrdup(tmp_str);
 	list_append(ret_list, key_pair);
 
+	snprintf(tmp_str, sizeof(tmp_str), "%u",
+		 slurm_ctl_conf_ptr->slurmstepd_pool_size);
+	key_pair = xmalloc(sizeof(config_key_pair_t));
+	key_pair->name = xstrdup("SlurmstepdPoolSize");
+	key_pair->value = xstrdup(tmp_str);
+	list_append(ret_list, key_pair);
+
 	snprintf(tmp_str, sizeof(tmp_str), "%u",
 		 slurm_ctl_conf_ptr->sched_log_level);
 	key_pair = xmalloc(sizeof(config_key_pair_t));
@@ -1331,6 +1338,11 @@ void slurm_print_slurmd_status (FILE* out,
 
 	fprintf(out, "Slurmd PID               = %u\n",
 		slurmd_status_ptr->pid);
+	fprintf(out, "RPC threads              = %u\n",
+		slurmd_status_ptr->rpc_threads);
+	fprintf(out, "RPC queue depth          = %u (max %u)\n",
+		slurmd_status_ptr->rpc_queue_depth,
+		slurmd_status_ptr->rpc_queue_max);
 	fprintf(out, "Slurmd Debug             = %u\n",
 		slurmd_status_ptr->slurmd_debug);
 	fprintf(out, "Slurmd Logfile           = %s\n",
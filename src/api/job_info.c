@@ -917,6 +917,148 @@ slurm_load_jobs (time_t update_time, job_info_msg_t **job_info_msg_pptr,
 	return SLURM_PROTOCOL_SUCCESS;
 }
 
+/* Compare job records by job ID for qsort() and bsearch() */
+static int _cmp_job_id(const void *x, const void *y)
+{
+	const job_info_t *job1 = (const job_info_t *) x;
+	const job_info_t *job2 = (const job_info_t *) y;
+
+	if (job1->job_id < job2->job_id)
+		return -1;
+	if (job1->job_id > job2->job_id)
+		return 1;
+	return 0;
+}
+
+/*
+ * Build job information from the unchanged records of old_ptr and the
+ *	changed records in delta_ptr, ordered as the controller's job_ids list.
+ *	Records used are moved out of both old_ptr and delta_ptr.
+ * RET merged job information or NULL if the delta does not apply to old_ptr
+ */
+static job_info_msg_t *_merge_job_delta(job_info_msg_t *old_ptr,
+					job_info_delta_msg_t *delta_ptr)
+{
+	job_info_msg_t *new_ptr, *chg_ptr = delta_ptr->job_info_msg;
+	job_info_t key, *job_ptr, **src_ptr;
+	bool *old_used;
+	uint32_t i;
+
+	qsort(old_ptr->job_array, old_ptr->record_count, sizeof(job_info_t),
+	      _cmp_job_id);
+	qsort(chg_ptr->job_array, chg_ptr->record_count, sizeof(job_info_t),
+	      _cmp_job_id);
+
+	/* Locate the source of every record before moving any of them */
+	src_ptr = xmalloc(sizeof(job_info_t *) * delta_ptr->job_id_cnt);
+	old_used = xmalloc(sizeof(bool) * (old_ptr->record_count + 1));
+	for (i = 0; i < delta_ptr->job_id_cnt; i++) {
+		key.job_id = delta_ptr->job_ids[i];
+		job_ptr = bsearch(&key, chg_ptr->job_array,
+				  chg_ptr->record_count, sizeof(job_info_t),
+				  _cmp_job_id);
+		if (!job_ptr) {
+			job_ptr = bsearch(&key, old_ptr->job_array,
+					  old_ptr->record_count,
+					  sizeof(job_info_t), _cmp_job_id);
+			if (!job_ptr) {
+				xfree(src_ptr);
+				xfree(old_used);
+				return NULL;
+			}
+			old_used[job_ptr - old_ptr->job_array] = true;
+		}
+		src_ptr[i] = job_ptr;
+	}
+
+	new_ptr = xmalloc(sizeof(job_info_msg_t));
+	new_ptr->last_update  = chg_ptr->last_update;
+	new_ptr->record_count = delta_ptr->job_id_cnt;
+	new_ptr->job_array = xmalloc(sizeof(job_info_t) *
+				     (delta_ptr->job_id_cnt + 1));
+	for (i = 0; i < delta_ptr->job_id_cnt; i++) {
+		memcpy(&new_ptr->job_array[i], src_ptr[i],
+		       sizeof(job_info_t));
+	}
+
+	/* Release records of jobs no longer reported */
+	for (i = 0; i < old_ptr->record_count; i++) {
+		if (!old_used[i])
+			slurm_free_job_info_members(&old_ptr->job_array[i]);
+	}
+	xfree(old_ptr->job_array);
+	old_ptr->record_count = 0;
+	xfree(chg_ptr->job_array);
+	chg_ptr->record_count = 0;
+
+	xfree(src_ptr);
+	xfree(old_used);
+	return new_ptr;
+}
+
+/*
+ * slurm_load_jobs_delta - issue RPC to get slurm information about jobs
+ *	changed since old_job_info_ptr was loaded and merge it with the old
+ *	information, transferring only the changed job records
+ * IN/OUT old_job_info_ptr - job information previously loaded using
+ *	slurm_load_jobs() or slurm_load_jobs_delta() with the same show_flags.
+ *	On success its job records are moved into the new response, but it
+ *	must still be freed using slurm_free_job_info_msg
+ * IN/OUT job_info_msg_pptr - place to store a job configuration pointer
+ * IN show_flags - job filtering options
+ * RET 0 or -1 on error, errno is SLURM_NO_CHANGE_IN_DATA if nothing changed
+ * NOTE: free the response using slurm_free_job_info_msg
+ */
+extern int
+slurm_load_jobs_delta (job_info_msg_t *old_job_info_ptr,
+		       job_info_msg_t **job_info_msg_pptr, uint16_t show_flags)
+{
+	int rc;
+	slurm_msg_t resp_msg;
+	slurm_msg_t req_msg;
+	job_info_request_msg_t req;
+	job_info_delta_msg_t *delta_ptr;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+
+	req.last_update  = old_job_info_ptr->last_update;
+	req.show_flags   = show_flags | SHOW_DELTA;
+	req_msg.msg_type = REQUEST_JOB_INFO;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_JOB_INFO:		/* full response */
+		*job_info_msg_pptr = (job_info_msg_t *)resp_msg.data;
+		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		delta_ptr = (job_info_delta_msg_t *) resp_msg.data;
+		*job_info_msg_pptr = _merge_job_delta(old_job_info_ptr,
+						      delta_ptr);
+		slurm_free_job_info_delta_msg(delta_ptr);
+		if (*job_info_msg_pptr == NULL) {
+			/* Old information was not loaded with these options */
+			return slurm_load_jobs((time_t) 0, job_info_msg_pptr,
+					       show_flags);
+		}
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		break;
+	}
+
+	return SLURM_PROTOCOL_SUCCESS;
+}
+
 /*
  * slurm_load_job_user - issue RPC to get slurm information about all jobs
  *	to be run as the specified user
@@ -414,6 +414,104 @@ extern int slurm_load_node (time_t update_time,
 	return SLURM_PROTOCOL_SUCCESS;
 }
 
+/*
+ * Apply the changed node records in delta_ptr to old_ptr and move the
+ *	resulting records into a new node information message
+ * RET merged node information or NULL if the delta does not apply to old_ptr
+ */
+static node_info_msg_t *_merge_node_delta(node_info_msg_t *old_ptr,
+					  node_info_delta_msg_t *delta_ptr)
+{
+	node_info_msg_t *new_ptr, *chg_ptr = delta_ptr->node_info_msg;
+	uint32_t i, inx;
+
+	if (delta_ptr->node_cnt != old_ptr->record_count)
+		return NULL;
+	for (i = 0; i < delta_ptr->node_inx_cnt; i++) {
+		if (delta_ptr->node_inx[i] >= old_ptr->record_count)
+			return NULL;
+	}
+
+	for (i = 0; i < delta_ptr->node_inx_cnt; i++) {
+		inx = delta_ptr->node_inx[i];
+		slurm_free_node_info_members(&old_ptr->node_array[inx]);
+		memcpy(&old_ptr->node_array[inx], &chg_ptr->node_array[i],
+		       sizeof(node_info_t));
+	}
+	xfree(chg_ptr->node_array);
+	chg_ptr->record_count = 0;
+
+	new_ptr = xmalloc(sizeof(node_info_msg_t));
+	new_ptr->last_update  = chg_ptr->last_update;
+	new_ptr->node_scaling = chg_ptr->node_scaling;
+	new_ptr->record_count = old_ptr->record_count;
+	new_ptr->node_array   = old_ptr->node_array;
+	old_ptr->node_array   = NULL;
+	old_ptr->record_count = 0;
+
+	return new_ptr;
+}
+
+/*
+ * slurm_load_node_delta - issue RPC to get slurm information about nodes
+ *	changed since old_node_info_ptr was loaded and merge it with the old
+ *	information, transferring only the changed node records
+ * IN/OUT old_node_info_ptr - node information previously loaded using
+ *	slurm_load_node() or slurm_load_node_delta() with the same show_flags.
+ *	On success its node records are moved into the new response, but it
+ *	must still be freed using slurm_free_node_info_msg
+ * OUT resp - place to store a node configuration pointer
+ * IN show_flags - node filtering options
+ * RET 0 or a slurm error code, SLURM_NO_CHANGE_IN_DATA if nothing changed
+ * NOTE: free the response using slurm_free_node_info_msg
+ */
+extern int slurm_load_node_delta (node_info_msg_t *old_node_info_ptr,
+				  node_info_msg_t **resp, uint16_t show_flags)
+{
+	int rc;
+	slurm_msg_t req_msg;
+	slurm_msg_t resp_msg;
+	node_info_request_msg_t req;
+	node_info_delta_msg_t *delta_ptr;
+
+	slurm_msg_t_init(&req_msg);
+	slurm_msg_t_init(&resp_msg);
+	req.last_update  = old_node_info_ptr->last_update;
+	req.show_flags   = show_flags | SHOW_DELTA;
+	req_msg.msg_type = REQUEST_NODE_INFO;
+	req_msg.data     = &req;
+
+	if (slurm_send_recv_controller_msg(&req_msg, &resp_msg) < 0)
+		return SLURM_ERROR;
+
+	switch (resp_msg.msg_type) {
+	case RESPONSE_NODE_INFO:	/* full response */
+		*resp = (node_info_msg_t *) resp_msg.data;
+		break;
+	case RESPONSE_NODE_INFO_DELTA:
+		delta_ptr = (node_info_delta_msg_t *) resp_msg.data;
+		*resp = _merge_node_delta(old_node_info_ptr, delta_ptr);
+		slurm_free_node_info_delta_msg(delta_ptr);
+		if (*resp == NULL) {
+			/* Node table changed, for example by reconfiguration */
+			return slurm_load_node((time_t) 0, resp, show_flags);
+		}
+		break;
+	case RESPONSE_SLURM_RC:
+		rc = ((return_code_msg_t *) resp_msg.data)->return_code;
+		slurm_free_return_code_msg(resp_msg.data);
+		if (rc)
+			slurm_seterrno_ret(rc);
+		*resp = NULL;
+		break;
+	default:
+		slurm_seterrno_ret(SLURM_UNEXPECTED_MSG_ERROR);
+		break;
+	}
+
+	return SLURM_PROTOCOL_SUCCESS;
+}
+
 /*
  * slurm_load_node_single - issue RPC to get slurm configuration information
  *	for a specific node
@@ -88,6 +88,7 @@ static int      _read_io_init_msg(int fd, client_io_t *cio, char *host);
 static int      _wid(int n);
 static bool     _incoming_buf_free(client_io_t *cio);
 static bool     _outgoing_buf_free(client_io_t *cio);
+static void     _free_outgoing_msg(struct io_buf *msg, client_io_t *cio);
 
 /**********************************************************************
  * Listening socket declarations
@@ -314,7 +315,7 @@ _server_read(eio_obj_t *obj, List objs)
 			obj->fd = -1;
 			s->in_eof = true;
 			s->out_eof = true;
-			list_enqueue(s->cio->free_outgoing, s->in_msg);
+			_free_outgoing_msg(s->in_msg, s->cio);
 			s->in_msg = NULL;
 			return SLURM_SUCCESS;
 		}
@@ -322,7 +323,7 @@ _server_read(eio_obj_t *obj, List objs)
 			if (s->cio->sls)
 				step_launch_clear_questionable_state(
 					s->cio->sls, s->node_id);
-			list_enqueue(s->cio->free_outgoing, s->in_msg);
+			_free_outgoing_msg(s->in_msg, s->cio);
 			s->in_msg = NULL;
 			s->testing_connection = false;
 			return SLURM_SUCCESS;
@@ -338,7 +339,7 @@ _server_read(eio_obj_t *obj, List objs)
 					"header");
 			} else
 				error("Unrecognized output message type");
-			list_enqueue(s->cio->free_outgoing, s->in_msg);
+			_free_outgoing_msg(s->in_msg, s->cio);
 			s->in_msg = NULL;
 			return SLURM_SUCCESS;
 		}
@@ -382,7 +383,7 @@ _server_read(eio_obj_t *obj, List objs)
 			obj->fd = -1;
 			s->in_eof = true;
 			s->out_eof = true;
-			list_enqueue(s->cio->free_outgoing, s->in_msg);
+			_free_outgoing_msg(s->in_msg, s->cio);
 			s->in_msg = NULL;
 			return SLURM_SUCCESS;
 		}
@@ -408,11 +409,13 @@ _server_read(eio_obj_t *obj, List objs)
 		else
 			obj = s->cio->stderr_obj;
 		info = (struct file_write_info *) obj->arg;
-		if (info->eof)
+		if (info->eof) {
 			/* this output is closed, discard message */
-			list_enqueue(s->cio->free_outgoing, s->in_msg);
-		else
+			_free_outgoing_msg(s->in_msg, s->cio);
+		} else {
 			list_enqueue(info->msg_queue, s->in_msg);
+			eio_obj_changed(s->cio->eio, obj);
+		}
 
 		s->in_msg = NULL;
 	}
@@ -507,6 +510,8 @@ again:
 		pthread_mutex_lock(&s->cio->ioservers_lock);
 		list_enqueue(s->cio->free_incoming, s->out_msg);
 		pthread_mutex_unlock(&s->cio->ioservers_lock);
+		if (s->cio->stdin_obj)
+			eio_obj_changed(s->cio->eio, s->cio->stdin_obj);
 	} else
 		debug3("  Could not free msg!!");
 	s->out_msg = NULL;
@@ -588,7 +593,7 @@ static int _file_write(eio_obj_t *obj, List objs)
 					        info->out_msg->header.gtaskid,
 					        info->cio->label,
 					        info->cio->label_width)) < 0) {
-			list_enqueue(info->cio->free_outgoing, info->out_msg);
+			_free_outgoing_msg(info->out_msg, info->cio);
 			info->eof = true;
 			return SLURM_ERROR;
 		}
@@ -603,7 +608,7 @@ static int _file_write(eio_obj_t *obj, List objs)
 	 */
 	info->out_msg->ref_count--;
 	if (info->out_msg->ref_count == 0)
-		list_enqueue(info->cio->free_outgoing, info->out_msg);
+		_free_outgoing_msg(info->out_msg, info->cio);
 	info->out_msg = NULL;
 	debug2("Leaving  _file_write");
 
@@ -748,6 +753,8 @@ again:
 			else {
 				server = info->cio->ioserver[i]->arg;
 				list_enqueue(server->msg_queue, msg);
+				eio_obj_changed(info->cio->eio,
+						info->cio->ioserver[i]);
 			}
 		}
 	} else if (header.type == SLURM_IO_STDIN) {
@@ -763,6 +770,8 @@ again:
 		} else {
 			server = info->cio->ioserver[nodeid]->arg;
 			list_enqueue(server->msg_queue, msg);
+			eio_obj_changed(info->cio->eio,
+					info->cio->ioserver[nodeid]);
 		}
 	} else {
 		fatal("Unsupported header.type");
@@ -1059,6 +1068,18 @@ _outgoing_buf_free(client_io_t *cio)
 	return false;
 }
 
+/* Return msg to the free outgoing buffers.  Servers stop reading while
+ * every buffer is in use, so kick the event IO engine when the first one
+ * is back. */
+static void
+_free_outgoing_msg(struct io_buf *msg, client_io_t *cio)
+{
+	list_enqueue(cio->free_outgoing, msg);
+	if ((list_count(cio->free_outgoing) == 1) &&
+	    (cio->outgoing_count >= STDIO_MAX_FREE_BUF))
+		eio_signal_wakeup(cio->eio);
+}
+
 static inline int
 _estimate_nports(int nclients, int cli_per_port)
 {
@@ -1302,6 +1323,8 @@ client_io_handler_abort(client_io_t *cio)
 		}
 	}
 	pthread_mutex_unlock(&cio->ioservers_lock);
+
+	eio_signal_wakeup(cio->eio);
 }
 
 
@@ -39,6 +39,7 @@
 #include "assoc_mgr.h"
 
 #include <sys/types.h>
+#include <ctype.h>
 #include <pwd.h>
 #include <fcntl.h>
 
@@ -70,6 +71,230 @@ void (*update_resvs) () = NULL;
 static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
 
+/* Hash index of one of the lists above.  recs holds the records in list
+ * order and each slot's chain runs in list order too, so a lookup finds
+ * the record the list scan it replaced would have found.  An index is
+ * rebuilt under the list's write lock whenever records are added to or
+ * removed from the list or their keys change. */
+typedef struct {
+	void **recs;		/* records in list order */
+	int *head;		/* first index in recs of each slot or -1 */
+	int *next;		/* next index in recs in the same slot or -1 */
+	int rec_cnt;
+	uint32_t size;		/* slots, a power of two */
+} assoc_mgr_hash_t;
+
+#define HASH_BASIS 2166136261U	/* FNV-1a offset basis */
+
+static assoc_mgr_hash_t assoc_id_hash;	/* associations by id */
+static assoc_mgr_hash_t assoc_hash;	/* associations by uid and account */
+static assoc_mgr_hash_t qos_id_hash;	/* qos by id */
+static assoc_mgr_hash_t qos_name_hash;	/* qos by name */
+static assoc_mgr_hash_t user_uid_hash;	/* users by uid */
+static assoc_mgr_hash_t user_name_hash;	/* users by name */
+
+static uint32_t _hash_uint(uint32_t hash, uint32_t value)
+{
+	int i;
+
+	for (i = 0; i < 4; i++) {
+		hash ^= (value & 0xff);
+		hash *= 16777619;	/* FNV prime */
+		value >>= 8;
+	}
+	return hash;
+}
+
+/* Names are compared with strcasecmp() so are hashed in lower case */
+static uint32_t _hash_str(uint32_t hash, const char *str)
+{
+	if (!str)
+		return hash;
+	for ( ; *str; str++) {
+		hash ^= (unsigned char) tolower((int) *str);
+		hash *= 16777619;
+	}
+	return hash;
+}
+
+static uint32_t _assoc_id_key(void *rec)
+{
+	return _hash_uint(HASH_BASIS, ((slurmdb_association_rec_t *)rec)->id);
+}
+
+/* The cluster and partition are not part of the key since a lookup
+ * for a partition falls back to the association without one */
+static uint32_t _assoc_key(void *rec)
+{
+	slurmdb_association_rec_t *assoc = (slurmdb_association_rec_t *)rec;
+
+	return _hash_str(_hash_uint(HASH_BASIS, assoc->uid), assoc->acct);
+}
+
+static uint32_t _qos_id_key(void *rec)
+{
+	return _hash_uint(HASH_BASIS, ((slurmdb_qos_rec_t *)rec)->id);
+}
+
+static uint32_t _qos_name_key(void *rec)
+{
+	return _hash_str(HASH_BASIS, ((slurmdb_qos_rec_t *)rec)->name);
+}
+
+static uint32_t _user_uid_key(void *rec)
+{
+	return _hash_uint(HASH_BASIS, ((slurmdb_user_rec_t *)rec)->uid);
+}
+
+static uint32_t _user_name_key(void *rec)
+{
+	return _hash_str(HASH_BASIS, ((slurmdb_user_rec_t *)rec)->name);
+}
+
+/* Rebuild a hash index of list, or just free it if list is NULL */
+static void _hash_build(assoc_mgr_hash_t *hash, List list,
+			uint32_t (*key)(void *rec))
+{
+	ListIterator itr;
+	void *rec;
+	uint32_t slot;
+	int i, rec_cnt;
+
+	xfree(hash->recs);
+	xfree(hash->head);
+	xfree(hash->next);
+	hash->rec_cnt = 0;
+	hash->size = 0;
+	if (!list || !(rec_cnt = list_count(list)))
+		return;
+
+	hash->size = 16;
+	while (hash->size < rec_cnt)
+		hash->size <<= 1;
+	hash->recs = xmalloc(sizeof(void *) * rec_cnt);
+	hash->next = xmalloc(sizeof(int) * rec_cnt);
+	hash->head = xmalloc(sizeof(int) * hash->size);
+	for (slot = 0; slot < hash->size; slot++)
+		hash->head[slot] = -1;
+
+	itr = list_iterator_create(list);
+	while ((rec = list_next(itr)) && (hash->rec_cnt < rec_cnt))
+		hash->recs[hash->rec_cnt++] = rec;
+	list_iterator_destroy(itr);
+
+	/* Push from the back so each chain runs in list order */
+	for (i = hash->rec_cnt - 1; i >= 0; i--) {
+		slot = (*key)(hash->recs[i]) & (hash->size - 1);
+		hash->next[i] = hash->head[slot];
+		hash->head[slot] = i;
+	}
+}
+
+/* Return the index in hash->recs of the first record with this key's
+ * slot, or -1.  Follow the chain with hash->next. */
+static int _hash_first(assoc_mgr_hash_t *hash, uint32_t key)
+{
+	if (!hash->size)
+		return -1;
+	return hash->head[key & (hash->size - 1)];
+}
+
+/* locks should be put in place before calling these functions
+ * ASSOC_WRITE, QOS_WRITE or USER_WRITE respectively */
+static void _rehash_assocs(void)
+{
+	_hash_build(&assoc_id_hash, assoc_mgr_association_list,
+		    _assoc_id_key);
+	_hash_build(&assoc_hash, assoc_mgr_association_list, _assoc_key);
+}
+
+static void _rehash_qos(void)
+{
+	_hash_build(&qos_id_hash, assoc_mgr_qos_list, _qos_id_key);
+	_hash_build(&qos_name_hash, assoc_mgr_qos_list, _qos_name_key);
+}
+
+static void _rehash_users(void)
+{
+	_hash_build(&user_uid_hash, assoc_mgr_user_list, _user_uid_key);
+	_hash_build(&user_name_hash, assoc_mgr_user_list, _user_name_key);
+}
+
+/* locks should be put in place before calling these functions
+ * ASSOC_READ, QOS_READ or USER_READ respectively */
+static slurmdb_association_rec_t *_find_assoc_id(uint32_t id)
+{
+	slurmdb_association_rec_t *assoc;
+	int i;
+
+	for (i = _hash_first(&assoc_id_hash, _hash_uint(HASH_BASIS, id));
+	     i >= 0; i = assoc_id_hash.next[i]) {
+		assoc = assoc_id_hash.recs[i];
+		if (assoc->id == id)
+			return assoc;
+	}
+	return NULL;
+}
+
+/* Return the first qos in list order matching either id or name */
+static slurmdb_qos_rec_t *_find_qos(uint32_t id, char *name)
+{
+	slurmdb_qos_rec_t *qos;
+	int i, inx = -1;
+
+	for (i = _hash_first(&qos_id_hash, _hash_uint(HASH_BASIS, id));
+	     i >= 0; i = qos_id_hash.next[i]) {
+		qos = qos_id_hash.recs[i];
+		if (qos->id == id) {
+			inx = i;
+			break;
+		}
+	}
+	if (name) {
+		for (i = _hash_first(&qos_name_hash,
+				     _hash_str(HASH_BASIS, name));
+		     (i >= 0) && ((inx < 0) || (i < inx));
+		     i = qos_name_hash.next[i]) {
+			qos = qos_name_hash.recs[i];
+			if (!strcasecmp(name, qos->name)) {
+				inx = i;
+				break;
+			}
+		}
+	}
+	if (inx < 0)
+		return NULL;
+	return qos_id_hash.recs[inx];
+}
+
+static slurmdb_user_rec_t *_find_user_uid(uint32_t uid)
+{
+	slurmdb_user_rec_t *user;
+	int i;
+
+	for (i = _hash_first(&user_uid_hash, _hash_uint(HASH_BASIS, uid));
+	     i >= 0; i = user_uid_hash.next[i]) {
+		user = user_uid_hash.recs[i];
+		if (user->uid == uid)
+			return user;
+	}
+	return NULL;
+}
+
+static slurmdb_user_rec_t *_find_user_name(char *name)
+{
+	slurmdb_user_rec_t *user;
+	int i;
+
+	for (i = _hash_first(&user_name_hash, _hash_str(HASH_BASIS, name));
+	     i >= 0; i = user_name_hash.next[i]) {
+		user = user_name_hash.recs[i];
+		if (!strcasecmp(name, user->name))
+			return user;
+	}
+	return NULL;
+}
+
 /* you should check for assoc == NULL before this function */
 static void _normalize_assoc_shares(slurmdb_association_rec_t *assoc)
 {
@@ -699,6 +924,7 @@ static int _get_assoc_mgr_association_list(void *db_conn, int enforce)
 		   isn't anything there */
 		assoc_mgr_association_list =
 			list_create(slurmdb_destroy_association_rec);
+		_rehash_assocs();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("_get_assoc_mgr_association_list: "
@@ -712,6 +938,7 @@ static int _get_assoc_mgr_association_list(void *db_conn, int enforce)
 	}
 
 	_post_association_list(assoc_mgr_association_list);
+	_rehash_assocs();
 
 	assoc_mgr_unlock(&locks);
 
@@ -730,6 +957,7 @@ static int _get_assoc_mgr_qos_list(void *db_conn, int enforce)
 	assoc_mgr_qos_list = acct_storage_g_get_qos(db_conn, uid, NULL);
 
 	if (!assoc_mgr_qos_list) {
+		_rehash_qos();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("_get_assoc_mgr_qos_list: no list was made.");
@@ -740,6 +968,7 @@ static int _get_assoc_mgr_qos_list(void *db_conn, int enforce)
 	}
 
 	_post_qos_list(assoc_mgr_qos_list);
+	_rehash_qos();
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -761,6 +990,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	assoc_mgr_user_list = acct_storage_g_get_users(db_conn, uid, &user_q);
 
 	if (!assoc_mgr_user_list) {
+		_rehash_users();
 		assoc_mgr_unlock(&locks);
 		if (enforce & ACCOUNTING_ENFORCE_ASSOCS) {
 			error("_get_assoc_mgr_user_list: "
@@ -772,6 +1002,7 @@ static int _get_assoc_mgr_user_list(void *db_conn, int enforce)
 	}
 
 	_post_user_list(assoc_mgr_user_list);
+	_rehash_users();
 
 	assoc_mgr_unlock(&locks);
 	return SLURM_SUCCESS;
@@ -837,7 +1068,6 @@ static int _refresh_assoc_mgr_association_list(void *db_conn, int enforce)
 	List current_assocs = NULL;
 	uid_t uid = getuid();
 	ListIterator curr_itr = NULL;
-	ListIterator assoc_mgr_itr = NULL;
 	slurmdb_association_rec_t *curr_assoc = NULL, *assoc = NULL;
 	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK,
 				   NO_LOCK, WRITE_LOCK, NO_LOCK };
@@ -875,6 +1105,7 @@ static int _refresh_assoc_mgr_association_list(void *db_conn, int enforce)
 	}
 
 	_post_association_list(assoc_mgr_association_list);
+	_rehash_assocs();
 
 	if (!current_assocs) {
 		assoc_mgr_unlock(&locks);
@@ -882,17 +1113,13 @@ static int _refresh_assoc_mgr_association_list(void *db_conn, int enforce)
 	}
 
 	curr_itr = list_iterator_create(current_assocs);
-	assoc_mgr_itr = list_iterator_create(assoc_mgr_association_list);
 
 	/* add used limits We only look for the user associations to
 	 * do the parents since a parent may have moved */
 	while ((curr_assoc = list_next(curr_itr))) {
 		if (!curr_assoc->user)
 			continue;
-		while ((assoc = list_next(assoc_mgr_itr))) {
-			if (assoc->id == curr_assoc->id)
-				break;
-		}
+		assoc = _find_assoc_id(curr_assoc->id);
 
 		while (assoc) {
 			_addto_used_info(assoc, curr_assoc);
@@ -900,11 +1127,9 @@ static int _refresh_assoc_mgr_association_list(void *db_conn, int enforce)
 			   different than the one we are updating from */
 			assoc = assoc->usage->parent_assoc_ptr;
 		}
-		list_iterator_reset(assoc_mgr_itr);
 	}
 
 	list_iterator_destroy(curr_itr);
-	list_iterator_destroy(assoc_mgr_itr);
 
 	assoc_mgr_unlock(&locks);
 
@@ -939,6 +1164,7 @@ static int _refresh_assoc_mgr_qos_list(void *db_conn, int enforce)
 		list_destroy(assoc_mgr_qos_list);
 
 	assoc_mgr_qos_list = current_qos;
+	_rehash_qos();
 
 	assoc_mgr_unlock(&locks);
 
@@ -974,6 +1200,7 @@ static int _refresh_assoc_mgr_user_list(void *db_conn, int enforce)
 		list_destroy(assoc_mgr_user_list);
 
 	assoc_mgr_user_list = current_users;
+	_rehash_users();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1195,6 +1422,9 @@ extern int assoc_mgr_fini(char *state_save_location)
 	assoc_mgr_qos_list = NULL;
 	assoc_mgr_user_list = NULL;
 	assoc_mgr_wckey_list = NULL;
+	_rehash_assocs();
+	_rehash_qos();
+	_rehash_users();
 
 	assoc_mgr_unlock(&locks);
 
@@ -1357,9 +1587,9 @@ extern int assoc_mgr_fill_in_assoc(void *db_conn,
 				   int enforce,
 				   slurmdb_association_rec_t **assoc_pptr)
 {
-	ListIterator itr = NULL;
 	slurmdb_association_rec_t * found_assoc = NULL;
 	slurmdb_association_rec_t * ret_assoc = NULL;
+	int i;
 	assoc_mgr_lock_t locks = { READ_LOCK, NO_LOCK,
 				   NO_LOCK, NO_LOCK, NO_LOCK };
 
@@ -1432,62 +1662,57 @@ extern int assoc_mgr_fill_in_assoc(void *db_conn,
 /* 	     assoc->user, assoc->uid, assoc->acct, */
 /* 	     assoc->cluster, assoc->partition); */
 	assoc_mgr_lock(&locks);
-	itr = list_iterator_create(assoc_mgr_association_list);
-	while ((found_assoc = list_next(itr))) {
-		if (assoc->id) {
-			if (assoc->id == found_assoc->id) {
-				ret_assoc = found_assoc;
-				break;
-			}
+	if (assoc->id) {
+		ret_assoc = _find_assoc_id(assoc->id);
+		i = -1;
+	} else {
+		i = _hash_first(&assoc_hash,
+				_hash_str(_hash_uint(HASH_BASIS, assoc->uid),
+					  assoc->acct));
+	}
+	for ( ; i >= 0; i = assoc_hash.next[i]) {
+		found_assoc = assoc_hash.recs[i];
+		if (assoc->uid == NO_VAL && found_assoc->uid != NO_VAL) {
+			debug3("we are looking for a nonuser association");
 			continue;
-		} else {
-			if (assoc->uid == NO_VAL
-			    && found_assoc->uid != NO_VAL) {
-				debug3("we are looking for a "
-				       "nonuser association");
-				continue;
-			} else if (assoc->uid != found_assoc->uid) {
-				debug4("not the right user %u != %u",
-				       assoc->uid, found_assoc->uid);
-				continue;
-			}
+		} else if (assoc->uid != found_assoc->uid) {
+			debug4("not the right user %u != %u",
+			       assoc->uid, found_assoc->uid);
+			continue;
+		}
 
-			if (found_assoc->acct
-			    && strcasecmp(assoc->acct, found_assoc->acct)) {
-				debug4("not the right account %s != %s",
-				       assoc->acct, found_assoc->acct);
-				continue;
-			}
+		if (found_assoc->acct
+		    && strcasecmp(assoc->acct, found_assoc->acct)) {
+			debug4("not the right account %s != %s",
+			       assoc->acct, found_assoc->acct);
+			continue;
+		}
 
-			/* only check for on the slurmdbd */
-			if (!assoc_mgr_cluster_name && found_assoc->cluster
-			    && strcasecmp(assoc->cluster,
-					  found_assoc->cluster)) {
-				debug4("not the right cluster");
-				continue;
-			}
+		/* only check for on the slurmdbd */
+		if (!assoc_mgr_cluster_name && found_assoc->cluster
+		    && strcasecmp(assoc->cluster, found_assoc->cluster)) {
+			debug4("not the right cluster");
+			continue;
+		}
 
-			if (assoc->partition) {
-				if (!found_assoc->partition) {
-					ret_assoc = found_assoc;
-					debug3("found association "
-					       "for no partition");
-					continue;
-				} else if (strcasecmp(assoc->partition,
-						      found_assoc->partition)) {
-					debug4("not the right partition");
-					continue;
-				}
-			} else if (found_assoc->partition) {
-				debug4("partition specific association "
-				       "looking for one without.");
+		if (assoc->partition) {
+			if (!found_assoc->partition) {
+				ret_assoc = found_assoc;
+				debug3("found association for no partition");
+				continue;
+			} else if (strcasecmp(assoc->partition,
+					      found_assoc->partition)) {
+				debug4("not the right partition");
 				continue;
 			}
+		} else if (found_assoc->partition) {
+			debug4("partition specific association "
+			       "looking for one without.");
+			continue;
 		}
 		ret_assoc = found_assoc;
 		break;
 	}
-	list_iterator_destroy(itr);
 
 	if (!ret_assoc) {
 		assoc_mgr_unlock(&locks);
@@ -1589,7 +1814,6 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 				  int enforce,
 				  slurmdb_user_rec_t **user_pptr)
 {
-	ListIterator itr = NULL;
 	slurmdb_user_rec_t * found_user = NULL;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK,
 				   NO_LOCK, READ_LOCK, NO_LOCK };
@@ -1607,16 +1831,10 @@ extern int assoc_mgr_fill_in_user(void *db_conn, slurmdb_user_rec_t *user,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_user_list);
-	while ((found_user = list_next(itr))) {
-		if (user->uid != NO_VAL) {
-			if (user->uid == found_user->uid)
-				break;
-		} else if (user->name
-			   && !strcasecmp(user->name, found_user->name))
-			break;
-	}
-	list_iterator_destroy(itr);
+	if (user->uid != NO_VAL)
+		found_user = _find_user_uid(user->uid);
+	else if (user->name)
+		found_user = _find_user_name(user->name);
 
 	if (!found_user) {
 		assoc_mgr_unlock(&locks);
@@ -1659,7 +1877,6 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 				 int enforce,
 				 slurmdb_qos_rec_t **qos_pptr)
 {
-	ListIterator itr = NULL;
 	slurmdb_qos_rec_t * found_qos = NULL;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK,
 				   READ_LOCK, NO_LOCK, NO_LOCK };
@@ -1677,14 +1894,7 @@ extern int assoc_mgr_fill_in_qos(void *db_conn, slurmdb_qos_rec_t *qos,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_qos_list);
-	while ((found_qos = list_next(itr))) {
-		if (qos->id == found_qos->id)
-			break;
-		else if (qos->name && !strcasecmp(qos->name, found_qos->name))
-			break;
-	}
-	list_iterator_destroy(itr);
+	found_qos = _find_qos(qos->id, qos->name);
 
 	if (!found_qos) {
 		assoc_mgr_unlock(&locks);
@@ -1932,7 +2142,6 @@ extern int assoc_mgr_fill_in_wckey(void *db_conn, slurmdb_wckey_rec_t *wckey,
 extern slurmdb_admin_level_t assoc_mgr_get_admin_level(void *db_conn,
 						       uint32_t uid)
 {
-	ListIterator itr = NULL;
 	slurmdb_user_rec_t * found_user = NULL;
 	assoc_mgr_lock_t locks = { NO_LOCK, NO_LOCK,
 				   NO_LOCK, READ_LOCK, NO_LOCK };
@@ -1947,12 +2156,7 @@ extern slurmdb_admin_level_t assoc_mgr_get_admin_level(void *db_conn,
 		return SLURMDB_ADMIN_NOTSET;
 	}
 
-	itr = list_iterator_create(assoc_mgr_user_list);
-	while ((found_user = list_next(itr))) {
-		if (uid == found_user->uid)
-			break;
-	}
-	list_iterator_destroy(itr);
+	found_user = _find_user_uid(uid);
 	assoc_mgr_unlock(&locks);
 
 	if (found_user)
@@ -1984,13 +2188,7 @@ extern bool assoc_mgr_is_user_acct_coord(void *db_conn,
 		return false;
 	}
 
-	itr = list_iterator_create(assoc_mgr_user_list);
-	while ((found_user = list_next(itr))) {
-		if (uid == found_user->uid)
-			break;
-	}
-	list_iterator_destroy(itr);
-
+	found_user = _find_user_uid(uid);
 	if (!found_user || !found_user->coord_accts) {
 		assoc_mgr_unlock(&locks);
 		return false;
@@ -2246,6 +2444,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update)
 	int parents_changed = 0;
 	int run_update_resvs = 0;
 	int resort = 0;
+	bool rehash = false;
 	List remove_list = NULL;
 	List update_list = NULL;
 	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK,
@@ -2495,6 +2694,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update)
 				object->is_def = 0;
 			list_append(assoc_mgr_association_list, object);
 			object = NULL;
+			rehash = true;
 			parents_changed = 1; /* set since we need to
 						set the parent
 					     */
@@ -2509,6 +2709,7 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update)
 
 			run_update_resvs = 1; /* needed for updating
 						 reservations */
+			rehash = true;
 
 			if (setup_children)
 				parents_changed = 1; /* set since we need to
@@ -2625,6 +2826,10 @@ extern int assoc_mgr_update_assocs(slurmdb_update_object_t *update)
 		slurmdb_sort_hierarchical_assoc_list(
 			assoc_mgr_association_list);
 
+	/* Sorting changes the list order the index chains follow */
+	if (rehash || parents_changed || resort)
+		_rehash_assocs();
+
 	list_iterator_destroy(itr);
 	assoc_mgr_unlock(&locks);
 
@@ -2780,6 +2985,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update)
 	ListIterator itr = NULL;
 	int rc = SLURM_SUCCESS;
 	uid_t pw_uid;
+	bool rehash = false;
 	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK,
 				   NO_LOCK, WRITE_LOCK, WRITE_LOCK };
 
@@ -2822,6 +3028,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update)
 				rec->name = object->name;
 				object->name = NULL;
 				rc = _change_user_name(rec);
+				rehash = true;
 			}
 
 			if (object->default_acct) {
@@ -2853,6 +3060,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update)
 				object->uid = pw_uid;
 			list_append(assoc_mgr_user_list, object);
 			object = NULL;
+			rehash = true;
 			break;
 		case SLURMDB_REMOVE_USER:
 			if (!rec) {
@@ -2860,6 +3068,7 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update)
 				break;
 			}
 			list_delete_item(itr);
+			rehash = true;
 			break;
 		case SLURMDB_ADD_COORD:
 			/* same as SLURMDB_REMOVE_COORD */
@@ -2886,6 +3095,11 @@ extern int assoc_mgr_update_users(slurmdb_update_object_t *update)
 		slurmdb_destroy_user_rec(object);
 	}
 	list_iterator_destroy(itr);
+	if (rehash) {
+		/* A new name changes the uid of the user's associations */
+		_rehash_users();
+		_rehash_assocs();
+	}
 	assoc_mgr_unlock(&locks);
 
 	return rc;
@@ -2901,6 +3115,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update)
 	slurmdb_association_rec_t *assoc = NULL;
 	int rc = SLURM_SUCCESS;
 	bool resize_qos_bitstr = 0;
+	bool rehash = false;
 	int redo_priority = 0;
 	List remove_list = NULL;
 	List update_list = NULL;
@@ -2934,6 +3149,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update)
 			if (!object->usage)
 				object->usage = create_assoc_mgr_qos_usage();
 			list_append(assoc_mgr_qos_list, object);
+			rehash = true;
 /* 			char *tmp = get_qos_complete_str_bitstr( */
 /* 				assoc_mgr_qos_list, */
 /* 				object->preempt_bitstr); */
@@ -3105,6 +3321,7 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update)
 				list_append(remove_list, rec);
 			} else
 				list_delete_item(itr);
+			rehash = true;
 
 			if (!assoc_mgr_association_list)
 				break;
@@ -3168,6 +3385,9 @@ extern int assoc_mgr_update_qos(slurmdb_update_object_t *update)
 	} else if (redo_priority == 2)
 		_post_qos_list(assoc_mgr_qos_list);
 
+	if (rehash)
+		_rehash_qos();
+
 	list_iterator_destroy(itr);
 
 	assoc_mgr_unlock(&locks);
@@ -3197,7 +3417,6 @@ extern int assoc_mgr_validate_assoc_id(void *db_conn,
 				       uint32_t assoc_id,
 				       int enforce)
 {
-	ListIterator itr = NULL;
 	slurmdb_association_rec_t * found_assoc = NULL;
 	assoc_mgr_lock_t locks = { READ_LOCK, NO_LOCK,
 				   NO_LOCK, NO_LOCK, NO_LOCK };
@@ -3218,12 +3437,7 @@ extern int assoc_mgr_validate_assoc_id(void *db_conn,
 		return SLURM_SUCCESS;
 	}
 
-	itr = list_iterator_create(assoc_mgr_association_list);
-	while ((found_assoc = list_next(itr))) {
-		if (assoc_id == found_assoc->id)
-			break;
-	}
-	list_iterator_destroy(itr);
+	found_assoc = _find_assoc_id(assoc_id);
 	assoc_mgr_unlock(&locks);
 
 	if (found_assoc || !(enforce & ACCOUNTING_ENFORCE_ASSOCS))
@@ -3849,6 +4063,7 @@ extern int load_assoc_mgr_state(char *state_save_location)
 				list_destroy(assoc_mgr_association_list);
 			assoc_mgr_association_list = msg->my_list;
 			_post_association_list(assoc_mgr_association_list);
+			_rehash_assocs();
 
 			debug("Recovered %u associations",
 			      list_count(assoc_mgr_association_list));
@@ -3868,6 +4083,7 @@ extern int load_assoc_mgr_state(char *state_save_location)
 				list_destroy(assoc_mgr_user_list);
 			assoc_mgr_user_list = msg->my_list;
 			_post_user_list(assoc_mgr_user_list);
+			_rehash_users();
 			debug("Recovered %u users",
 			      list_count(assoc_mgr_user_list));
 			msg->my_list = NULL;
@@ -3886,6 +4102,7 @@ extern int load_assoc_mgr_state(char *state_save_location)
 				list_destroy(assoc_mgr_qos_list);
 			assoc_mgr_qos_list = msg->my_list;
 			_post_qos_list(assoc_mgr_qos_list);
+			_rehash_qos();
 			debug("Recovered %u qos",
 			      list_count(assoc_mgr_qos_list));
 			msg->my_list = NULL;
@@ -3967,6 +4184,7 @@ extern int assoc_mgr_set_missing_uids()
 {
 	uid_t pw_uid;
 	ListIterator itr = NULL;
+	bool rehash = false;
 	assoc_mgr_lock_t locks = { WRITE_LOCK, NO_LOCK,
 				   NO_LOCK, WRITE_LOCK, WRITE_LOCK };
 
@@ -3981,8 +4199,10 @@ extern int assoc_mgr_set_missing_uids()
 					debug2("refresh association "
 					       "couldn't get a uid for user %s",
 					       object->user);
-				} else
+				} else {
 					object->uid = pw_uid;
+					rehash = true;
+				}
 			}
 		}
 		list_iterator_destroy(itr);
@@ -4015,12 +4235,18 @@ extern int assoc_mgr_set_missing_uids()
 					debug3("refresh user couldn't get "
 					       "a uid for user %s",
 					       object->name);
-				} else
+				} else {
 					object->uid = pw_uid;
+					rehash = true;
+				}
 			}
 		}
 		list_iterator_destroy(itr);
 	}
+	if (rehash) {
+		_rehash_assocs();
+		_rehash_users();
+	}
 	assoc_mgr_unlock(&locks);
 
 	return SLURM_SUCCESS;
@@ -132,6 +132,10 @@ struct assoc_mgr_association_usage {
 				 * plugin). (DON'T PACK) */
 	unsigned active_seqno;  /* Sequence number for identifying
 				 * active associations (DON'T PACK) */
+	double fs_factor;	/* Fairshare factor (for multifactor
+				 * plugin). (DON'T PACK) */
+	unsigned fs_seqno;	/* Decay cycle fs_factor was computed in
+				 * (DON'T PACK) */
 
 	bitstr_t *valid_qos;    /* qos available for this association
 				 * derived from the qos_list.
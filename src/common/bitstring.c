@@ -87,6 +87,7 @@ strong_alias(bit_fls,		slurm_bit_fls);
 strong_alias(bit_fill_gaps,	slurm_bit_fill_gaps);
 strong_alias(bit_super_set,	slurm_bit_super_set);
 strong_alias(bit_overlap,	slurm_bit_overlap);
+strong_alias(bit_overlap_any,	slurm_bit_overlap_any);
 strong_alias(bit_equal,		slurm_bit_equal);
 strong_alias(bit_copy,		slurm_bit_copy);
 strong_alias(bit_pick_cnt,	slurm_bit_pick_cnt);
@@ -97,6 +98,149 @@ strong_alias(bit_copybits,	slurm_bit_copybits);
 strong_alias(bit_get_bit_num,	slurm_bit_get_bit_num);
 strong_alias(bit_get_pos_num,	slurm_bit_get_pos_num);
 
+/*
+ * Word level primitives. Bits are located within words as described for
+ * _bit_mask() in bitstring.h, so the lowest numbered bit of a word is its
+ * least significant bit unless SLURM_BIGENDIAN is defined. Words are
+ * treated as unsigned, bitstr_t being a signed type.
+ */
+#ifdef USE_64BIT_BITSTR
+typedef uint64_t bitstr_word_t;
+#else
+typedef uint32_t bitstr_word_t;
+#endif
+
+/* first bit position of word number "word" of a bitstring */
+#define _word_bit(word)	((bitoff_t)((word) - BITSTR_OVERHEAD) << BITSTR_SHIFT)
+
+#if defined(__GNUC__) && \
+    ((__GNUC__ > 3) || ((__GNUC__ == 3) && (__GNUC_MINOR__ >= 4)))
+#  ifdef USE_64BIT_BITSTR
+#    define _word_popcount(w)	__builtin_popcountll((bitstr_word_t) (w))
+#    define _word_lsb(w)	__builtin_ctzll((bitstr_word_t) (w))
+#    define _word_msb(w)	(63 - __builtin_clzll((bitstr_word_t) (w)))
+#  else
+#    define _word_popcount(w)	__builtin_popcount((bitstr_word_t) (w))
+#    define _word_lsb(w)	__builtin_ctz((bitstr_word_t) (w))
+#    define _word_msb(w)	(31 - __builtin_clz((bitstr_word_t) (w)))
+#  endif
+/* Counting kernels are also built for processors with a POPCNT
+ * instruction and selected at run time, see _count_words() */
+#  if defined(__x86_64__) && !defined(__POPCNT__) && \
+      ((__GNUC__ > 4) || ((__GNUC__ == 4) && (__GNUC_MINOR__ >= 8)))
+#    define BITSTR_POPCNT_DISPATCH 1
+#  endif
+#else
+#  define _word_popcount(w)	_hweight((bitstr_word_t) (w))
+#  define _word_lsb(w)		_word_lsb_loop((bitstr_word_t) (w))
+#  define _word_msb(w)		_word_msb_loop((bitstr_word_t) (w))
+
+/*
+ * Returns the hamming weight (i.e. the number of bits set) in a word.
+ * NOTE: This routine borrowed from Linux 2.4.9 <linux/bitops.h>.
+ */
+static int
+_hweight(bitstr_word_t w)
+{
+#ifdef USE_64BIT_BITSTR
+	w = (w & 0x5555555555555555ULL) + ((w >> 1) & 0x5555555555555555ULL);
+	w = (w & 0x3333333333333333ULL) + ((w >> 2) & 0x3333333333333333ULL);
+	w = (w & 0x0F0F0F0F0F0F0F0FULL) + ((w >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+	w = (w & 0x00FF00FF00FF00FFULL) + ((w >> 8) & 0x00FF00FF00FF00FFULL);
+	w = (w & 0x0000FFFF0000FFFFULL) + ((w >> 16) & 0x0000FFFF0000FFFFULL);
+	w = (w & 0x00000000FFFFFFFFULL) + ((w >> 32) & 0x00000000FFFFFFFFULL);
+#else
+	w = (w & 0x55555555) + ((w >> 1)  & 0x55555555);
+	w = (w & 0x33333333) + ((w >> 2)  & 0x33333333);
+	w = (w & 0x0F0F0F0F) + ((w >> 4)  & 0x0F0F0F0F);
+	w = (w & 0x00FF00FF) + ((w >> 8)  & 0x00FF00FF);
+	w = (w & 0x0000FFFF) + ((w >> 16) & 0x0000FFFF);
+#endif
+	return (int) w;
+}
+
+/* position of least significant bit set in a non-zero word */
+static int
+_word_lsb_loop(bitstr_word_t w)
+{
+	int pos = 0;
+
+	while (!(w & 1)) {
+		w >>= 1;
+		pos++;
+	}
+	return pos;
+}
+
+/* position of most significant bit set in a non-zero word */
+static int
+_word_msb_loop(bitstr_word_t w)
+{
+	int pos = 0;
+
+	while (w >>= 1)
+		pos++;
+	return pos;
+}
+#endif
+
+/* position within its word of the lowest/highest numbered bit set in a
+ * non-zero word */
+#ifdef SLURM_BIGENDIAN
+#  define _word_first(w)	(BITSTR_MAXPOS - _word_msb(w))
+#  define _word_last(w)		(BITSTR_MAXPOS - _word_lsb(w))
+#else
+#  define _word_first(w)	_word_lsb(w)
+#  define _word_last(w)		_word_msb(w)
+#endif
+
+/*
+ * Count the bits set in nwords words of w1 or, if w2 is not NULL, the bits
+ * set in both w1 and w2.
+ */
+#define _COUNT_WORDS_FUNC(name)						\
+static int								\
+name(bitstr_t *w1, bitstr_t *w2, int nwords)				\
+{									\
+	int i, count = 0;						\
+									\
+	if (w2) {							\
+		for (i = 0; i < nwords; i++)				\
+			count += _word_popcount(w1[i] & w2[i]);		\
+	} else {							\
+		for (i = 0; i < nwords; i++)				\
+			count += _word_popcount(w1[i]);			\
+	}								\
+	return count;							\
+}
+
+_COUNT_WORDS_FUNC(_count_words_generic)
+
+#ifdef BITSTR_POPCNT_DISPATCH
+__attribute__((target("popcnt")))
+_COUNT_WORDS_FUNC(_count_words_popcnt)
+
+static int (*_count_words_func)(bitstr_t *w1, bitstr_t *w2, int nwords);
+#endif
+
+static int
+_count_words(bitstr_t *w1, bitstr_t *w2, int nwords)
+{
+#ifdef BITSTR_POPCNT_DISPATCH
+	/* Racing initializations all store the same value */
+	if (!_count_words_func) {
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("popcnt"))
+			_count_words_func = _count_words_popcnt;
+		else
+			_count_words_func = _count_words_generic;
+	}
+	return (*_count_words_func)(w1, w2, nwords);
+#else
+	return _count_words_generic(w1, w2, nwords);
+#endif
+}
+
 /*
  * Allocate a bitstring.
  *   nbits (IN)		valid bits in new bitstring, initialized to all clear
@@ -265,24 +409,19 @@ bit_nclear(bitstr_t *b, bitoff_t start, bitoff_t stop)
 bitoff_t
 bit_ffc(bitstr_t *b)
 {
-	bitoff_t bit = 0, value = -1;
+	bitoff_t bit, value = -1;
+	int word, nwords;
 
 	_assert_bitstr_valid(b);
 
-	while (bit < _bitstr_bits(b) && value == -1) {
-		int word = _bit_word(bit);
-
-		if (b[word] == BITSTR_MAXPOS) {
-			bit += sizeof(bitstr_t)*8;
+	nwords = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (~b[word] == 0)
 			continue;
-		}
-		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
-			if (!bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit++;
-		}
+		bit = _word_bit(word) + _word_first(~b[word]);
+		if (bit < _bitstr_bits(b))	/* not an unused bit */
+			value = bit;
+		break;
 	}
 	return value;
 }
@@ -298,11 +437,28 @@ bit_nffc(bitstr_t *b, int n)
 	bitoff_t value = -1;
 	bitoff_t bit;
 	int cnt = 0;
+	const int word_size = sizeof(bitstr_t) * 8;
 
 	_assert_bitstr_valid(b);
 	assert(n > 0 && n < _bitstr_bits(b));
 
 	for (bit = 0; bit < _bitstr_bits(b); bit++) {
+		/* Skip whole words which are all set or all clear */
+		while (((bit & BITSTR_MAXPOS) == 0) &&
+		       ((bit + word_size) <= _bitstr_bits(b))) {
+			bitstr_t w = b[_bit_word(bit)];
+			if (~w == 0)
+				cnt = 0;
+			else if (w == 0)
+				cnt += word_size;
+			else
+				break;
+			if (cnt >= n)
+				return (bit + word_size - cnt);
+			bit += word_size;
+		}
+		if (bit >= _bitstr_bits(b))
+			break;
 		if (bit_test(b, bit)) {		/* fail */
 			cnt = 0;
 		} else {
@@ -404,24 +560,19 @@ bit_nffs(bitstr_t *b, int n)
 bitoff_t
 bit_ffs(bitstr_t *b)
 {
-	bitoff_t bit = 0, value = -1;
+	bitoff_t bit, value = -1;
+	int word, nwords;
 
 	_assert_bitstr_valid(b);
 
-	while (bit < _bitstr_bits(b) && value == -1) {
-		int word = _bit_word(bit);
-
-		if (b[word] == 0) {
-			bit += sizeof(bitstr_t)*8;
+	nwords = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (b[word] == 0)
 			continue;
-		}
-		while (bit < _bitstr_bits(b) && _bit_word(bit) == word) {
-			if (bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit++;
-		}
+		bit = _word_bit(word) + _word_first(b[word]);
+		if (bit < _bitstr_bits(b))	/* not an unused bit */
+			value = bit;
+		break;
 	}
 	return value;
 }
@@ -452,19 +603,12 @@ bit_fls(bitstr_t *b)
 		}
 		bit--;
 	}
-	while (bit >= 0 && value == -1) {	/* test whole words */
-		word = _bit_word(bit);
-		if (b[word] == 0) {
-			bit -= sizeof(bitstr_t) * 8;
-			continue;
-		}
-		while (bit >= 0) {
-			if (bit_test(b, bit)) {
-				value = bit;
-				break;
-			}
-			bit--;
-		}
+	if ((value != -1) || (bit < 0))
+		return value;
+	for (word = _bit_word(bit); word >= BITSTR_OVERHEAD; word--) {
+						/* test whole words */
+		if (b[word] != 0)
+			return (_word_bit(word) + _word_last(b[word]));
 	}
 	return value;
 }
@@ -494,15 +638,15 @@ bit_fill_gaps(bitstr_t *b) {
  */
 int
 bit_super_set(bitstr_t *b1, bitstr_t *b2)  {
-	bitoff_t bit;
+	int word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8) {
-		if (b1[_bit_word(bit)] != (b1[_bit_word(bit)] &
-		                           b2[_bit_word(bit)]))
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (b1[word] & ~b2[word])
 			return 0;
 	}
 
@@ -540,14 +684,15 @@ bit_equal(bitstr_t *b1, bitstr_t *b2)
  */
 void
 bit_and(bitstr_t *b1, bitstr_t *b2) {
-	bitoff_t bit;
+	int word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] &= b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] &= b2[word];
 }
 
 /*
@@ -556,12 +701,13 @@ bit_and(bitstr_t *b1, bitstr_t *b2) {
  */
 void
 bit_not(bitstr_t *b) {
-	bitoff_t bit;
+	int word, nwords;
 
 	_assert_bitstr_valid(b);
 
-	for (bit = 0; bit < _bitstr_bits(b); bit += sizeof(bitstr_t)*8)
-		b[_bit_word(bit)] = ~b[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b[word] = ~b[word];
 }
 
 /*
@@ -571,14 +717,15 @@ bit_not(bitstr_t *b) {
  */
 void
 bit_or(bitstr_t *b1, bitstr_t *b2) {
-	bitoff_t bit;
+	int word, nwords;
 
 	_assert_bitstr_valid(b1);
 	_assert_bitstr_valid(b2);
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
-	for (bit = 0; bit < _bitstr_bits(b1); bit += sizeof(bitstr_t)*8)
-		b1[_bit_word(bit)] |= b2[_bit_word(bit)];
+	nwords = _bitstr_words(_bitstr_bits(b1));
+	for (word = BITSTR_OVERHEAD; word < nwords; word++)
+		b1[word] |= b2[word];
 }
 
 
@@ -617,44 +764,6 @@ bit_copybits(bitstr_t *dest, bitstr_t *src)
 	memcpy(&dest[BITSTR_OVERHEAD], &src[BITSTR_OVERHEAD], len);
 }
 
-#if !defined(USE_64BIT_BITSTR)
-/*
- * Returns the hamming weight (i.e. the number of bits set) in a word.
- * NOTE: This routine borrowed from Linux 2.4.9 <linux/bitops.h>.
- */
-static uint32_t
-hweight(uint32_t w)
-{
-	uint32_t res;
-
-	res = (w   & 0x55555555) + ((w >> 1)    & 0x55555555);
-	res = (res & 0x33333333) + ((res >> 2)  & 0x33333333);
-	res = (res & 0x0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F);
-	res = (res & 0x00FF00FF) + ((res >> 8)  & 0x00FF00FF);
-	res = (res & 0x0000FFFF) + ((res >> 16) & 0x0000FFFF);
-
-	return res;
-}
-#else
-/*
- * A 64 bit version crafted from 32-bit one borrowed above.
- */
-static uint64_t
-hweight(uint64_t w)
-{
-	uint64_t res;
-
-	res = (w   & 0x5555555555555555) + ((w >> 1)    & 0x5555555555555555);
-	res = (res & 0x3333333333333333) + ((res >> 2)  & 0x3333333333333333);
-	res = (res & 0x0F0F0F0F0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F0F0F0F0F);
-	res = (res & 0x00FF00FF00FF00FF) + ((res >> 8)  & 0x00FF00FF00FF00FF);
-	res = (res & 0x0000FFFF0000FFFF) + ((res >> 16) & 0x0000FFFF0000FFFF);
-	res = (res & 0x00000000FFFFFFFF) + ((res >> 32) & 0x00000000FFFFFFFF);
-
-	return res;
-}
-#endif /* !USE_64BIT_BITSTR */
-
 /*
  * Count the number of bits set in bitstring.
  *   b (IN)		bitstring to check
@@ -670,9 +779,8 @@ bit_set_count(bitstr_t *b)
 	_assert_bitstr_valid(b);
 
 	bit_cnt = _bitstr_bits(b);
-	for (bit = 0; (bit + word_size) <= bit_cnt; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
-	}
+	bit = (bit_cnt / word_size) * word_size;	/* whole words */
+	count = _count_words(b + BITSTR_OVERHEAD, NULL, bit / word_size);
 	for ( ; bit < bit_cnt; bit++) {
 		if (bit_test(b, bit))
 			count++;
@@ -703,8 +811,10 @@ bit_set_count_range(bitstr_t *b, int start, int end)
 		if (bit_test(b, bit))
 			count++;
 	}
-	for (; (bit + word_size) <= end ; bit += word_size) {
-		count += hweight(b[_bit_word(bit)]);
+	if ((bit + word_size) <= end) {
+		int nwords = (end - bit) / word_size;
+		count += _count_words(b + _bit_word(bit), NULL, nwords);
+		bit += nwords * word_size;
 	}
 	for ( ; bit < end; bit++) {
 		if (bit_test(b, bit))
@@ -729,11 +839,9 @@ bit_overlap(bitstr_t *b1, bitstr_t *b2)
 	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
 
 	bit_cnt = _bitstr_bits(b1);
-	for (bit = 0; bit < bit_cnt; bit += word_size) {
-		if ((bit + word_size - 1) >= bit_cnt)
-			break;
-		count += hweight(b1[_bit_word(bit)] & b2[_bit_word(bit)]);
-	}
+	bit = (bit_cnt / word_size) * word_size;	/* whole words */
+	count = _count_words(b1 + BITSTR_OVERHEAD, b2 + BITSTR_OVERHEAD,
+			     bit / word_size);
 	for ( ; bit < bit_cnt; bit++) {
 		if (bit_test(b1, bit) && bit_test(b2, bit))
 			count++;
@@ -742,6 +850,34 @@ bit_overlap(bitstr_t *b1, bitstr_t *b2)
 	return count;
 }
 
+/*
+ * return 1 if any bit set in b1 is also set in b2, 0 otherwise.
+ * Faster than bit_overlap() when the count is not needed.
+ */
+extern int
+bit_overlap_any(bitstr_t *b1, bitstr_t *b2)
+{
+	bitoff_t bit;
+	int word, nwords;
+
+	_assert_bitstr_valid(b1);
+	_assert_bitstr_valid(b2);
+	assert(_bitstr_bits(b1) == _bitstr_bits(b2));
+
+	/* the last word may contain unused bits, test it bit by bit */
+	nwords = _bitstr_words(_bitstr_bits(b1)) - 1;
+	for (word = BITSTR_OVERHEAD; word < nwords; word++) {
+		if (b1[word] & b2[word])
+			return 1;
+	}
+	for (bit = _word_bit(word); bit < _bitstr_bits(b1); bit++) {
+		if (bit_test(b1, bit) && bit_test(b2, bit))
+			return 1;
+	}
+
+	return 0;
+}
+
 /*
  * Count the number of bits clear in bitstring.
  *   b (IN)		bitstring to check
@@ -902,7 +1038,7 @@ bit_pick_cnt(bitstr_t *b, bitoff_t nbits) {
 			continue;
 		}
 
-		new_bits = hweight(b[word]);
+		new_bits = _word_popcount(b[word]);
 		if (((count + new_bits) <= nbits) &&
 		    ((bit + word_size - 1) < _bitstr_bits(b))) {
 			new[word] = b[word];
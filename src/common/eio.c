@@ -42,6 +42,12 @@
 #include <sys/poll.h>
 #include <unistd.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_SYS_EPOLL_H
+#  include <sys/epoll.h>
+#endif
 
 #include "src/common/fd.h"
 #include "src/common/eio.h"
@@ -56,6 +62,34 @@
  * terminating the job and abandoning any I/O remaining to be processed */
 #define EIO_SHUTDOWN_WAIT 60
 
+#ifdef HAVE_SYS_EPOLL_H
+/*
+ * The epoll backend keeps each object's fd registered between passes of the
+ * main loop and only calls epoll_ctl() when the events an object wants
+ * change. A pass checks the readable() and writable() functions of just the
+ * objects dispatched on the previous pass and those handed to
+ * eio_obj_changed(), so it costs the number of ready fds rather than the
+ * number of objects. Every object is checked on the first pass, when the
+ * object list grows, after eio_signal_wakeup() or eio_signal_shutdown() and
+ * when epoll_wait() returns without events. It is selected by setting the
+ * SLURM_EIO_BACKEND environment variable to "epoll" (level triggered) or
+ * "epoll_edge" (edge triggered), "poll" or no value selects poll().
+ *
+ * Events carry the fd and the generation of its registration, so events
+ * left behind by an fd which was closed while registered (its open file
+ * being shared with another process) are recognized rather than handed to
+ * whichever object now uses that fd number.
+ */
+typedef struct eio_epoll_fd {
+	eio_obj_t *obj;		/* object registered for fd, NULL if none */
+	uint32_t   events;	/* events registered */
+	uint32_t   gen;		/* generation of the registration */
+} eio_epoll_fd_t;
+
+#define EIO_EPOLL_DATA(_gen, _fd) ((((uint64_t) (_gen)) << 32) | \
+				   (uint32_t) (_fd))
+#endif
+
 /*
  * outside threads can stick new objects on the new_objs List and
  * the eio thread will move them to the main obj_list the next time
@@ -69,6 +103,24 @@ struct eio_handle_components {
 	int  fds[2];
 	List obj_list;
 	List new_objs;
+	pthread_t thread;		/* thread running the main loop */
+	bool running;			/* main loop running in thread */
+#ifdef HAVE_SYS_EPOLL_H
+	int  epfd;			/* epoll instance, -1 for poll() */
+	bool edge;			/* register fds edge triggered */
+	eio_epoll_fd_t *ep_fds;		/* registration of each fd */
+	int  ep_size;			/* entries in ep_fds */
+	uint32_t ep_gen;		/* last registration generation */
+	uint32_t ep_pass;		/* passes of the main loop */
+	eio_obj_t **ep_chg;		/* objects to check on next pass */
+	int  ep_nchg;			/* entries used in ep_chg */
+	int  ep_chg_size;		/* entries in ep_chg */
+	eio_obj_t **ep_chk;		/* objects being checked */
+	int  ep_chk_size;		/* entries in ep_chk */
+	bool ep_full;			/* check every object on next pass */
+	int  ep_nknown;			/* objects in obj_list when checked */
+	int  ep_nobjs;			/* objects wanting events */
+#endif
 };
 
 
@@ -81,6 +133,19 @@ static void         _poll_dispatch(struct pollfd *, unsigned int, eio_obj_t **,
 		                   List objList);
 static void         _poll_handle_event(short revents, eio_obj_t *obj,
 		                       List objList);
+#ifdef HAVE_SYS_EPOLL_H
+static int          _epoll_create(eio_handle_t *eio);
+static void         _epoll_destroy(eio_handle_t *eio);
+static int          _epoll_mainloop(eio_handle_t *eio);
+static void         _epoll_select(eio_handle_t *eio);
+static void         _epoll_changed(eio_handle_t *eio, eio_obj_t *obj);
+static int          _epoll_check(eio_handle_t *eio, eio_obj_t *obj,
+				 struct pollfd *pend, eio_obj_t **pend_map,
+				 unsigned int *npend);
+static int          _epoll_setup(eio_handle_t *eio, struct pollfd *pend,
+				 eio_obj_t **pend_map, unsigned int *npend);
+static short        _epoll_to_poll(uint32_t events);
+#endif
 
 static time_t eio_shutdown_time = (time_t) 0;
 
@@ -103,6 +168,11 @@ eio_handle_t *eio_handle_create(void)
 	eio->obj_list = list_create(eio_obj_destroy);
 	eio->new_objs = list_create(eio_obj_destroy);
 
+#ifdef HAVE_SYS_EPOLL_H
+	eio->epfd = -1;
+	_epoll_select(eio);
+#endif
+
 	return eio;
 }
 
@@ -110,6 +180,11 @@ void eio_handle_destroy(eio_handle_t *eio)
 {
 	xassert(eio != NULL);
 	xassert(eio->magic == EIO_MAGIC);
+#ifdef HAVE_SYS_EPOLL_H
+	_epoll_destroy(eio);
+	xfree(eio->ep_chg);
+	xfree(eio->ep_chk);
+#endif
 	close(eio->fds[0]);
 	close(eio->fds[1]);
 	if (eio->obj_list)
@@ -212,9 +287,23 @@ int eio_signal_shutdown(eio_handle_t *eio)
 	return 0;
 }
 
+/* Return true if called from the thread running the main loop of eio */
+static bool _in_mainloop(eio_handle_t *eio)
+{
+	return (eio->running && pthread_equal(eio->thread, pthread_self()));
+}
+
 int eio_signal_wakeup(eio_handle_t *eio)
 {
 	char c = 0;
+#ifdef HAVE_SYS_EPOLL_H
+	/* From the thread of the main loop, which is not waiting, just have
+	 * its next pass check every object */
+	if ((eio->epfd >= 0) && _in_mainloop(eio)) {
+		eio->ep_full = true;
+		return 0;
+	}
+#endif
 	if (write(eio->fds[1], &c, sizeof(char)) != 1)
 		return error("eio_handle_signal_wake: write; %m");
 	return 0;
@@ -262,6 +351,17 @@ int eio_handle_mainloop(eio_handle_t *eio)
 	xassert (eio != NULL);
 	xassert (eio->magic == EIO_MAGIC);
 
+	eio->thread  = pthread_self();
+	eio->running = true;
+#ifdef HAVE_SYS_EPOLL_H
+	if (eio->epfd >= 0) {
+		retval = _epoll_mainloop(eio);
+		if (retval != -2)
+			goto done;
+		retval = 0;	/* fall back to poll() and keep going */
+	}
+#endif
+
 	for (;;) {
 
 		/* Alloc memory for pfds and map if needed */
@@ -309,6 +409,7 @@ int eio_handle_mainloop(eio_handle_t *eio)
   error:
 	retval = -1;
   done:
+	eio->running = false;
 	xfree(pollfds);
 	xfree(map);
 	return retval;
@@ -473,6 +574,417 @@ _poll_handle_event(short revents, eio_obj_t *obj, List objList)
 	}
 }
 
+#ifdef HAVE_SYS_EPOLL_H
+/* Create the epoll instance of eio and register its signalling fd, which
+ * uses generation zero. Returns -1 on error. */
+static int
+_epoll_create(eio_handle_t *eio)
+{
+	struct epoll_event ev;
+
+	if ((eio->epfd = epoll_create(64)) < 0)
+		return -1;
+	fd_set_close_on_exec(eio->epfd);
+
+	memset(&ev, 0, sizeof(ev));
+	ev.events = EPOLLIN;
+	ev.data.u64 = EIO_EPOLL_DATA(0, eio->fds[0]);
+	if (epoll_ctl(eio->epfd, EPOLL_CTL_ADD, eio->fds[0], &ev) < 0) {
+		_epoll_destroy(eio);
+		return -1;
+	}
+	return 0;
+}
+
+/* Close the epoll instance of eio and forget all registrations, which
+ * leaves eio using poll() */
+static void
+_epoll_destroy(eio_handle_t *eio)
+{
+	if (eio->epfd >= 0)
+		close(eio->epfd);
+	eio->epfd = -1;
+	xfree(eio->ep_fds);
+	eio->ep_size = 0;
+}
+
+/*
+ * Main loop of the epoll backend, see eio_handle_mainloop().
+ * Returns -2 if the epoll instance had to be abandoned, in which case the
+ * caller continues with poll().
+ */
+static int
+_epoll_mainloop(eio_handle_t *eio)
+{
+	int                 retval   = 0;
+	struct epoll_event *events   = NULL;
+	struct pollfd      *pend     = NULL;
+	eio_obj_t         **pend_map = NULL;
+	unsigned int        maxnfds  = 0, npend;
+	int                 i, n, nobjs, timeout;
+	bool                stale;
+
+	eio->ep_full = true;
+	for (;;) {
+		n = list_count(eio->obj_list);
+		if (maxnfds < n) {
+			maxnfds = n;
+			xrealloc(events,   (maxnfds+1) * sizeof(*events));
+			xrealloc(pend,     maxnfds * sizeof(struct pollfd));
+			xrealloc(pend_map, maxnfds * sizeof(eio_obj_t *));
+		}
+
+		debug4("eio: handling events for %d objects", n);
+		nobjs = _epoll_setup(eio, pend, pend_map, &npend);
+		if (nobjs < 0) {
+			retval = -2;
+			goto done;
+		}
+		if (nobjs == 0)
+			goto done;
+
+		/* fds which epoll can not watch (e.g. regular files) are
+		 * always ready, as they would be for poll(). Don't wait
+		 * either if checking objects changed others. */
+		if (npend || eio->ep_full || eio->ep_nchg)
+			timeout = 0;
+		else if (eio_shutdown_time)
+			timeout = 1000;	/* Return every 1000 msec */
+		else
+			timeout = -1;
+		while ((n = epoll_wait(eio->epfd, events, maxnfds + 1,
+				       timeout)) < 0) {
+			if (errno == EINTR) {
+				n = 0;
+				break;
+			}
+			if (errno != EAGAIN) {
+				error("epoll_wait: %m");
+				retval = -1;
+				goto done;
+			}
+		}
+
+		/* Without events the wait timed out or was interrupted,
+		 * which is when poll() picks up any change it was not told
+		 * about */
+		if ((n == 0) && (timeout != 0))
+			eio->ep_full = true;
+		for (i = 0; i < n; i++) {
+			if ((events[i].data.u64 >> 32) == 0) {
+				_eio_wakeup_handler(eio);
+				eio->ep_full = true;
+				break;
+			}
+		}
+
+		stale = false;
+		for (i = 0; i < n; i++) {
+			uint32_t gen = events[i].data.u64 >> 32;
+			int fd = events[i].data.u64 & 0xffffffff;
+			eio_epoll_fd_t *ent;
+			eio_obj_t *obj;
+
+			if (gen == 0)
+				continue;
+			ent = (fd < eio->ep_size) ? &eio->ep_fds[fd] : NULL;
+			if (!ent || !ent->obj || (ent->gen != gen)) {
+				stale = true;
+				continue;
+			}
+			/* An object not checked on this pass may no longer
+			 * want what it is registered for */
+			obj = ent->obj;
+			if ((obj->ep_pass != eio->ep_pass) &&
+			    (_epoll_check(eio, obj, pend, pend_map,
+					  &npend) < 0)) {
+				retval = -2;
+				goto done;
+			}
+			if (obj->ep_fd != fd)
+				continue;
+			_epoll_changed(eio, obj);
+			_poll_handle_event(_epoll_to_poll(events[i].events &
+					   (obj->ep_events | EPOLLERR |
+					    EPOLLHUP)), obj, eio->obj_list);
+			/* A handler need not consume everything that is
+			 * ready, so re-arm the fd with epoll_ctl() on the
+			 * next pass to be told again if it still is */
+			if (eio->edge && (eio->ep_fds[fd].obj == obj))
+				eio->ep_fds[fd].events = 0;
+		}
+		for (i = 0; i < npend; i++)
+			_epoll_changed(eio, pend_map[i]);
+		_poll_dispatch(pend, npend, pend_map, eio->obj_list);
+
+		if (stale) {
+			ListIterator iter;
+			eio_obj_t *obj;
+
+			/* Registrations of closed fds can not be removed,
+			 * start over with a new epoll instance */
+			debug("eio: rebuilding epoll set");
+			_epoll_destroy(eio);
+			if (_epoll_create(eio) < 0) {
+				error("eio: epoll_create: %m, using poll");
+				retval = -2;
+				goto done;
+			}
+			iter = list_iterator_create(eio->obj_list);
+			while ((obj = list_next(iter)))
+				obj->ep_fd = -1;
+			list_iterator_destroy(iter);
+			eio->ep_full = true;
+		}
+
+		if (eio_shutdown_time &&
+		    (difftime(time(NULL), eio_shutdown_time) >=
+		     EIO_SHUTDOWN_WAIT)) {
+			error("Abandoning IO %d secs after job shutdown "
+			      "initiated", EIO_SHUTDOWN_WAIT);
+			break;
+		}
+	}
+	retval = -1;
+  done:
+	if (retval == -2)
+		_epoll_destroy(eio);
+	xfree(events);
+	xfree(pend);
+	xfree(pend_map);
+	return retval;
+}
+
+/* Use the backend named by SLURM_EIO_BACKEND for eio */
+static void
+_epoll_select(eio_handle_t *eio)
+{
+	char *backend = getenv("SLURM_EIO_BACKEND");
+
+	if (!backend || !strcmp(backend, "poll"))
+		return;
+
+	if (!strcmp(backend, "epoll_edge")) {
+		eio->edge = true;
+	} else if (strcmp(backend, "epoll")) {
+		error("eio: invalid SLURM_EIO_BACKEND %s, using poll", backend);
+		return;
+	}
+	if (_epoll_create(eio) < 0)
+		error("eio: epoll_create: %m, using poll");
+}
+
+/* Queue obj to be checked on the next pass of the epoll main loop */
+static void
+_epoll_changed(eio_handle_t *eio, eio_obj_t *obj)
+{
+	if (obj->ep_changed)
+		return;
+	if (eio->ep_nchg >= eio->ep_chg_size) {
+		eio->ep_chg_size = MAX(64, eio->ep_chg_size * 2);
+		xrealloc(eio->ep_chg, eio->ep_chg_size * sizeof(eio_obj_t *));
+	}
+	eio->ep_chg[eio->ep_nchg++] = obj;
+	obj->ep_changed = true;
+}
+
+/*
+ * Check the events obj wants and bring its epoll registration in line with
+ * them, as _poll_setup_pollfds() does for poll(). If epoll can not watch
+ * the fd of obj (e.g. a regular file) obj is added to pend and pend_map
+ * with the events to dispatch to it.
+ * RET 0 on success, -1 if epoll can not be used
+ */
+static int
+_epoll_check(eio_handle_t *eio, eio_obj_t *obj, struct pollfd *pend,
+	     eio_obj_t **pend_map, unsigned int *npend)
+{
+	eio_epoll_fd_t *ent;
+	struct epoll_event ev;
+	uint32_t        want = 0;
+	int             fd;
+	bool            readable, writable;
+
+	obj->ep_pass = eio->ep_pass;
+	writable = _is_writable(obj);
+	readable = _is_readable(obj);
+	if (readable) {
+		want |= EPOLLIN;
+#ifdef EPOLLRDHUP
+		want |= EPOLLRDHUP;
+#endif
+	}
+	if (writable)
+		want |= EPOLLOUT | EPOLLHUP;
+	if (want && !obj->ep_events)
+		eio->ep_nobjs++;
+	else if (!want && obj->ep_events)
+		eio->ep_nobjs--;
+	obj->ep_events = want;
+
+	memset(&ev, 0, sizeof(ev));
+	fd = want ? obj->fd : -1;	/* fd < 0 is ignored, as by poll() */
+	if ((obj->ep_fd >= 0) && (obj->ep_fd != fd)) {
+		/* Drop the registration no longer wanted. A registration
+		 * of a closed fd is dropped by the kernel, or recognized by
+		 * its generation should the open file live on elsewhere. */
+		ent = &eio->ep_fds[obj->ep_fd];
+		if (ent->obj == obj) {
+			(void) epoll_ctl(eio->epfd, EPOLL_CTL_DEL, obj->ep_fd,
+					 &ev);
+			ent->obj = NULL;
+		}
+		obj->ep_fd = -1;
+	}
+	if (fd < 0)
+		return 0;
+
+	if (fd >= eio->ep_size) {
+		int size = MAX(fd + 1, eio->ep_size * 2);
+		xrealloc(eio->ep_fds, size * sizeof(eio_epoll_fd_t));
+		eio->ep_size = size;
+	}
+	ent = &eio->ep_fds[fd];
+	if (ent->obj && (ent->obj != obj) &&
+	    (ent->obj->ep_pass != eio->ep_pass) &&
+	    (_epoll_check(eio, ent->obj, pend, pend_map, npend) < 0))
+		return -1;
+	if (ent->obj && (ent->obj != obj)) {
+		if ((ent->obj->ep_fd == fd) && (ent->obj->fd == fd)) {
+			/* epoll holds one registration per fd */
+			debug("eio: fd %d shared by objects, using poll", fd);
+			return -1;
+		}
+		/* fd was closed by its last object and reopened */
+		ent->obj->ep_fd = -1;
+		ent->obj = NULL;
+	}
+	if ((ent->obj == obj) && (ent->events == want))
+		return 0;
+
+	ev.events = want;
+	if (eio->edge)
+		ev.events |= EPOLLET;
+	if (ent->obj) {
+		ev.data.u64 = EIO_EPOLL_DATA(ent->gen, fd);
+		if (epoll_ctl(eio->epfd, EPOLL_CTL_MOD, fd, &ev) == 0) {
+			ent->events = want;
+			return 0;
+		}
+		/* fd was closed and perhaps reopened */
+		ent->obj = NULL;
+		obj->ep_fd = -1;
+	}
+
+	if (++eio->ep_gen == 0)
+		eio->ep_gen = 1;
+	ent->gen = eio->ep_gen;
+	ev.data.u64 = EIO_EPOLL_DATA(ent->gen, fd);
+	if ((epoll_ctl(eio->epfd, EPOLL_CTL_ADD, fd, &ev) == 0) ||
+	    ((errno == EEXIST) &&
+	     (epoll_ctl(eio->epfd, EPOLL_CTL_MOD, fd, &ev) == 0))) {
+		ent->obj    = obj;
+		ent->events = want;
+		obj->ep_fd  = fd;
+	} else if ((errno == EPERM) || (errno == EBADF)) {
+		pend[*npend].fd = fd;
+		pend[*npend].revents = (errno == EBADF) ? POLLNVAL :
+			((readable ? POLLIN : 0) | (writable ? POLLOUT : 0));
+		pend_map[(*npend)++] = obj;
+	} else {
+		error("eio: epoll_ctl: %m, using poll");
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Bring the epoll registrations of eio in line with the events its objects
+ * want. Only the objects queued by _epoll_changed() are checked, unless
+ * every object is due to be. Objects whose fd epoll can not watch are
+ * returned in pend and pend_map with the events to dispatch to them.
+ * RET count of objects wanting events, or -1 if epoll can not be used
+ */
+static int
+_epoll_setup(eio_handle_t *eio, struct pollfd *pend, eio_obj_t **pend_map,
+	     unsigned int *npend)
+{
+	ListIterator    iter;
+	eio_obj_t      *obj, **chk;
+	int             i, n, nchk, rc = 0;
+
+	*npend = 0;
+
+	/* Take the queued objects, anything changed while checking them is
+	 * queued again for the next pass */
+	chk = eio->ep_chg;
+	nchk = eio->ep_nchg;
+	eio->ep_chg = eio->ep_chk;
+	eio->ep_chk = chk;
+	n = eio->ep_chg_size;
+	eio->ep_chg_size = eio->ep_chk_size;
+	eio->ep_chk_size = n;
+	eio->ep_nchg = 0;
+	for (i = 0; i < nchk; i++)
+		chk[i]->ep_changed = false;
+
+	if (++eio->ep_pass == 0)
+		eio->ep_pass = 1;
+	if (eio->ep_full) {
+		/* objects queued by eio_new_obj() from within a handler */
+		list_transfer(eio->obj_list, eio->new_objs);
+	}
+	n = list_count(eio->obj_list);
+	if (n != eio->ep_nknown) {
+		eio->ep_nknown = n;
+		eio->ep_full = true;
+	}
+
+	if (eio->ep_full) {
+		eio->ep_full = false;
+		iter = list_iterator_create(eio->obj_list);
+		while ((rc == 0) && (obj = list_next(iter))) {
+			if (obj->ep_pass != eio->ep_pass)
+				rc = _epoll_check(eio, obj, pend, pend_map,
+						  npend);
+		}
+		list_iterator_destroy(iter);
+	} else {
+		for (i = 0; (rc == 0) && (i < nchk); i++) {
+			obj = chk[i];
+			if (obj->ep_pass != eio->ep_pass)
+				rc = _epoll_check(eio, obj, pend, pend_map,
+						  npend);
+		}
+	}
+	if (rc < 0)
+		return rc;
+
+	return eio->ep_nobjs;
+}
+
+/* Translate epoll events to the poll() events _poll_handle_event() takes */
+static short
+_epoll_to_poll(uint32_t events)
+{
+	short revents = 0;
+
+	if (events & EPOLLIN)
+		revents |= POLLIN;
+	if (events & EPOLLOUT)
+		revents |= POLLOUT;
+	if (events & EPOLLERR)
+		revents |= POLLERR;
+	if (events & EPOLLHUP)
+		revents |= POLLHUP;
+#if defined(EPOLLRDHUP) && defined(POLLRDHUP)
+	if (events & EPOLLRDHUP)
+		revents |= POLLRDHUP;
+#endif
+	return revents;
+}
+#endif
+
 static struct io_operations *
 _ops_copy(struct io_operations *ops)
 {
@@ -491,6 +1003,7 @@ eio_obj_create(int fd, struct io_operations *ops, void *arg)
 	obj->arg = arg;
 	obj->ops = _ops_copy(ops);
 	obj->shutdown = false;
+	obj->ep_fd = -1;
 	return obj;
 }
 
@@ -539,3 +1052,23 @@ void eio_new_obj(eio_handle_t *eio, eio_obj_t *obj)
 	list_enqueue(eio->new_objs, obj);
 	eio_signal_wakeup(eio);
 }
+
+/*
+ * Tell the main loop of "eio" that the readable() or writable() function of
+ * "obj" may have changed its answer.
+ */
+void eio_obj_changed(eio_handle_t *eio, eio_obj_t *obj)
+{
+	xassert(eio != NULL);
+	xassert(eio->magic == EIO_MAGIC);
+
+	if (!_in_mainloop(eio)) {
+		eio_signal_wakeup(eio);
+		return;
+	}
+#ifdef HAVE_SYS_EPOLL_H
+	/* poll() checks every object on each pass anyway */
+	if (eio->epfd >= 0)
+		_epoll_changed(eio, obj);
+#endif
+}
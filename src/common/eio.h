@@ -67,6 +67,12 @@ struct eio_obj {
 	void *arg;                        /* application-specific data       */
 	struct io_operations *ops;        /* pointer to ops struct for obj   */
 	bool shutdown;
+
+	/* Private to eio.c */
+	int ep_fd;                        /* fd registered with epoll or -1  */
+	uint32_t ep_events;               /* events wanted when last checked */
+	uint32_t ep_pass;                 /* main loop pass last checked     */
+	bool ep_changed;                  /* queued to be checked            */
 };
 
 eio_handle_t *eio_handle_create(void);
@@ -104,6 +110,18 @@ int eio_message_socket_accept(eio_obj_t *obj, List objs);
 int eio_signal_wakeup(eio_handle_t *eio);
 int eio_signal_shutdown(eio_handle_t *eio);
 
+/*
+ * Tell the main loop of "eio" that the readable() or writable() function of
+ * "obj" may now return a different answer. The epoll backend only checks
+ * the objects it dispatched on its last pass and those passed here, so a
+ * handler which makes another object readable or writable (e.g. by queuing
+ * a message for it or by freeing a buffer it waits on) must call this.
+ * Changes which are not tied to one object are announced with
+ * eio_signal_wakeup(), which has every object checked. From another thread
+ * this is the same as eio_signal_wakeup().
+ */
+void eio_obj_changed(eio_handle_t *eio, eio_obj_t *obj);
+
 eio_obj_t *eio_obj_create(int fd, struct io_operations *ops, void *arg);
 void eio_obj_destroy(void *arg);
 
@@ -2055,6 +2055,15 @@ int hostlist_push_host(hostlist_t hl, const char *str)
 	return hostlist_push_host_dims(hl, str, dims);
 }
 
+int hostlist_push_numeric_range(hostlist_t hl, const char *prefix,
+				unsigned long lo, unsigned long hi, int width)
+{
+	if (!prefix || !hl || (lo > hi))
+		return -1;
+
+	return hostlist_push_hr(hl, (char *) prefix, lo, hi, width);
+}
+
 int hostlist_push_list(hostlist_t h1, hostlist_t h2)
 {
 	int i, n = 0;
@@ -3708,6 +3717,34 @@ int hostset_find(hostset_t set, const char *hostname)
 	return hostlist_find(set->hl, hostname);
 }
 
+int hostlist_nth_numeric_range(hostlist_t hl, int n, char **prefix,
+			       unsigned long *lo, unsigned long *hi,
+			       int *width)
+{
+	hostrange_t hr;
+	int rc;
+
+	LOCK_HOSTLIST(hl);
+	if ((n < 0) || (n >= hl->nranges)) {
+		UNLOCK_HOSTLIST(hl);
+		return -1;
+	}
+
+	hr = hl->hr[n];
+	*prefix = hr->prefix;
+	if (hr->singlehost) {
+		rc = 0;
+	} else {
+		*lo = hr->lo;
+		*hi = hr->hi;
+		*width = hr->width;
+		rc = 1;
+	}
+	UNLOCK_HOSTLIST(hl);
+
+	return rc;
+}
+
 #if TEST_MAIN
 
 int hostlist_nranges(hostlist_t hl)
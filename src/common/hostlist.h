@@ -206,6 +206,18 @@ int hostlist_push_host_dims(hostlist_t hl, const char *str, int dims);
 int hostlist_push_host(hostlist_t hl, const char *host);
 
 
+/* hostlist_push_numeric_range():
+ *
+ * Push the hosts prefix<lo> through prefix<hi> onto the hostlist hl,
+ * with the numeric suffix zero padded to width digits, without building
+ * each hostname.
+ *
+ * Returns the number of hosts in hl, or -1 on failure.
+ */
+int hostlist_push_numeric_range(hostlist_t hl, const char *prefix,
+				unsigned long lo, unsigned long hi, int width);
+
+
 /* hostlist_push_list():
  *
  * Push a hostlist (hl2) onto another list (hl1)
@@ -406,6 +418,22 @@ char *hostlist_deranged_string_xmalloc(hostlist_t hl);
  */
 int hostlist_nranges(hostlist_t hl);
 
+/* hostlist_nth_numeric_range():
+ *
+ * Return the components of the n'th range held in hostlist hl, so that
+ * callers can map a range of hostnames without building each of them.
+ * prefix is set to memory within hl which is only valid until hl is
+ * modified, the caller must not free it.
+ *
+ * Returns 1 if the range holds the hosts prefix<lo> through prefix<hi>,
+ * with their suffix zero padded to width digits, 0 if it holds a single
+ * host named prefix (lo, hi and width are not set) or -1 if hl holds no
+ * n'th range.
+ */
+int hostlist_nth_numeric_range(hostlist_t hl, int n, char **prefix,
+			       unsigned long *lo, unsigned long *hi,
+			       int *width);
+
 
 /* ----[ hostlist iterator functions ]---- */
 
@@ -536,9 +536,13 @@ list_flush (List l)
 void
 list_sort (List l, ListCmpF f)
 {
-/*  Note: Time complexity O(n^2).
+/*  Note: Time complexity O(n log n).
+ *    Bottom-up merge sort of the linked nodes in place: each pass merges
+ *    adjacent runs of [insize] nodes, doubling [insize] until a single run
+ *    remains.  Ties are taken from the earlier run, so the sort is stable.
  */
-    ListNode *pp, *ppPrev, *ppPos, pTmp;
+    ListNode p, q, e, head, tail;
+    int insize, nmerges, psize, qsize, n;
     ListIterator i;
 
     assert(l != NULL);
@@ -546,26 +550,51 @@ list_sort (List l, ListCmpF f)
     list_mutex_lock(&l->mutex);
     assert(l->magic == LIST_MAGIC);
     if (l->count > 1) {
-	ppPrev = &l->head;
-	pp = &(*ppPrev)->next;
-	while (*pp) {
-	    if (f((*pp)->data, (*ppPrev)->data) < 0) {
-		ppPos = &l->head;
-		while (f((*pp)->data, (*ppPos)->data) >= 0)
-		    ppPos = &(*ppPos)->next;
-		pTmp = (*pp)->next;
-		(*pp)->next = *ppPos;
-		*ppPos = *pp;
-		*pp = pTmp;
-		if (ppPrev == ppPos)
-		    ppPrev = &(*ppPrev)->next;
+	head = l->head;
+	tail = NULL;
+	insize = 1;
+	do {
+	    p = head;
+	    head = tail = NULL;
+	    nmerges = 0;
+	    while (p) {
+		nmerges++;
+		q = p;
+		psize = 0;
+		for (n = 0; (n < insize) && q; n++) {
+		    psize++;
+		    q = q->next;
+		}
+		qsize = insize;
+		while ((psize > 0) || ((qsize > 0) && q)) {
+		    if (psize == 0) {
+			e = q;
+			q = q->next;
+			qsize--;
+		    }
+		    else if ((qsize == 0) || !q || (f(p->data, q->data) <= 0)) {
+			e = p;
+			p = p->next;
+			psize--;
+		    }
+		    else {
+			e = q;
+			q = q->next;
+			qsize--;
+		    }
+		    if (tail)
+			tail->next = e;
+		    else
+			head = e;
+		    tail = e;
+		}
+		p = q;
 	    }
-	    else {
-		ppPrev = pp;
-		pp = &(*pp)->next;
-	    }
-	}
-	l->tail = pp;
+	    tail->next = NULL;
+	    insize *= 2;
+	} while (nmerges > 1);
+	l->head = head;
+	l->tail = &tail->next;
 
 	for (i=l->iNext; i; i=i->iNext) {
 	    assert(i->magic == LIST_MAGIC);
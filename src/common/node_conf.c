@@ -90,6 +90,29 @@ int node_record_count = 0;		/* count in node_record_table_ptr */
 uint16_t *cr_node_num_cores = NULL;
 uint32_t *cr_node_cores_offset = NULL;
 
+/* node_hash_table has the power of two number of slots closest above
+ * node_record_count, so names are spread with at most one per slot on
+ * average and the slot is found with a mask rather than a division */
+static int node_hash_size = 0;
+
+/* Runs of nodes, consecutive in node_record_table_ptr, whose names share a
+ * prefix and have numeric suffixes counting up by one (e.g. nid[00001-20000]).
+ * They let node_name2bitmap() and bitmap2node_name() map hostlist ranges to
+ * node indexes without building or hashing each name. Nodes without a
+ * numeric suffix form runs of one with a width of zero. Built by
+ * rehash_node() in node index order, so the runs partition the table. */
+typedef struct node_name_range {
+	char *prefix;		/* name up to the numeric suffix, NULL for
+				 * vestigial records */
+	unsigned long lo, hi;	/* numeric suffixes of first and last node */
+	int width;		/* digits in the numeric suffix */
+	int inx;		/* node_record_table_ptr index of lo */
+} node_name_range_t;
+static node_name_range_t *node_range_table = NULL;
+static int node_range_count = 0;
+static int *node_range_sorted = NULL;	/* node_range_table indexes ordered
+					 * by prefix */
+
 static void	_add_config_feature(char *feature, bitstr_t *node_bitmap);
 static int	_build_single_nodeline_info(slurm_conf_node_t *node_ptr,
 					    struct config_record *config_ptr);
@@ -98,11 +121,21 @@ static int	_delete_config_record (void);
 static void	_dump_hash (void);
 #endif
 static struct node_record *_find_alias_node_record (char *name);
+static void	_free_node_ranges (void);
 static int	_hash_index (char *name);
 static void	_list_delete_config (void *config_entry);
 static void	_list_delete_feature (void *feature_entry);
 static int	_list_find_config (void *config_entry, void *key);
 static int	_list_find_feature (void *feature_entry, void *key);
+static void	_node_ranges_build (void);
+static int	_node_range_cmp (const void *r1, const void *r2);
+static bool	_node_range2bitmap (char *prefix, unsigned long lo,
+				    unsigned long hi, int width,
+				    bitstr_t *bitmap);
+static hostlist_t _node_ranges2bitmap (hostlist_t host_list,
+				       bitstr_t *bitmap);
+static void	_push_node_ranges (hostlist_t hl, bitstr_t *bitmap,
+				   int first, int last);
 
 
 static void _add_config_feature(char *feature, bitstr_t *node_bitmap)
@@ -336,7 +369,7 @@ static void _dump_hash (void)
 	if (node_hash_table == NULL)
 		return;
 
-	for (i = 0; i < node_record_count; i++) {
+	for (i = 0; i < node_hash_size; i++) {
 		node_ptr = node_hash_table[i];
 		while (node_ptr) {
 			inx = node_ptr -  node_record_table_ptr;
@@ -404,6 +437,18 @@ static struct node_record *_find_alias_node_record (char *name)
 	return (struct node_record *) NULL;
 }
 
+/* _free_node_ranges - free the node name ranges built by rehash_node() */
+static void _free_node_ranges (void)
+{
+	int i;
+
+	for (i = 0; i < node_range_count; i++)
+		xfree(node_range_table[i].prefix);
+	xfree(node_range_table);
+	xfree(node_range_sorted);
+	node_range_count = 0;
+}
+
 /*
  * _hash_index - return a hash table index for the given node name
  * IN name = the node's name
@@ -411,24 +456,22 @@ static struct node_record *_find_alias_node_record (char *name)
  */
 static int _hash_index (char *name)
 {
-	int index = 0;
-	int j;
+	uint32_t hash = 2166136261U;	/* FNV-1a offset basis */
 
-	if ((node_record_count == 0) ||
+	if ((node_hash_size == 0) ||
 	    (name == NULL))
 		return 0;	/* degenerate case */
 
-	/* Multiply each character by its numerical position in the
-	 * name string to add a bit of entropy, because host names such
-	 * as cluster[0001-1000] can cause excessive index collisions.
+	/* FNV-1a mixes every character into all of the low order bits,
+	 * so host names such as cluster[0001-1000] which differ only in
+	 * their trailing digits are spread evenly over the table.
 	 */
-	for (j = 1; *name; name++, j++)
-		index += (int)*name * j;
-	index %= node_record_count;
-	if (index < 0)
-		index += node_record_count;
+	for ( ; *name; name++) {
+		hash ^= (unsigned char) *name;
+		hash *= 16777619;	/* FNV prime */
+	}
 
-	return index;
+	return (int) (hash & (node_hash_size - 1));
 }
 
 /* _list_delete_config - delete an entry from the config list,
@@ -500,10 +543,14 @@ char * bitmap2node_name_sortable (bitstr_t *bitmap, bool sort)
 
 	last  = bit_fls(bitmap);
 	hl = hostlist_create("");
-	for (i = first; i <= last; i++) {
-		if (bit_test(bitmap, i) == 0)
-			continue;
-		hostlist_push(hl, node_record_table_ptr[i].name);
+	if (node_range_count) {
+		_push_node_ranges(hl, bitmap, first, last);
+	} else {
+		for (i = first; i <= last; i++) {
+			if (bit_test(bitmap, i) == 0)
+				continue;
+			hostlist_push(hl, node_record_table_ptr[i].name);
+		}
 	}
 	if (sort)
 		hostlist_sort(hl);
@@ -527,6 +574,40 @@ char * bitmap2node_name (bitstr_t *bitmap)
 	return bitmap2node_name_sortable(bitmap, 1);
 }
 
+/*
+ * bitmap2node_name_cache - bitmap2node_name() for a bitmap which is converted
+ *	repeatedly, returning the previous node list while the bitmap is
+ *	unchanged
+ * IN bitmap - bitmap pointer
+ * IN/OUT cache_bitmap - copy of the bitmap the cached node list was built from
+ * IN/OUT cache_str - cached node list
+ * RET pointer to node list, which is *cache_str
+ * globals: node_record_table_ptr - pointer to node table
+ * NOTE: the caller must free cache_bitmap and cache_str when no longer
+ *	required, but not the returned pointer
+ */
+char * bitmap2node_name_cache (bitstr_t *bitmap, bitstr_t **cache_bitmap,
+			       char **cache_str)
+{
+	if (bitmap && *cache_bitmap && *cache_str &&
+	    bit_equal(bitmap, *cache_bitmap))
+		return *cache_str;
+
+	xfree(*cache_str);
+	*cache_str = bitmap2node_name(bitmap);
+	if (bitmap == NULL) {
+		FREE_NULL_BITMAP(*cache_bitmap);
+	} else if (*cache_bitmap &&
+		   (bit_size(*cache_bitmap) == bit_size(bitmap))) {
+		bit_copybits(*cache_bitmap, bitmap);
+	} else {
+		FREE_NULL_BITMAP(*cache_bitmap);
+		*cache_bitmap = bit_copy(bitmap);
+	}
+
+	return *cache_str;
+}
+
 /*
  * _list_find_feature - find an entry in the feature list, see list.h for
  *	documentation
@@ -546,6 +627,210 @@ static int _list_find_feature (void *feature_entry, void *key)
 	return 0;
 }
 
+/*
+ * _node_ranges_build - split the node names into runs of a common prefix
+ *	and consecutive numeric suffixes, see node_range_table
+ * globals: node_record_table_ptr - pointer to node table
+ */
+static void _node_ranges_build (void)
+{
+	int i, len, end, width;
+	unsigned long num;
+	char *name;
+	node_name_range_t *range = NULL;
+
+	_free_node_ranges();
+
+	/* Multi-dimensional systems encode node coordinates in their
+	 * suffixes, which hostlists do not treat as decimal numbers */
+	if ((node_record_count == 0) ||
+	    (slurmdb_setup_cluster_name_dims() > 1))
+		return;
+
+	node_range_table = xmalloc(sizeof(node_name_range_t) *
+				   node_record_count);
+	for (i = 0; i < node_record_count; i++) {
+		name = node_record_table_ptr[i].name;
+		if ((name == NULL) || (name[0] == '\0')) {
+			range = &node_range_table[node_range_count++];
+			range->inx = i;
+			continue;	/* vestigial record */
+		}
+
+		len = end = strlen(name);
+		while ((end > 0) && isdigit((int) name[end - 1]))
+			end--;
+		width = len - end;
+		if (width > 9)
+			width = 0;	/* may overflow, match by name */
+		num = width ? strtoul(name + end, NULL, 10) : 0;
+
+		if (width && range && (range->width == width) &&
+		    (range->hi + 1 == num) && range->prefix &&
+		    (strlen(range->prefix) == end) &&
+		    !strncmp(range->prefix, name, end)) {
+			range->hi = num;
+			continue;
+		}
+
+		range = &node_range_table[node_range_count++];
+		range->prefix = width ? xstrndup(name, end) : xstrdup(name);
+		range->lo = range->hi = num;
+		range->width = width;
+		range->inx = i;
+	}
+
+	node_range_sorted = xmalloc(sizeof(int) * node_range_count);
+	for (i = 0; i < node_range_count; i++)
+		node_range_sorted[i] = i;
+	qsort(node_range_sorted, node_range_count, sizeof(int),
+	      _node_range_cmp);
+}
+
+/* _node_range_cmp - order node_range_sorted entries by prefix, vestigial
+ *	records last */
+static int _node_range_cmp (const void *r1, const void *r2)
+{
+	char *p1 = node_range_table[*(int *) r1].prefix;
+	char *p2 = node_range_table[*(int *) r2].prefix;
+
+	if (p1 == NULL)
+		return (p2 == NULL) ? 0 : 1;
+	if (p2 == NULL)
+		return -1;
+	return strcmp(p1, p2);
+}
+
+/*
+ * _node_range2bitmap - set the bits of the nodes named prefix<lo> through
+ *	prefix<hi>, the suffix zero padded to width digits as in a hostlist
+ * RET true if every one of the names was found
+ */
+static bool _node_range2bitmap (char *prefix, unsigned long lo,
+				unsigned long hi, int width, bitstr_t *bitmap)
+{
+	int low = 0, high = node_range_count, mid;
+	unsigned long first, last, found = 0;
+	node_name_range_t *range;
+
+	/* Find the first range with this prefix */
+	while (low < high) {
+		mid = (low + high) / 2;
+		range = &node_range_table[node_range_sorted[mid]];
+		if (range->prefix && (strcmp(range->prefix, prefix) < 0))
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	for ( ; low < node_range_count; low++) {
+		range = &node_range_table[node_range_sorted[low]];
+		if (!range->prefix || strcmp(range->prefix, prefix))
+			break;
+		/* A hostlist pads the suffix to width digits, so only
+		 * suffixes written with exactly range->width digits match */
+		if ((range->width == 0) || (range->width < width))
+			continue;
+		first = MAX(lo, range->lo);
+		last  = MIN(hi, range->hi);
+		if (range->width > width) {
+			unsigned long min_num = 1;
+			int i;
+			for (i = 1; i < range->width; i++)
+				min_num *= 10;
+			first = MAX(first, min_num);
+		}
+		if (first > last)
+			continue;
+		bit_nset(bitmap, range->inx + (first - range->lo),
+			 range->inx + (last - range->lo));
+		found += last - first + 1;
+	}
+
+	return (found == hi - lo + 1);
+}
+
+/*
+ * _node_ranges2bitmap - set the bits of the nodes in host_list, taking whole
+ *	numeric ranges at a time from node_range_table
+ * IN host_list - hostlist to resolve, destroyed
+ * OUT bitmap - bits set for the nodes found
+ * RET hostlist of the names which must be resolved one at a time, either
+ *	because they are not in node_range_table (aliases or invalid names)
+ *	or because they have no numeric suffix
+ */
+static hostlist_t _node_ranges2bitmap (hostlist_t host_list,
+				       bitstr_t *bitmap)
+{
+	hostlist_t miss_list = hostlist_create("");
+	unsigned long lo, hi;
+	int i, rc, width;
+	char *prefix;
+
+	for (i = 0; ; i++) {
+		rc = hostlist_nth_numeric_range(host_list, i, &prefix,
+						&lo, &hi, &width);
+		if (rc < 0)
+			break;
+		if (rc == 0)
+			hostlist_push_host(miss_list, prefix);
+		else if (!_node_range2bitmap(prefix, lo, hi, width, bitmap))
+			hostlist_push_numeric_range(miss_list, prefix,
+						    lo, hi, width);
+	}
+	hostlist_destroy(host_list);
+
+	return miss_list;
+}
+
+/*
+ * _push_node_ranges - push the names of the nodes set in bitmap between
+ *	first and last onto hl, a run of node_range_table at a time
+ */
+static void _push_node_ranges (hostlist_t hl, bitstr_t *bitmap,
+			       int first, int last)
+{
+	int low = 0, high = node_range_count - 1, mid;
+	int i, j, end;
+	node_name_range_t *range;
+
+	/* Find the range holding the first node */
+	while (low < high) {
+		mid = (low + high + 1) / 2;
+		if (node_range_table[mid].inx <= first)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+
+	for ( ; (low < node_range_count) && (first <= last); low++) {
+		range = &node_range_table[low];
+		end = range->inx + (range->hi - range->lo);
+		for (i = first; i <= MIN(end, last); i++) {
+			if (!bit_test(bitmap, i))
+				continue;
+			for (j = i; (j < MIN(end, last)) &&
+				    bit_test(bitmap, j + 1); j++)
+				;
+			if (range->width) {
+				hostlist_push_numeric_range(hl, range->prefix,
+						range->lo + (i - range->inx),
+						range->lo + (j - range->inx),
+						range->width);
+			} else
+				hostlist_push_host(hl, range->prefix);
+			i = j;
+		}
+		first = end + 1;
+	}
+
+	/* Nodes added since rehash_node() */
+	for (i = first; i <= last; i++) {
+		if (bit_test(bitmap, i))
+			hostlist_push_host(hl, node_record_table_ptr[i].name);
+	}
+}
+
 #ifdef HAVE_FRONT_END
 /* Log the contents of a frontend record */
 static void _dump_front_end(slurm_conf_frontend_t *fe_ptr)
@@ -783,6 +1068,7 @@ extern struct node_record *create_node_record (
 	node_ptr->tmp_disk = config_ptr->tmp_disk;
 	node_ptr->select_nodeinfo = select_g_select_nodeinfo_alloc();
 	node_ptr->energy = acct_gather_energy_alloc();
+	node_ptr->last_update = time(NULL);
 	xassert (node_ptr->magic = NODE_MAGIC)  /* set value */;
 	return node_ptr;
 }
@@ -857,6 +1143,8 @@ extern int init_node_conf (void)
 	node_record_count = 0;
 	xfree(node_record_table_ptr);
 	xfree(node_hash_table);
+	node_hash_size = 0;
+	_free_node_ranges();
 
 	if (config_list)	/* delete defunct configuration entries */
 		(void) _delete_config_record ();
@@ -891,6 +1179,8 @@ extern void node_fini2 (void)
 
 	xfree(node_record_table_ptr);
 	xfree(node_hash_table);
+	node_hash_size = 0;
+	_free_node_ranges();
 	node_record_count = 0;
 }
 
@@ -928,6 +1218,11 @@ extern int node_name2bitmap (char *node_names, bool best_effort,
 		return rc;
 	}
 
+	/* Whole ranges of names are mapped directly, leaving any aliases,
+	 * invalid names and names without numeric suffixes */
+	if (node_range_count)
+		host_list = _node_ranges2bitmap(host_list, my_bitmap);
+
 	while ( (this_node_name = hostlist_shift (host_list)) ) {
 		struct node_record *node_ptr;
 		node_ptr = find_node_record (this_node_name);
@@ -977,8 +1272,10 @@ extern void rehash_node (void)
 	struct node_record *node_ptr = node_record_table_ptr;
 
 	xfree (node_hash_table);
+	for (node_hash_size = 1; node_hash_size < node_record_count; )
+		node_hash_size *= 2;
 	node_hash_table = xmalloc (sizeof (struct node_record *) *
-				   node_record_count);
+				   node_hash_size);
 
 	for (i = 0; i < node_record_count; i++, node_ptr++) {
 		if ((node_ptr->name == NULL) ||
@@ -988,6 +1285,7 @@ extern void rehash_node (void)
 		node_ptr->node_next = node_hash_table[inx];
 		node_hash_table[inx] = node_ptr;
 	}
+	_node_ranges_build();
 
 #if _DEBUG
 	_dump_hash();
@@ -105,6 +105,9 @@ struct node_record {
 	time_t slurmd_start_time;	/* Time of slurmd startup */
 	time_t last_response;		/* last response from the node */
 	time_t last_idle;		/* time node last become idle */
+	time_t last_update;		/* time of last update to this node,
+					 * for delta RPCs, no need to
+					 * save/restore */
 	uint16_t cpus;			/* count of processors on the node */
 	uint16_t boards; 		/* count of boards configured */
 	uint16_t sockets;		/* number of sockets per node */
@@ -189,6 +192,21 @@ char * bitmap2node_name_sortable (bitstr_t *bitmap, bool sort);
  */
 char * bitmap2node_name (bitstr_t *bitmap);
 
+/*
+ * bitmap2node_name_cache - bitmap2node_name() for a bitmap which is converted
+ *	repeatedly, returning the previous node list while the bitmap is
+ *	unchanged
+ * IN bitmap - bitmap pointer
+ * IN/OUT cache_bitmap - copy of the bitmap the cached node list was built from
+ * IN/OUT cache_str - cached node list
+ * RET pointer to node list, which is *cache_str
+ * globals: node_record_table_ptr - pointer to node table
+ * NOTE: the caller must free cache_bitmap and cache_str when no longer
+ *	required, but not the returned pointer
+ */
+char * bitmap2node_name_cache (bitstr_t *bitmap, bitstr_t **cache_bitmap,
+			       char **cache_str);
+
 /*
  * build_all_nodeline_info - get a array of slurm_conf_node_t structures
  *	from the slurm.conf reader, build table, and set values
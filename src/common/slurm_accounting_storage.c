@@ -178,6 +178,7 @@ typedef struct slurm_acct_storage_ops {
 				    struct step_record *step_ptr);
 	int  (*step_complete)      (void *db_conn,
 				    struct step_record *step_ptr);
+	int  (*batch)              (void *db_conn, bool batch);
 	int  (*job_suspend)        (void *db_conn,
 				    struct job_record *job_ptr);
 	List (*get_jobs_cond)      (void *db_conn, uint32_t uid,
@@ -245,6 +246,7 @@ static const char *syms[] = {
 	"jobacct_storage_p_job_complete",
 	"jobacct_storage_p_step_start",
 	"jobacct_storage_p_step_complete",
+	"jobacct_storage_p_batch",
 	"jobacct_storage_p_suspend",
 	"jobacct_storage_p_get_jobs_cond",
 	"jobacct_storage_p_archive",
@@ -828,6 +830,17 @@ extern int jobacct_storage_g_step_complete(void *db_conn,
 	return (*(ops.step_complete))(db_conn, step_ptr);
 }
 
+/*
+ * start or end a batch of step starts and completions, which the
+ * storage may hold back and write out together when the batch ends
+ */
+extern int jobacct_storage_g_batch(void *db_conn, bool batch)
+{
+	if (slurm_acct_storage_init(NULL) < 0)
+		return SLURM_ERROR;
+	return (*(ops.batch))(db_conn, batch);
+}
+
 /*
  * load into the storage a suspention of a job
  */
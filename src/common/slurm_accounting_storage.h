@@ -480,6 +480,15 @@ extern int jobacct_storage_g_step_start(void *db_conn,
 extern int jobacct_storage_g_step_complete(void *db_conn,
 					   struct step_record *step_ptr);
 
+/*
+ * start or end a batch of step starts and completions, which the
+ * storage may hold back and write out together when the batch ends
+ * IN: void * pointer returned from acct_storage_g_get_connection()
+ * IN: bool - true starts a batch, false writes it out and ends it
+ * RET: SLURM_SUCCESS on success SLURM_ERROR else
+ */
+extern int jobacct_storage_g_batch(void *db_conn, bool batch);
+
 /*
  * load into the storage a suspention of a job
  */
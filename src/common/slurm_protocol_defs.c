@@ -2045,6 +2045,20 @@ extern void slurm_free_slurmd_status(slurmd_status_t* slurmd_status_ptr)
 	}
 }
 
+/*
+ * slurm_free_job_info_delta_msg - free the incremental job information
+ *	response message
+ * IN msg - pointer to job information delta response message
+ */
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg)
+{
+	if (msg) {
+		slurm_free_job_info_msg(msg->job_info_msg);
+		xfree(msg->job_ids);
+		xfree(msg);
+	}
+}
+
 /*
  * slurm_free_job_info - free the job information response message
  * IN msg - pointer to job information response message
@@ -2153,6 +2167,20 @@ extern void slurm_free_front_end_info_members(front_end_info_t * front_end)
 	}
 }
 
+/*
+ * slurm_free_node_info_delta_msg - free the incremental node information
+ *	response message
+ * IN msg - pointer to node information delta response message
+ */
+extern void slurm_free_node_info_delta_msg(node_info_delta_msg_t * msg)
+{
+	if (msg) {
+		slurm_free_node_info_msg(msg->node_info_msg);
+		xfree(msg->node_inx);
+		xfree(msg);
+	}
+}
+
 /*
  * slurm_free_node_info - free the node information response message
  * IN msg - pointer to node information response message
@@ -224,6 +224,8 @@ typedef enum {
 	RESPONSE_STATS_RESET,
 	REQUEST_JOB_USER_INFO,
 	REQUEST_NODE_INFO_SINGLE,
+	RESPONSE_JOB_INFO_DELTA,
+	RESPONSE_NODE_INFO_DELTA,
 
 	REQUEST_UPDATE_JOB = 3001,
 	REQUEST_UPDATE_NODE,
@@ -522,6 +524,24 @@ typedef struct node_info_request_msg {
 	uint16_t show_flags;
 } node_info_request_msg_t;
 
+/* Response to REQUEST_JOB_INFO with SHOW_DELTA: records of jobs changed since
+ * the request's last_update plus the IDs of all jobs which would be reported
+ * by a full response, so the client can drop records of removed jobs */
+typedef struct job_info_delta_msg {
+	uint32_t  job_id_cnt;
+	uint32_t *job_ids;
+	job_info_msg_t *job_info_msg;
+} job_info_delta_msg_t;
+
+/* Response to REQUEST_NODE_INFO with SHOW_DELTA: records of nodes changed
+ * since the request's last_update plus their index in the node table */
+typedef struct node_info_delta_msg {
+	uint32_t  node_cnt;	/* total node record count */
+	uint32_t  node_inx_cnt;
+	uint32_t *node_inx;	/* table index of each node_info_msg record */
+	node_info_msg_t *node_info_msg;
+} node_info_delta_msg_t;
+
 typedef struct node_info_single_msg {
 	char *node_name;
 	uint16_t show_flags;
@@ -1033,6 +1053,7 @@ extern void slurm_free_last_update_msg(last_update_msg_t * msg);
 extern void slurm_free_return_code_msg(return_code_msg_t * msg);
 extern void slurm_free_job_alloc_info_msg(job_alloc_info_msg_t * msg);
 extern void slurm_free_job_info_request_msg(job_info_request_msg_t *msg);
+extern void slurm_free_job_info_delta_msg(job_info_delta_msg_t *msg);
 extern void slurm_free_job_step_info_request_msg(
 		job_step_info_request_msg_t *msg);
 extern void slurm_free_front_end_info_request_msg(
@@ -1143,6 +1164,7 @@ extern void slurm_free_job_step_info_members (job_step_info_t * msg);
 extern void slurm_free_front_end_info_msg (front_end_info_msg_t * msg);
 extern void slurm_free_front_end_info_members(front_end_info_t * front_end);
 extern void slurm_free_node_info_msg(node_info_msg_t * msg);
+extern void slurm_free_node_info_delta_msg(node_info_delta_msg_t * msg);
 extern void slurm_free_node_info_members(node_info_t * node);
 extern void slurm_free_partition_info_msg(partition_info_msg_t * msg);
 extern void slurm_free_partition_info_members(partition_info_t * part);
@@ -70,10 +70,12 @@
 #include "src/common/job_options.h"
 
 #define _pack_job_info_msg(msg,buf)		_pack_buffer_msg(msg,buf)
+#define _pack_job_info_delta_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_job_step_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_block_info_resp_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_front_end_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_node_info_msg(msg,buf)		_pack_buffer_msg(msg,buf)
+#define _pack_node_info_delta_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_partition_info_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_stats_response_msg(msg,buf)	_pack_buffer_msg(msg,buf)
 #define _pack_reserve_info_msg(msg,buf)		_pack_buffer_msg(msg,buf)
@@ -173,6 +175,8 @@ static int _unpack_node_info_single_msg(node_info_single_msg_t ** msg,
 
 static int _unpack_node_info_msg(node_info_msg_t ** msg, Buf buffer,
 				 uint16_t protocol_version);
+static int _unpack_node_info_delta_msg(node_info_delta_msg_t ** msg,
+				       Buf buffer, uint16_t protocol_version);
 static int _unpack_node_info_members(node_info_t * node, Buf buffer,
 				     uint16_t protocol_version);
 
@@ -409,6 +413,8 @@ static int _unpack_job_desc_msg(job_desc_msg_t ** job_desc_buffer_ptr,
 				uint16_t protocol_version);
 static int _unpack_job_info_msg(job_info_msg_t ** msg, Buf buffer,
 				uint16_t protocol_version);
+static int _unpack_job_info_delta_msg(job_info_delta_msg_t ** msg, Buf buffer,
+				      uint16_t protocol_version);
 
 static void _pack_last_update_msg(last_update_msg_t * msg, Buf buffer,
 				  uint16_t protocol_version);
@@ -752,12 +758,18 @@ pack_msg(slurm_msg_t const *msg, Buf buffer)
 	case RESPONSE_JOB_INFO:
 		_pack_job_info_msg((slurm_msg_t *) msg, buffer);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		_pack_job_info_delta_msg((slurm_msg_t *) msg, buffer);
+		break;
 	case RESPONSE_PARTITION_INFO:
 		_pack_partition_info_msg((slurm_msg_t *) msg, buffer);
 		break;
 	case RESPONSE_NODE_INFO:
 		_pack_node_info_msg((slurm_msg_t *) msg, buffer);
 		break;
+	case RESPONSE_NODE_INFO_DELTA:
+		_pack_node_info_delta_msg((slurm_msg_t *) msg, buffer);
+		break;
 	case MESSAGE_NODE_REGISTRATION_STATUS:
 		_pack_node_registration_status_msg(
 			(slurm_node_registration_status_msg_t *) msg->data,
@@ -1311,6 +1323,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					  buffer,
 					  msg->protocol_version);
 		break;
+	case RESPONSE_JOB_INFO_DELTA:
+		rc = _unpack_job_info_delta_msg(
+			(job_info_delta_msg_t **) & (msg->data), buffer,
+			msg->protocol_version);
+		break;
 	case RESPONSE_PARTITION_INFO:
 		rc = _unpack_partition_info_msg((partition_info_msg_t **) &
 						(msg->data), buffer,
@@ -1321,6 +1338,11 @@ unpack_msg(slurm_msg_t * msg, Buf buffer)
 					   (msg->data), buffer,
 					   msg->protocol_version);
 		break;
+	case RESPONSE_NODE_INFO_DELTA:
+		rc = _unpack_node_info_delta_msg((node_info_delta_msg_t **) &
+						 (msg->data), buffer,
+						 msg->protocol_version);
+		break;
 	case MESSAGE_NODE_REGISTRATION_STATUS:
 		rc = _unpack_node_registration_status_msg(
 			(slurm_node_registration_status_msg_t **)
@@ -3031,6 +3053,30 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* The delta response is a node information response followed by the total
+ * node count and the node table index of each record in the response */
+static int
+_unpack_node_info_delta_msg(node_info_delta_msg_t ** msg, Buf buffer,
+			    uint16_t protocol_version)
+{
+	xassert(msg != NULL);
+	*msg = xmalloc(sizeof(node_info_delta_msg_t));
+
+	if (_unpack_node_info_msg(&(*msg)->node_info_msg, buffer,
+				  protocol_version))
+		goto unpack_error;
+	safe_unpack32(&(*msg)->node_cnt, buffer);
+	safe_unpack32_array(&(*msg)->node_inx, &(*msg)->node_inx_cnt, buffer);
+	if ((*msg)->node_inx_cnt != (*msg)->node_info_msg->record_count)
+		goto unpack_error;
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_node_info_delta_msg(*msg);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 static int
 _unpack_node_info_members(node_info_t * node, Buf buffer,
 			  uint16_t protocol_version)
@@ -4349,6 +4395,27 @@ unpack_error:
 	return SLURM_ERROR;
 }
 
+/* The delta response is a job information response followed by the IDs of
+ * all jobs which a full response would have contained */
+static int
+_unpack_job_info_delta_msg(job_info_delta_msg_t ** msg, Buf buffer,
+			   uint16_t protocol_version)
+{
+	xassert(msg != NULL);
+	*msg = xmalloc(sizeof(job_info_delta_msg_t));
+
+	if (_unpack_job_info_msg(&(*msg)->job_info_msg, buffer,
+				 protocol_version))
+		goto unpack_error;
+	safe_unpack32_array(&(*msg)->job_ids, &(*msg)->job_id_cnt, buffer);
+	return SLURM_SUCCESS;
+
+unpack_error:
+	slurm_free_job_info_delta_msg(*msg);
+	*msg = NULL;
+	return SLURM_ERROR;
+}
+
 /* _unpack_job_info_members
  * unpacks a set of slurm job info for one job
  * OUT job - pointer to the job info buffer
@@ -4906,6 +4973,7 @@ _pack_slurm_ctl_conf_msg(slurm_ctl_conf_info_msg_t * build_ptr, Buf buffer,
 
 		packstr(build_ptr->slurmd_spooldir, buffer);
 		pack16(build_ptr->slurmd_timeout, buffer);
+		pack16(build_ptr->slurmstepd_pool_size, buffer);
 		packstr(build_ptr->srun_epilog, buffer);
 		packstr(build_ptr->srun_prolog, buffer);
 		packstr(build_ptr->state_save_location, buffer);
@@ -5606,6 +5674,7 @@ _unpack_slurm_ctl_conf_msg(slurm_ctl_conf_info_msg_t **build_buffer_ptr,
 		safe_unpackstr_xmalloc(&build_ptr->slurmd_spooldir,
 				       &uint32_tmp, buffer);
 		safe_unpack16(&build_ptr->slurmd_timeout, buffer);
+		safe_unpack16(&build_ptr->slurmstepd_pool_size, buffer);
 
 		safe_unpackstr_xmalloc(&build_ptr->srun_epilog,
 				       &uint32_tmp, buffer);
@@ -10310,7 +10379,29 @@ static void _pack_slurmd_status(slurmd_status_t *msg, Buf buffer,
 {
 	xassert(msg);
 
-	if (protocol_version >= SLURM_2_5_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_2_6_PROTOCOL_VERSION) {
+		pack_time(msg->booted, buffer);
+		pack_time(msg->last_slurmctld_msg, buffer);
+
+		pack16(msg->slurmd_debug, buffer);
+		pack16(msg->actual_cpus, buffer);
+		pack16(msg->actual_boards, buffer);
+		pack16(msg->actual_sockets, buffer);
+		pack16(msg->actual_cores, buffer);
+		pack16(msg->actual_threads, buffer);
+		pack16(msg->rpc_threads, buffer);
+
+		pack32(msg->actual_real_mem, buffer);
+		pack32(msg->actual_tmp_disk, buffer);
+		pack32(msg->pid, buffer);
+		pack32(msg->rpc_queue_depth, buffer);
+		pack32(msg->rpc_queue_max, buffer);
+
+		packstr(msg->hostname, buffer);
+		packstr(msg->slurmd_logfile, buffer);
+		packstr(msg->step_list, buffer);
+		packstr(msg->version, buffer);
+	} else if (protocol_version >= SLURM_2_5_PROTOCOL_VERSION) {
 		pack_time(msg->booted, buffer);
 		pack_time(msg->last_slurmctld_msg, buffer);
 
@@ -10363,7 +10454,33 @@ static int _unpack_slurmd_status(slurmd_status_t **msg_ptr, Buf buffer,
 
 	msg = xmalloc(sizeof(slurmd_status_t));
 
-	if (protocol_version >= SLURM_2_5_PROTOCOL_VERSION) {
+	if (protocol_version >= SLURM_2_6_PROTOCOL_VERSION) {
+		safe_unpack_time(&msg->booted, buffer);
+		safe_unpack_time(&msg->last_slurmctld_msg, buffer);
+
+		safe_unpack16(&msg->slurmd_debug, buffer);
+		safe_unpack16(&msg->actual_cpus, buffer);
+		safe_unpack16(&msg->actual_boards, buffer);
+		safe_unpack16(&msg->actual_sockets, buffer);
+		safe_unpack16(&msg->actual_cores, buffer);
+		safe_unpack16(&msg->actual_threads, buffer);
+		safe_unpack16(&msg->rpc_threads, buffer);
+
+		safe_unpack32(&msg->actual_real_mem, buffer);
+		safe_unpack32(&msg->actual_tmp_disk, buffer);
+		safe_unpack32(&msg->pid, buffer);
+		safe_unpack32(&msg->rpc_queue_depth, buffer);
+		safe_unpack32(&msg->rpc_queue_max, buffer);
+
+		safe_unpackstr_xmalloc(&msg->hostname,
+					&uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->slurmd_logfile,
+					&uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->step_list,
+					&uint32_tmp, buffer);
+		safe_unpackstr_xmalloc(&msg->version,
+					&uint32_tmp, buffer);
+	} else if (protocol_version >= SLURM_2_5_PROTOCOL_VERSION) {
 		safe_unpack_time(&msg->booted, buffer);
 		safe_unpack_time(&msg->last_slurmctld_msg, buffer);
 
@@ -10839,6 +10956,16 @@ static int  _unpack_stats_response_msg(stats_info_response_msg_t **msg_ptr,
 			safe_unpack32(&msg->bf_depth_try_sum,	buffer);
 			safe_unpack32(&msg->bf_queue_len_sum,	buffer);
 			safe_unpack32(&msg->bf_active,		buffer);
+			if (protocol_version >= SLURM_2_6_PROTOCOL_VERSION) {
+				safe_unpack32(&msg->job_hash_size,  buffer);
+				safe_unpack32(&msg->job_hash_cnt,   buffer);
+				safe_unpack32(&msg->job_hash_max_chain,
+					      buffer);
+				safe_unpack32(&msg->job_hash_resizes,
+					      buffer);
+				safe_unpack32(&msg->bf_resumes,     buffer);
+				safe_unpack32(&msg->bf_restarts,    buffer);
+			}
 		}
 	} else {
 		error("_unpack_stats_response_msg: protocol_version "
@@ -54,6 +54,12 @@ struct switch_record {
 					 * this switch */
 	char *nodes;			/* name if direct descendent nodes */
 	char *switches;			/* name if direct descendent switches */
+	uint16_t num_switches;		/* count of direct descendent switches */
+	uint16_t *switch_index;		/* switch_record_table index of each
+					 * direct descendent switch */
+	bool disjoint;			/* no node descends from more than one
+					 * direct descendent switch, so counts
+					 * over them may be summed */
 };
 
 extern struct switch_record *switch_record_table;  /* ptr to switch records */
@@ -50,10 +50,14 @@
 #endif				/*  HAVE_CONFIG_H */
 
 #include <arpa/inet.h>
+#include <ctype.h>
+#include <dirent.h>
 #include <fcntl.h>
 #include <pthread.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <syslog.h>
+#include <sys/mman.h>
 #include <sys/poll.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -85,8 +89,12 @@ strong_alias(slurmdbd_free_id_rc_msg,	slurmdb_slurmdbd_free_id_rc_msg);
 
 #define DBD_MAGIC		0xDEAD3219
 #define MAX_AGENT_QUEUE		10000
+#define MAX_AGENT_WINDOW	1024	/* Spooled RPCs held in memory */
 #define MAX_DBD_MSG_LEN		16384
 #define SLURMDBD_TIMEOUT	900	/* Seconds SlurmDBD for response */
+#ifndef SPOOL_SEG_SIZE
+#define SPOOL_SEG_SIZE		(4 * 1024 * 1024)
+#endif
 
 uint16_t running_cache = 0;
 pthread_mutex_t assoc_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
@@ -110,8 +118,46 @@ static bool      callbacks_requested = 0;
 static bool      from_ctld           = 0;
 static bool      need_to_register    = 0;
 
+/* Pending RPCs are appended to segment files dbd.spool.<seq> in the
+ * StateSaveLocation as they are queued, using the record format of
+ * dbd.messages, and agent_list only holds a window of them read back in
+ * order.  A position is a segment and a byte offset in it, offset 0
+ * being before the version header that starts each segment.  RPCs the
+ * spool can not take (e.g. the file system is full) are held in mem_list
+ * and follow the spooled ones into agent_list.
+ * Protected by agent_lock. */
+typedef struct {
+	char *dir;
+	uint32_t first_seg;	/* oldest segment file */
+	uint32_t head_seg;	/* end of the last RPC acknowledged */
+	uint32_t head_off;
+	int head_fd;		/* dbd.spool.head, head_seg/off saved */
+	uint32_t read_seg;	/* end of the last RPC read into agent_list */
+	uint32_t read_off;
+	char *read_map;		/* read_seg mapped, read_map_len bytes */
+	uint32_t read_map_len;
+	uint16_t read_ver;	/* rpc_version of read_seg, 0 if unknown */
+	uint32_t recov_seg;	/* end of the RPCs left by an earlier run */
+	uint32_t recov_off;
+	uint32_t write_seg;	/* end of the last RPC spooled */
+	uint32_t write_off;
+	int write_fd;
+	uint32_t rec_cnt;	/* RPCs spooled and not acknowledged */
+	List mem_list;		/* RPCs not spooled, after all spooled ones */
+	/* where each RPC in agent_list ends, oldest at win_first,
+	 * NO_VAL if it is not in the spool */
+	uint32_t win_seg[MAX_AGENT_WINDOW];
+	uint32_t win_off[MAX_AGENT_WINDOW];
+	int win_first;
+} dbd_spool_t;
+
+static dbd_spool_t *spool = NULL;
+
 static void * _agent(void *x);
+static Buf    _agent_dequeue(void);
+static int    _agent_enqueue(Buf buffer);
 static void   _close_slurmdbd_fd(void);
+static Buf    _convert_dbd_rec(Buf buffer, uint16_t rpc_version);
 static void   _create_agent(void);
 static bool   _fd_readable(slurm_fd_t fd, int read_timeout);
 static int    _fd_writeable(slurm_fd_t fd);
@@ -129,6 +175,19 @@ static int    _send_fini_msg(void);
 static int    _send_msg(Buf buffer);
 static void   _sig_handler(int signal);
 static void   _shutdown_agent(void);
+static int    _spool_append(Buf buffer);
+static void   _spool_close(void);
+static void   _spool_fill(void);
+static void   _spool_map(void);
+static int    _spool_new_seg(uint32_t seg);
+static int    _spool_open(void);
+static int    _spool_rec(uint32_t off, uint32_t *msg_size);
+static void   _spool_recount(void);
+static void   _spool_save_head(void);
+static char * _spool_seg_name(uint32_t seg);
+static List   _spool_unsaved(void);
+static uint16_t _spool_ver(Buf buffer);
+static int    _spool_write(Buf buffer);
 static void   _slurmdbd_packstr(void *str, uint16_t rpc_version, Buf buffer);
 static int    _slurmdbd_unpackstr(void **str, uint16_t rpc_version, Buf buffer);
 static int    _tot_wait (struct timeval *start_time);
@@ -386,7 +445,10 @@ extern int slurm_send_slurmdbd_msg(uint16_t rpc_version, slurmdbd_msg_t *req)
 			return SLURM_ERROR;
 		}
 	}
-	cnt = list_count(agent_list);
+	if (spool)
+		cnt = spool->rec_cnt + list_count(spool->mem_list);
+	else
+		cnt = list_count(agent_list);
 	if ((cnt >= (max_agent_queue / 2)) &&
 	    (difftime(time(NULL), syslog_time) > 120)) {
 		/* Record critical error every 120 seconds */
@@ -396,11 +458,27 @@ extern int slurm_send_slurmdbd_msg(uint16_t rpc_version, slurmdbd_msg_t *req)
 		if (callbacks_requested)
 			(callback.dbd_fail)();
 	}
+	/* A spooled queue is only limited by the space on disk, then by
+	 * max_agent_queue for the RPCs held in memory */
+	if (spool) {
+		if (list_count(spool->mem_list) < max_agent_queue) {
+			(void) _agent_enqueue(buffer);
+		} else {
+			error("slurmdbd: agent queue is full, "
+			      "discarding request");
+			free_buf(buffer);
+			if (callbacks_requested)
+				(callback.acct_full)();
+			rc = SLURM_ERROR;
+		}
+		pthread_cond_broadcast(&agent_cond);
+		slurm_mutex_unlock(&agent_lock);
+		return rc;
+	}
 	if (cnt == (max_agent_queue - 1))
 		cnt -= _purge_job_start_req();
 	if (cnt < max_agent_queue) {
-		if (list_enqueue(agent_list, buffer) == NULL)
-			fatal("list_enqueue: memory allocation failure");
+		(void) _agent_enqueue(buffer);
 	} else {
 		error("slurmdbd: agent queue is full, discarding request");
 		if (callbacks_requested)
@@ -1712,7 +1790,7 @@ static int _handle_mult_rc_ret(uint16_t rpc_version, int read_timeout)
 				    != SLURM_SUCCESS)
 					break;
 
-				if ((b = list_dequeue(agent_list))) {
+				if ((b = _agent_dequeue())) {
 					free_buf(b);
 				} else {
 					error("slurmdbd: DBD_GOT_MULT_MSG "
@@ -1947,6 +2025,9 @@ static void _create_agent(void)
 
 	if (agent_list == NULL) {
 		agent_list = list_create(slurmdbd_free_buffer);
+		if (_spool_open() != SLURM_SUCCESS)
+			error("slurmdbd: unable to open spool, queueing "
+			      "pending RPCs in memory");
 		_load_dbd_state();
 	}
 
@@ -2037,6 +2118,8 @@ static void *_agent(void *x)
 		}
 
 		slurm_mutex_lock(&agent_lock);
+		if (spool)
+			_spool_fill();
 		if (agent_list && slurmdbd_fd)
 			cnt = list_count(agent_list);
 		else
@@ -2131,7 +2214,7 @@ static void *_agent(void *x)
 					list_destroy(list_msg.my_list);
 				list_msg.my_list = NULL;
 			} else
-				buffer = (Buf) list_dequeue(agent_list);
+				buffer = _agent_dequeue();
 
 			free_buf(buffer);
 			fail_time = 0;
@@ -2148,6 +2231,8 @@ static void *_agent(void *x)
 
 			fail_time = time(NULL);
 		}
+		if (spool)
+			_spool_save_head();
 		slurm_mutex_unlock(&agent_lock);
 		/* END_TIMER; */
 		/* info("at the end with %s", TIME_STR); */
@@ -2179,6 +2264,19 @@ static void _save_dbd_state(void)
 	int fd, rc, wrote = 0;
 	uint16_t msg_type;
 	uint32_t offset;
+	List save_list = agent_list;
+
+	if (spool) {
+		/* Only what the spool could not take is left to save */
+		verbose("slurmdbd: left %u pending RPCs in spool",
+			spool->rec_cnt);
+		save_list = _spool_unsaved();
+		_spool_close();
+		if (list_count(save_list) == 0) {
+			list_destroy(save_list);
+			return;
+		}
+	}
 
 	dbd_fname = slurm_get_state_save_location();
 	xstrcat(dbd_fname, "/dbd.messages");
@@ -2186,7 +2284,7 @@ static void _save_dbd_state(void)
 	fd = open(dbd_fname, O_WRONLY | O_CREAT | O_TRUNC, 0600);
 	if (fd < 0) {
 		error("slurmdbd: Creating state save file %s", dbd_fname);
-	} else if (agent_list && list_count(agent_list)) {
+	} else if (save_list && list_count(save_list)) {
 		char curr_ver_str[10];
 		snprintf(curr_ver_str, sizeof(curr_ver_str),
 			 "VER%d", SLURMDBD_VERSION);
@@ -2197,7 +2295,7 @@ static void _save_dbd_state(void)
 		if (rc != SLURM_SUCCESS)
 			goto end_it;
 
-		while ((buffer = list_dequeue(agent_list))) {
+		while ((buffer = list_dequeue(save_list))) {
 			/* We do not want to store registration
 			   messages.  If an admin puts in an incorrect
 			   cluster name we can get a deadlock unless
@@ -2230,6 +2328,8 @@ end_it:
 		verbose("slurmdbd: saved %d pending RPCs", wrote);
 		(void) close(fd);
 	}
+	if (save_list != agent_list)
+		list_destroy(save_list);
 	xfree(dbd_fname);
 }
 
@@ -2286,58 +2386,57 @@ static void _load_dbd_state(void)
 				buffer = _load_dbd_rec(fd);
 			if (buffer == NULL)
 				break;
-			if (rpc_version != SLURMDBD_VERSION) {
-				slurmdbd_msg_t msg;
-				int rc;
-				set_buf_offset(buffer, 0);
-				if (rpc_version == 0) {
-					/* This should only happen for
-					   pre 2.2.0.rc4 and 2.1
-					   machines so no real need to
-					   keep it add more to it.
-					*/
-					rc = unpack_slurmdbd_msg(
-						&msg, SLURMDBD_VERSION, buffer);
-					if ((rc == SLURM_SUCCESS)
-					    && !remaining_buf(buffer))
-						goto got_it;
-
-					/* If the current version
-					   failed lets try the last
-					   version.
-					*/
-					set_buf_offset(buffer, 0);
-					rc = unpack_slurmdbd_msg(
-						&msg, SLURMDBD_VERSION_MIN,
-						buffer);
-				} else
-					rc = unpack_slurmdbd_msg(
-						&msg, rpc_version, buffer);
-			got_it:
-				free_buf(buffer);
-				if (rc == SLURM_SUCCESS)
-					buffer = pack_slurmdbd_msg(
-						&msg, SLURMDBD_VERSION);
-				else
-					buffer = NULL;
-			}
+			if (rpc_version != SLURMDBD_VERSION)
+				buffer = _convert_dbd_rec(buffer, rpc_version);
 			if (!buffer) {
 				error("no buffer given");
 				continue;
 			}
-			if (!list_enqueue(agent_list, buffer))
-				fatal("slurmdbd: list_enqueue, no memory");
-			recovered++;
+			if (_agent_enqueue(buffer) == SLURM_SUCCESS)
+				recovered++;
 			buffer = NULL;
 		}
 
 	end_it:
 		verbose("slurmdbd: recovered %d pending RPCs", recovered);
 		(void) close(fd);
+		/* The spool has them now */
+		if (spool)
+			(void) unlink(dbd_fname);
 	}
 	xfree(dbd_fname);
 }
 
+/* Repack a saved RPC of an older rpc_version, 0 if not known, and free
+ * buffer.  RET the RPC packed in SLURMDBD_VERSION or NULL on error */
+static Buf _convert_dbd_rec(Buf buffer, uint16_t rpc_version)
+{
+	slurmdbd_msg_t msg;
+	int rc;
+
+	set_buf_offset(buffer, 0);
+	if (rpc_version == 0) {
+		/* This should only happen for pre 2.2.0.rc4 and 2.1
+		   machines so no real need to keep it add more to it.
+		*/
+		rc = unpack_slurmdbd_msg(&msg, SLURMDBD_VERSION, buffer);
+		if ((rc == SLURM_SUCCESS) && !remaining_buf(buffer))
+			goto got_it;
+
+		/* If the current version failed lets try the last
+		   version.
+		*/
+		set_buf_offset(buffer, 0);
+		rc = unpack_slurmdbd_msg(&msg, SLURMDBD_VERSION_MIN, buffer);
+	} else
+		rc = unpack_slurmdbd_msg(&msg, rpc_version, buffer);
+got_it:
+	free_buf(buffer);
+	if (rc == SLURM_SUCCESS)
+		return pack_slurmdbd_msg(&msg, SLURMDBD_VERSION);
+	return NULL;
+}
+
 static int _save_dbd_rec(int fd, Buf buffer)
 {
 	ssize_t size, wrote;
@@ -2459,6 +2558,525 @@ static int _purge_job_start_req(void)
 	return purged;
 }
 
+/* Queue an RPC for the agent, taking over buffer.  With a spool the RPC
+ * is written there, and only kept in agent_list as well if the agent
+ * has nothing older left to read back from the spool.  If the spool can
+ * not take it, or holds none of the RPCs after it, the RPC is held in
+ * spool->mem_list instead.
+ * RET SLURM_SUCCESS or error code */
+static int _agent_enqueue(Buf buffer)
+{
+	bool caught_up;
+	int inx;
+
+	if (!spool) {
+		if (list_enqueue(agent_list, buffer) == NULL)
+			fatal("list_enqueue: memory allocation failure");
+		return SLURM_SUCCESS;
+	}
+
+	/* Keep order behind any RPCs the spool did not take */
+	if (list_count(spool->mem_list)) {
+		if (list_enqueue(spool->mem_list, buffer) == NULL)
+			fatal("list_enqueue: memory allocation failure");
+		return SLURM_SUCCESS;
+	}
+
+	caught_up = ((spool->read_seg == spool->write_seg) &&
+		     (spool->read_off == spool->write_off));
+	if (_spool_append(buffer) != SLURM_SUCCESS) {
+		error("slurmdbd: unable to spool request, queueing "
+		      "pending RPCs in memory");
+		if (list_enqueue(spool->mem_list, buffer) == NULL)
+			fatal("list_enqueue: memory allocation failure");
+		return SLURM_SUCCESS;
+	}
+	if (!caught_up || (list_count(agent_list) >= MAX_AGENT_WINDOW)) {
+		free_buf(buffer);
+		return SLURM_SUCCESS;
+	}
+
+	if (spool->read_seg != spool->write_seg) {
+		/* _spool_append() started a new segment */
+		if (spool->read_map)
+			(void) munmap(spool->read_map, spool->read_map_len);
+		spool->read_map = NULL;
+		spool->read_map_len = 0;
+	}
+	/* Nothing older is left to read, so what follows is ours */
+	spool->read_ver = SLURMDBD_VERSION;
+	spool->read_seg = spool->write_seg;
+	spool->read_off = spool->write_off;
+	inx = (spool->win_first + list_count(agent_list)) % MAX_AGENT_WINDOW;
+	spool->win_seg[inx] = spool->read_seg;
+	spool->win_off[inx] = spool->read_off;
+	if (list_enqueue(agent_list, buffer) == NULL)
+		fatal("list_enqueue: memory allocation failure");
+	return SLURM_SUCCESS;
+}
+
+/* Remove the oldest RPC from agent_list after the SlurmDBD has taken
+ * it, removing any spool segments it has finished */
+static Buf _agent_dequeue(void)
+{
+	Buf buffer = (Buf) list_dequeue(agent_list);
+	char *fname;
+
+	if (!buffer || !spool)
+		return buffer;
+
+	if (spool->win_seg[spool->win_first] != NO_VAL) {
+		spool->head_seg = spool->win_seg[spool->win_first];
+		spool->head_off = spool->win_off[spool->win_first];
+		spool->rec_cnt--;
+	}
+	spool->win_first = (spool->win_first + 1) % MAX_AGENT_WINDOW;
+	if (spool->first_seg < spool->head_seg) {
+		/* Save the head first, so a restart never starts from
+		 * a segment already removed */
+		_spool_save_head();
+		while (spool->first_seg < spool->head_seg) {
+			fname = _spool_seg_name(spool->first_seg++);
+			(void) unlink(fname);
+			xfree(fname);
+		}
+	}
+	return buffer;
+}
+
+/* Take the pending RPCs which are not in the spool, oldest first, out of
+ * agent_list and spool->mem_list
+ * RET list of them, to be destroyed by the caller */
+static List _spool_unsaved(void)
+{
+	List unsaved = list_create(slurmdbd_free_buffer);
+	Buf buffer;
+
+	while ((buffer = list_dequeue(agent_list))) {
+		if (spool->win_seg[spool->win_first] == NO_VAL)
+			list_enqueue(unsaved, buffer);
+		else
+			free_buf(buffer);
+		spool->win_first = (spool->win_first + 1) % MAX_AGENT_WINDOW;
+	}
+	while ((buffer = list_dequeue(spool->mem_list)))
+		list_enqueue(unsaved, buffer);
+	return unsaved;
+}
+
+static char *_spool_seg_name(uint32_t seg)
+{
+	return xstrdup_printf("%s/dbd.spool.%u", spool->dir, seg);
+}
+
+/* Create an empty segment to append to.  Its version header is
+ * written by _spool_append() with the first RPC. */
+static int _spool_new_seg(uint32_t seg)
+{
+	char *fname = _spool_seg_name(seg);
+
+	if (spool->write_fd >= 0)
+		(void) close(spool->write_fd);
+	spool->write_fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND,
+			       0600);
+	if (spool->write_fd < 0) {
+		error("slurmdbd: Creating spool file %s: %m", fname);
+		xfree(fname);
+		return SLURM_ERROR;
+	}
+	fd_set_close_on_exec(spool->write_fd);
+	xfree(fname);
+	spool->write_seg = seg;
+	spool->write_off = 0;
+	return SLURM_SUCCESS;
+}
+
+/* Append one record to the segment being written, cutting off any part
+ * of it written before an error */
+static int _spool_write(Buf buffer)
+{
+	if (_save_dbd_rec(spool->write_fd, buffer) != SLURM_SUCCESS) {
+		if (ftruncate(spool->write_fd, spool->write_off))
+			error("slurmdbd: spool truncate error: %m");
+		return SLURM_ERROR;
+	}
+	spool->write_off += get_buf_offset(buffer) + 2 * sizeof(uint32_t);
+	return SLURM_SUCCESS;
+}
+
+/* Append an RPC to the spool, starting a new segment once the current
+ * one is full.  RET SLURM_SUCCESS or error code */
+static int _spool_append(Buf buffer)
+{
+	char ver_str[10];
+	Buf hdr;
+	int rc;
+
+	if ((spool->write_fd < 0) || (spool->write_off >= SPOOL_SEG_SIZE)) {
+		if (_spool_new_seg(spool->write_seg + 1) != SLURM_SUCCESS)
+			return SLURM_ERROR;
+	}
+	if (spool->write_off == 0) {
+		snprintf(ver_str, sizeof(ver_str), "VER%d", SLURMDBD_VERSION);
+		hdr = init_buf(strlen(ver_str));
+		packstr(ver_str, hdr);
+		rc = _spool_write(hdr);
+		free_buf(hdr);
+		if (rc != SLURM_SUCCESS)
+			return rc;
+	}
+	if (_spool_write(buffer) != SLURM_SUCCESS)
+		return SLURM_ERROR;
+
+	spool->rec_cnt++;
+	return SLURM_SUCCESS;
+}
+
+/* Map read_seg as far as it has been written */
+static void _spool_map(void)
+{
+	char *fname;
+	struct stat stat_buf;
+	int fd;
+
+	if (spool->read_map)
+		(void) munmap(spool->read_map, spool->read_map_len);
+	spool->read_map = NULL;
+	spool->read_map_len = 0;
+
+	fname = _spool_seg_name(spool->read_seg);
+	fd = open(fname, O_RDONLY);
+	if (fd < 0) {
+		error("slurmdbd: Opening spool file %s: %m", fname);
+	} else {
+		if ((fstat(fd, &stat_buf) == 0) && (stat_buf.st_size > 0)) {
+			spool->read_map = mmap(NULL, stat_buf.st_size,
+					       PROT_READ, MAP_SHARED, fd, 0);
+			if (spool->read_map == MAP_FAILED) {
+				error("slurmdbd: Mapping spool file %s: %m",
+				      fname);
+				spool->read_map = NULL;
+			} else
+				spool->read_map_len = stat_buf.st_size;
+		}
+		(void) close(fd);
+	}
+	xfree(fname);
+}
+
+/* Check for a whole record at off in the mapped segment
+ * RET SLURM_SUCCESS or SLURM_ERROR if none */
+static int _spool_rec(uint32_t off, uint32_t *msg_size)
+{
+	uint32_t magic;
+
+	if (((uint64_t) off + 2 * sizeof(uint32_t)) > spool->read_map_len)
+		return SLURM_ERROR;
+	memcpy(msg_size, spool->read_map + off, sizeof(uint32_t));
+	if (((uint64_t) off + *msg_size + 2 * sizeof(uint32_t)) >
+	    spool->read_map_len)
+		return SLURM_ERROR;
+	memcpy(&magic, spool->read_map + off + sizeof(uint32_t) + *msg_size,
+	       sizeof(uint32_t));
+	if (magic != DBD_MAGIC)
+		return SLURM_ERROR;
+	return SLURM_SUCCESS;
+}
+
+/* RET the rpc_version named by a segment's version header, 0 if not
+ * known */
+static uint16_t _spool_ver(Buf buffer)
+{
+	char curr_ver_str[10];
+	char *ver_str = NULL;
+	uint32_t ver_str_len;
+	uint16_t rpc_version = 0;
+
+	set_buf_offset(buffer, 0);
+	if ((unpackstr_xmalloc(&ver_str, &ver_str_len, buffer)
+	     == SLURM_SUCCESS) && ver_str) {
+		snprintf(curr_ver_str, sizeof(curr_ver_str),
+			 "VER%d", SLURMDBD_VERSION);
+		if (!strcmp(ver_str, curr_ver_str))
+			rpc_version = SLURMDBD_VERSION;
+	}
+	xfree(ver_str);
+	return rpc_version;
+}
+
+/* Read spooled RPCs back into agent_list, up to MAX_AGENT_WINDOW, then
+ * those held in spool->mem_list */
+static void _spool_fill(void)
+{
+	uint32_t msg_size, off;
+	uint16_t msg_type;
+	Buf buffer;
+	bool corrupt;
+	int inx;
+
+	while (list_count(agent_list) < MAX_AGENT_WINDOW) {
+		if ((spool->read_seg == spool->write_seg) &&
+		    (spool->read_off >= spool->write_off)) {
+			if (!(buffer = list_dequeue(spool->mem_list)))
+				break;
+			inx = (spool->win_first + list_count(agent_list)) %
+			      MAX_AGENT_WINDOW;
+			spool->win_seg[inx] = NO_VAL;
+			spool->win_off[inx] = 0;
+			if (list_enqueue(agent_list, buffer) == NULL)
+				fatal("list_enqueue: memory allocation "
+				      "failure");
+			continue;
+		}
+
+		off = spool->read_off;
+		if (_spool_rec(off, &msg_size) != SLURM_SUCCESS) {
+			/* The segment may have grown since it was mapped */
+			_spool_map();
+			if (_spool_rec(off, &msg_size) != SLURM_SUCCESS) {
+				if (spool->read_seg == spool->write_seg) {
+					error("slurmdbd: spool corrupted at "
+					      "%u.%u", spool->read_seg, off);
+					spool->read_off = spool->write_off;
+					_spool_recount();
+					continue;
+				}
+				corrupt = (off < spool->read_map_len);
+				if (corrupt)
+					error("slurmdbd: spool corrupted at "
+					      "%u.%u", spool->read_seg, off);
+				(void) munmap(spool->read_map,
+					      spool->read_map_len);
+				spool->read_map = NULL;
+				spool->read_map_len = 0;
+				spool->read_seg++;
+				spool->read_off = 0;
+				if (corrupt)
+					_spool_recount();
+				continue;
+			}
+		}
+
+		buffer = init_buf(msg_size);
+		memcpy(get_buf_data(buffer),
+		       spool->read_map + off + sizeof(uint32_t), msg_size);
+		set_buf_offset(buffer, msg_size);
+		spool->read_off += msg_size + 2 * sizeof(uint32_t);
+
+		if (off == 0) {
+			spool->read_ver = _spool_ver(buffer);
+			free_buf(buffer);
+			continue;
+		}
+		/* As with dbd.messages, registrations are not resent
+		   after a restart.  If an admin puts in an incorrect
+		   cluster name we can get a deadlock unless they add
+		   the bogus cluster name to the accounting system. */
+		if ((spool->read_seg < spool->recov_seg) ||
+		    ((spool->read_seg == spool->recov_seg) &&
+		     (spool->read_off <= spool->recov_off))) {
+			set_buf_offset(buffer, 0);
+			unpack16(&msg_type, buffer);
+			set_buf_offset(buffer, msg_size);
+			if (msg_type == DBD_REGISTER_CTLD) {
+				free_buf(buffer);
+				spool->rec_cnt--;
+				continue;
+			}
+		}
+		if ((spool->read_ver != SLURMDBD_VERSION) &&
+		    !(buffer = _convert_dbd_rec(buffer, spool->read_ver))) {
+			error("slurmdbd: unable to convert spooled RPC");
+			spool->rec_cnt--;
+			continue;
+		}
+
+		inx = (spool->win_first + list_count(agent_list)) %
+		      MAX_AGENT_WINDOW;
+		spool->win_seg[inx] = spool->read_seg;
+		spool->win_off[inx] = spool->read_off;
+		if (list_enqueue(agent_list, buffer) == NULL)
+			fatal("list_enqueue: memory allocation failure");
+	}
+}
+
+/* Count the RPCs still spooled after part of the spool was skipped as
+ * corrupted: those in agent_list and the whole records not yet read */
+static void _spool_recount(void)
+{
+	uint32_t msg_size, off, seg, save_seg = spool->read_seg;
+	int i, cnt = list_count(agent_list);
+
+	spool->rec_cnt = 0;
+	for (i = 0; i < cnt; i++) {
+		if (spool->win_seg[(spool->win_first + i) % MAX_AGENT_WINDOW]
+		    != NO_VAL)
+			spool->rec_cnt++;
+	}
+	for (seg = save_seg; seg <= spool->write_seg; seg++) {
+		spool->read_seg = seg;
+		_spool_map();
+		off = (seg == save_seg) ? spool->read_off : 0;
+		while (((seg != spool->write_seg) ||
+			(off < spool->write_off)) &&
+		       (_spool_rec(off, &msg_size) == SLURM_SUCCESS)) {
+			if (off)
+				spool->rec_cnt++;
+			off += msg_size + 2 * sizeof(uint32_t);
+		}
+	}
+	spool->read_seg = save_seg;
+	_spool_map();
+}
+
+/* Record how far the SlurmDBD has taken the spool, so a restart only
+ * resends what it had not acknowledged */
+static void _spool_save_head(void)
+{
+	uint32_t head[3];
+
+	head[0] = spool->head_seg;
+	head[1] = spool->head_off;
+	head[2] = DBD_MAGIC;
+	if (pwrite(spool->head_fd, head, sizeof(head), 0) != sizeof(head))
+		error("slurmdbd: Saving spool head: %m");
+}
+
+/* Open the spool in the StateSaveLocation, picking up any RPCs an
+ * earlier run left in it.  RET SLURM_SUCCESS or error code */
+static int _spool_open(void)
+{
+	DIR *dir;
+	struct dirent *ent;
+	char *fname, *end;
+	uint32_t seg, last_seg = 0, off, msg_size, head[3];
+	bool found = false;
+	Buf buffer;
+
+	spool = xmalloc(sizeof(dbd_spool_t));
+	spool->dir = slurm_get_state_save_location();
+	spool->mem_list = list_create(slurmdbd_free_buffer);
+	spool->head_fd = -1;
+	spool->write_fd = -1;
+
+	if (!(dir = opendir(spool->dir))) {
+		error("slurmdbd: Opening %s: %m", spool->dir);
+		goto fail;
+	}
+	while ((ent = readdir(dir))) {
+		if (strncmp(ent->d_name, "dbd.spool.", 10) ||
+		    !isdigit((int) ent->d_name[10]))
+			continue;
+		seg = strtoul(ent->d_name + 10, &end, 10);
+		if (end[0] != '\0')
+			continue;
+		if (!found || (seg < spool->first_seg))
+			spool->first_seg = seg;
+		if (!found || (seg > last_seg))
+			last_seg = seg;
+		found = true;
+	}
+	closedir(dir);
+
+	fname = xstrdup_printf("%s/dbd.spool.head", spool->dir);
+	spool->head_fd = open(fname, O_RDWR | O_CREAT, 0600);
+	if (spool->head_fd < 0) {
+		error("slurmdbd: Opening spool file %s: %m", fname);
+		xfree(fname);
+		goto fail;
+	}
+	fd_set_close_on_exec(spool->head_fd);
+	xfree(fname);
+
+	spool->head_seg = spool->first_seg;
+	if (found &&
+	    (read(spool->head_fd, head, sizeof(head)) == sizeof(head)) &&
+	    (head[2] == DBD_MAGIC) &&
+	    (head[0] >= spool->first_seg) && (head[0] <= last_seg)) {
+		spool->head_seg = head[0];
+		spool->head_off = head[1];
+	}
+	while (spool->first_seg < spool->head_seg) {
+		fname = _spool_seg_name(spool->first_seg++);
+		(void) unlink(fname);
+		xfree(fname);
+	}
+
+	/* Count what is left, cutting off a record the last run was
+	 * part way through writing */
+	for (seg = spool->head_seg; found && (seg <= last_seg); seg++) {
+		spool->read_seg = seg;
+		_spool_map();
+		off = 0;
+		if (seg == spool->head_seg) {
+			if (spool->head_off > spool->read_map_len)
+				spool->head_off = 0;
+			off = spool->head_off;
+		}
+		if ((seg == spool->head_seg) &&
+		    (_spool_rec(0, &msg_size) == SLURM_SUCCESS)) {
+			buffer = create_buf(spool->read_map + sizeof(uint32_t),
+					    msg_size);
+			spool->read_ver = _spool_ver(buffer);
+			xfer_buf_data(buffer);
+		}
+		while (_spool_rec(off, &msg_size) == SLURM_SUCCESS) {
+			if (off)
+				spool->rec_cnt++;
+			off += msg_size + 2 * sizeof(uint32_t);
+		}
+		if (seg == last_seg) {
+			spool->write_seg = seg;
+			spool->write_off = off;
+		}
+	}
+	if (spool->read_map)
+		(void) munmap(spool->read_map, spool->read_map_len);
+	spool->read_map = NULL;
+	spool->read_map_len = 0;
+
+	if (found) {
+		fname = _spool_seg_name(spool->write_seg);
+		spool->write_fd = open(fname, O_WRONLY | O_APPEND);
+		if ((spool->write_fd < 0) ||
+		    ftruncate(spool->write_fd, spool->write_off)) {
+			error("slurmdbd: Opening spool file %s: %m", fname);
+			xfree(fname);
+			goto fail;
+		}
+		fd_set_close_on_exec(spool->write_fd);
+		xfree(fname);
+	} else if (_spool_new_seg(spool->head_seg) != SLURM_SUCCESS)
+		goto fail;
+
+	spool->read_seg = spool->head_seg;
+	spool->read_off = spool->head_off;
+	spool->recov_seg = spool->write_seg;
+	spool->recov_off = spool->write_off;
+	verbose("slurmdbd: recovered %u pending RPCs from spool",
+		spool->rec_cnt);
+	return SLURM_SUCCESS;
+
+fail:
+	_spool_close();
+	return SLURM_ERROR;
+}
+
+static void _spool_close(void)
+{
+	if (spool->head_fd >= 0) {
+		_spool_save_head();
+		(void) close(spool->head_fd);
+	}
+	if (spool->write_fd >= 0)
+		(void) close(spool->write_fd);
+	if (spool->read_map)
+		(void) munmap(spool->read_map, spool->read_map_len);
+	FREE_NULL_LIST(spool->mem_list);
+	xfree(spool->dir);
+	xfree(spool);
+}
+
 /****************************************************************************\
  * Free data structures
 \****************************************************************************/
@@ -477,6 +477,7 @@ extern int destroy_mysql_conn(mysql_conn_t *mysql_conn)
 {
 	if (mysql_conn) {
 		mysql_db_close_db_connection(mysql_conn);
+		xfree(mysql_conn->batch_query);
 		xfree(mysql_conn->pre_commit_query);
 		xfree(mysql_conn->cluster_name);
 		slurm_mutex_destroy(&mysql_conn->lock);
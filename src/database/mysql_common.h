@@ -70,6 +70,12 @@ typedef enum {
 } slurm_mysql_plugin_type_t;
 
 typedef struct {
+	bool batch;		/* queue statements in batch_query */
+	bool batch_insert;	/* batch_query ends in an open insert */
+	char *batch_query;
+	int batch_rc;		/* first error writing the batch */
+	unsigned long batch_thread; /* connection running the batch
+				     * transaction, 0 if none */
 	bool cluster_deleted;
 	char *cluster_name;
 	MYSQL *db_conn;
@@ -2721,6 +2721,14 @@ extern int jobacct_storage_p_step_complete(mysql_conn_t *mysql_conn,
 	return as_mysql_step_complete(mysql_conn, step_ptr);
 }
 
+/*
+ * start or end a batch of step starts and completions
+ */
+extern int jobacct_storage_p_batch(mysql_conn_t *mysql_conn, bool batch)
+{
+	return as_mysql_batch(mysql_conn, batch);
+}
+
 /*
  * load into the storage a suspention of a job
  */
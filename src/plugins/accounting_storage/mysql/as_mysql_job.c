@@ -48,6 +48,21 @@
 
 #define BUFFER_SIZE 4096
 
+/* Send a batch early once its query reaches this size, well under the
+ * 1MB default of max_allowed_packet */
+#define MAX_BATCH_QUERY 0x80000
+
+static char *step_start_cols = "job_db_inx, id_step, time_start, "
+	"step_name, state, cpus_alloc, nodes_alloc, task_cnt, nodelist, "
+	"node_inx, task_dist";
+
+/* Taking the values from the new row lets one insert carry many steps */
+static char *step_start_dup = "on duplicate key update "
+	"cpus_alloc=VALUES(cpus_alloc), nodes_alloc=VALUES(nodes_alloc), "
+	"task_cnt=VALUES(task_cnt), time_end=0, state=VALUES(state), "
+	"nodelist=VALUES(nodelist), node_inx=VALUES(node_inx), "
+	"task_dist=VALUES(task_dist)";
+
 /* Used in job functions for getting the database index based off the
  * submit time, job and assoc id.  0 is returned if none is found
  */
@@ -210,8 +225,118 @@ no_wckeyid:
 	return wckeyid;
 }
 
+/* Finish the multi-row step insert at the end of batch_query, if any */
+static void _batch_end_insert(mysql_conn_t *mysql_conn)
+{
+	if (!mysql_conn->batch_insert)
+		return;
+	xstrfmtcat(mysql_conn->batch_query, " %s;", step_start_dup);
+	mysql_conn->batch_insert = false;
+}
+
+/* Send the statements queued so far, opening the batch transaction
+ * first unless the connection is already inside one.  Once a write
+ * fails the rest of the batch is dropped, as it will be rolled back. */
+static int _batch_write(mysql_conn_t *mysql_conn)
+{
+	int rc = SLURM_SUCCESS;
+
+	_batch_end_insert(mysql_conn);
+	if (mysql_conn->batch_rc != SLURM_SUCCESS) {
+		xfree(mysql_conn->batch_query);
+		return mysql_conn->batch_rc;
+	}
+	if (!mysql_conn->batch_query)
+		return rc;
+
+	if (!mysql_conn->rollback && !mysql_conn->batch_thread) {
+		rc = mysql_db_query(mysql_conn, "start transaction");
+		if (rc == SLURM_SUCCESS)
+			mysql_conn->batch_thread =
+				mysql_thread_id(mysql_conn->db_conn);
+	}
+	if (rc == SLURM_SUCCESS) {
+		debug3("%d(%s:%d) query\n%s", mysql_conn->conn, THIS_FILE,
+		       __LINE__, mysql_conn->batch_query);
+		rc = mysql_db_query_check_after(mysql_conn,
+						mysql_conn->batch_query);
+	}
+	xfree(mysql_conn->batch_query);
+	mysql_conn->batch_rc = rc;
+
+	return rc;
+}
+
+static int _batch_check_size(mysql_conn_t *mysql_conn)
+{
+	if (strlen(mysql_conn->batch_query) < MAX_BATCH_QUERY)
+		return SLURM_SUCCESS;
+	return _batch_write(mysql_conn);
+}
+
+/* Add a step row to the insert at the end of batch_query */
+static int _batch_step_start(mysql_conn_t *mysql_conn, char *vals)
+{
+	if (mysql_conn->batch_insert)
+		xstrfmtcat(mysql_conn->batch_query, ", %s", vals);
+	else {
+		xstrfmtcat(mysql_conn->batch_query,
+			   "insert into \"%s_%s\" (%s) values %s",
+			   mysql_conn->cluster_name, step_table,
+			   step_start_cols, vals);
+		mysql_conn->batch_insert = true;
+	}
+
+	return _batch_check_size(mysql_conn);
+}
+
+/* Queue a statement behind the ones already in batch_query, so
+ * records are still written in the order they came in */
+static int _batch_query(mysql_conn_t *mysql_conn, char *query)
+{
+	_batch_end_insert(mysql_conn);
+	xstrfmtcat(mysql_conn->batch_query, "%s;", query);
+
+	return _batch_check_size(mysql_conn);
+}
+
 /* extern functions */
 
+/* Start queueing step starts and completions on mysql_conn, or write
+ * the queued ones out in one transaction and stop */
+extern int as_mysql_batch(mysql_conn_t *mysql_conn, bool batch)
+{
+	int rc;
+
+	if (batch) {
+		mysql_conn->batch = true;
+		return SLURM_SUCCESS;
+	}
+	if (!mysql_conn->batch)
+		return SLURM_SUCCESS;
+
+	rc = _batch_write(mysql_conn);
+	if (mysql_conn->batch_thread) {
+		if (rc == SLURM_SUCCESS)
+			rc = mysql_db_commit(mysql_conn);
+		else if (mysql_db_rollback(mysql_conn))
+			error("rollback failed");
+		/* A reconnect during a batch written in pieces loses the
+		 * pieces sent before it, even if the commit works */
+		if ((rc == SLURM_SUCCESS) &&
+		    (mysql_thread_id(mysql_conn->db_conn) !=
+		     mysql_conn->batch_thread)) {
+			error("lost the database connection during a batch");
+			rc = ESLURM_DB_CONNECTION;
+		}
+	}
+	mysql_conn->batch = false;
+	mysql_conn->batch_rc = SLURM_SUCCESS;
+	mysql_conn->batch_thread = 0;
+
+	return rc;
+}
+
 extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			      struct job_record *job_ptr)
 {
@@ -807,7 +932,7 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 	char node_list[BUFFER_SIZE];
 	char *node_inx = NULL, *step_name = NULL;
 	time_t start_time, submit_time;
-	char *query = NULL;
+	char *query = NULL, *vals = NULL;
 
 	if (!step_ptr->job_ptr->db_index
 	    && ((!step_ptr->job_ptr->details
@@ -918,31 +1043,29 @@ extern int as_mysql_step_start(mysql_conn_t *mysql_conn,
 
 	step_name = slurm_add_slash_to_quotes(step_ptr->name);
 
-	/* we want to print a -1 for the requid so leave it a
-	   %d */
 	/* The stepid could be -2 so use %d not %u */
-	query = xstrdup_printf(
-		"insert into \"%s_%s\" (job_db_inx, id_step, time_start, "
-		"step_name, state, "
-		"cpus_alloc, nodes_alloc, task_cnt, nodelist, "
-		"node_inx, task_dist) "
-		"values (%d, %d, %d, '%s', %d, %d, %d, %d, "
-		"'%s', '%s', %d) "
-		"on duplicate key update cpus_alloc=%d, nodes_alloc=%d, "
-		"task_cnt=%d, time_end=0, state=%d, "
-		"nodelist='%s', node_inx='%s', task_dist=%d",
-		mysql_conn->cluster_name, step_table,
+	vals = xstrdup_printf(
+		"(%d, %d, %d, '%s', %d, %d, %d, %d, '%s', '%s', %d)",
 		step_ptr->job_ptr->db_index,
 		step_ptr->step_id,
 		(int)start_time, step_name,
-		JOB_RUNNING, cpus, nodes, tasks, node_list, node_inx, task_dist,
-		cpus, nodes, tasks, JOB_RUNNING,
-		node_list, node_inx, task_dist);
+		JOB_RUNNING, cpus, nodes, tasks, node_list, node_inx, task_dist);
+	xfree(step_name);
+
+	if (mysql_conn->batch) {
+		rc = _batch_step_start(mysql_conn, vals);
+		xfree(vals);
+		return rc;
+	}
+
+	query = xstrdup_printf("insert into \"%s_%s\" (%s) values %s %s",
+			       mysql_conn->cluster_name, step_table,
+			       step_start_cols, vals, step_start_dup);
 	debug3("%d(%s:%d) query\n%s",
 	       mysql_conn->conn, THIS_FILE, __LINE__, query);
 	rc = mysql_db_query(mysql_conn, query);
 	xfree(query);
-	xfree(step_name);
+	xfree(vals);
 
 	return rc;
 }
@@ -1093,9 +1216,13 @@ extern int as_mysql_step_complete(mysql_conn_t *mysql_conn,
 		jobacct->act_cpufreq,
 		jobacct->energy.consumed_energy,
 		step_ptr->job_ptr->db_index, step_ptr->step_id);
-	debug3("%d(%s:%d) query\n%s",
-	       mysql_conn->conn, THIS_FILE, __LINE__, query);
-	rc = mysql_db_query(mysql_conn, query);
+	if (mysql_conn->batch) {
+		rc = _batch_query(mysql_conn, query);
+	} else {
+		debug3("%d(%s:%d) query\n%s",
+		       mysql_conn->conn, THIS_FILE, __LINE__, query);
+		rc = mysql_db_query(mysql_conn, query);
+	}
 	xfree(query);
 
 	return rc;
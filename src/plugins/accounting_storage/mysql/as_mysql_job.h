@@ -42,6 +42,8 @@
 
 #include "accounting_storage_mysql.h"
 
+extern int as_mysql_batch(mysql_conn_t *mysql_conn, bool batch);
+
 extern int as_mysql_job_start(mysql_conn_t *mysql_conn,
 			   struct job_record *job_ptr);
 
@@ -678,6 +678,14 @@ extern int jobacct_storage_p_step_complete(pgsql_conn_t *pg_conn,
 	return js_pg_step_complete(pg_conn, step_ptr);
 }
 
+/*
+ * start or end a batch of step starts and completions
+ */
+extern int jobacct_storage_p_batch(pgsql_conn_t *pg_conn, bool batch)
+{
+	return SLURM_SUCCESS;
+}
+
 /*
  * load into the storage a suspention of a job
  */
@@ -2308,6 +2308,14 @@ extern int jobacct_storage_p_step_complete(void *db_conn,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * start or end a batch of step starts and completions
+ */
+extern int jobacct_storage_p_batch(void *db_conn, bool batch)
+{
+	return SLURM_SUCCESS;
+}
+
 /*
  * load into the storage a suspention of a job
  */
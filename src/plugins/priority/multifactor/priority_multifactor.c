@@ -59,6 +59,7 @@
 #include <sys/stat.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 #include <math.h>
 #include "slurm/slurm_errno.h"
@@ -75,6 +76,16 @@
 
 #define MIN_USAGE_FACTOR 0.01
 
+/* Jobs recalculated by the decay thread before it releases the job write
+ * lock, and how long it then waits for other threads to get the lock */
+#define DECAY_BATCH_SIZE	1000
+#define DECAY_YIELD_USEC	1000
+
+/* Associations per thread when a level of the association tree is large
+ * enough to split, and the most threads to split it among */
+#define FS_THREAD_ASSOCS	2048
+#define FS_MAX_THREADS		8
+
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined.  They will get
  * overwritten when linking with the slurmctld.
@@ -84,11 +95,13 @@ void *acct_db_conn  __attribute__((weak_import)) = NULL;
 uint32_t cluster_cpus __attribute__((weak_import)) = NO_VAL;
 List job_list  __attribute__((weak_import)) = NULL;
 time_t last_job_update __attribute__((weak_import));
+time_t last_part_update __attribute__((weak_import));
 #else
 void *acct_db_conn = NULL;
 uint32_t cluster_cpus = NO_VAL;
 List job_list = NULL;
 time_t last_job_update;
+time_t last_part_update;
 #endif
 
 /*
@@ -138,6 +151,7 @@ static uint32_t weight_js;   /* weight for Job Size factor */
 static uint32_t weight_part; /* weight for Partition factor */
 static uint32_t weight_qos;  /* weight for QOS factor */
 static uint32_t flags;       /* Priority Flags */
+static unsigned fs_seqno = 1; /* generation of cached fairshare factors */
 static uint32_t max_tickets; /* Maximum number of tickets given to a
 			      * user. Protected by assoc_mgr lock. */
 
@@ -398,34 +412,127 @@ static void _set_usage_efctv(slurmdb_association_rec_t *assoc)
 }
 
 
-/* This should initially get the childern list from
- * assoc_mgr_root_assoc.  Since our algorythm goes from top down we
- * calculate all the non-user associations now.  When a user submits a
- * job, that norm_fairshare is calculated.  Here we will set the
- * usage_efctv to NO_VAL for users to not have to calculate a bunch
- * of things that will never be used.
+typedef struct {
+	slurmdb_association_rec_t **assocs;
+	int begin;
+	int end;
+	pthread_t thread;
+} fs_range_t;
+
+/* Set the effective usage and fairshare factor of a range of associations
+ * on one level of the tree. */
+static void *_set_range_usage_efctv(void *arg)
+{
+	fs_range_t *range = (fs_range_t *)arg;
+	slurmdb_association_rec_t *assoc;
+	int i;
+
+	for (i = range->begin; i < range->end; i++) {
+		assoc = range->assocs[i];
+		priority_p_set_assoc_usage(assoc);
+		assoc->usage->fs_factor = priority_p_calc_fs_factor(
+			assoc->usage->usage_efctv,
+			(long double)assoc->usage->shares_norm);
+		assoc->usage->fs_seqno = fs_seqno;
+	}
+	return NULL;
+}
+
+/* Split a level of the association tree among threads if it is large */
+static void _set_level_usage_efctv(slurmdb_association_rec_t **assocs,
+				   int assoc_cnt)
+{
+	fs_range_t range[FS_MAX_THREADS];
+	pthread_attr_t attr;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	int i, thread_cnt, per_thread;
+
+	thread_cnt = assoc_cnt / FS_THREAD_ASSOCS;
+	if (thread_cnt > cpus)
+		thread_cnt = cpus;
+	if (thread_cnt > FS_MAX_THREADS)
+		thread_cnt = FS_MAX_THREADS;
+	/* Keep the debug log in tree order */
+	if ((thread_cnt < 2) || priority_debug) {
+		range[0].assocs = assocs;
+		range[0].begin = 0;
+		range[0].end = assoc_cnt;
+		_set_range_usage_efctv(&range[0]);
+		return;
+	}
+
+	per_thread = (assoc_cnt + thread_cnt - 1) / thread_cnt;
+	for (i = 0; i < thread_cnt; i++) {
+		range[i].assocs = assocs;
+		range[i].begin = i * per_thread;
+		range[i].end = MIN((i + 1) * per_thread, assoc_cnt);
+	}
+	/* The calling thread does the first range itself */
+	for (i = 1; i < thread_cnt; i++) {
+		slurm_attr_init(&attr);
+		if (pthread_create(&range[i].thread, &attr,
+				   _set_range_usage_efctv, &range[i])) {
+			error("pthread_create error %m");
+			range[i].thread = 0;
+			_set_range_usage_efctv(&range[i]);
+		}
+		slurm_attr_destroy(&attr);
+	}
+	_set_range_usage_efctv(&range[0]);
+	for (i = 1; i < thread_cnt; i++) {
+		if (range[i].thread)
+			pthread_join(range[i].thread, NULL);
+	}
+}
+
+/*
+ * Set the effective usage and fairshare factor of every association, so
+ * a job's fairshare priority is a cached read of its association's
+ * fs_factor.  An association's effective usage depends on its parent's,
+ * so the tree is done a level at a time from assoc_mgr_root_assoc down,
+ * each level split among threads if it is large.  fs_seqno is the
+ * generation of the cached values; associations added later have an
+ * older fs_seqno and are computed when first used.
  *
  * NOTE: acct_mgr_association_lock must be locked before this is called.
  */
-static int _set_children_usage_efctv(List childern_list)
+static void _set_tree_usage_efctv(void)
 {
-	slurmdb_association_rec_t *assoc = NULL;
-	ListIterator itr = NULL;
+	slurmdb_association_rec_t **level = NULL, **next = NULL, **tmp;
+	slurmdb_association_rec_t *assoc;
+	ListIterator itr;
+	int level_cnt = 0, next_cnt, alloc_cnt, i;
 
-	if (!childern_list || !list_count(childern_list))
-		return SLURM_SUCCESS;
+	if (++fs_seqno == 0)
+		fs_seqno = 1;
+	assoc_mgr_root_assoc->usage->fs_seqno = fs_seqno;
 
-	itr = list_iterator_create(childern_list);
-	while ((assoc = list_next(itr))) {
-		if (assoc->user) {
-			assoc->usage->usage_efctv = (long double)NO_VAL;
-			continue;
+	alloc_cnt = list_count(assoc_mgr_association_list) + 1;
+	level = xmalloc(sizeof(slurmdb_association_rec_t *) * alloc_cnt);
+	next  = xmalloc(sizeof(slurmdb_association_rec_t *) * alloc_cnt);
+	level[level_cnt++] = assoc_mgr_root_assoc;
+
+	while (level_cnt) {
+		next_cnt = 0;
+		for (i = 0; i < level_cnt; i++) {
+			if (!level[i]->usage->childern_list)
+				continue;
+			itr = list_iterator_create(
+				level[i]->usage->childern_list);
+			while ((assoc = list_next(itr)) &&
+			       (next_cnt < alloc_cnt))
+				next[next_cnt++] = assoc;
+			list_iterator_destroy(itr);
 		}
-		priority_p_set_assoc_usage(assoc);
-		_set_children_usage_efctv(assoc->usage->childern_list);
+		if (next_cnt)
+			_set_level_usage_efctv(next, next_cnt);
+		tmp = level;
+		level = next;
+		next = tmp;
+		level_cnt = next_cnt;
 	}
-	list_iterator_destroy(itr);
-	return SLURM_SUCCESS;
+	xfree(level);
+	xfree(next);
 }
 
 
@@ -447,11 +554,15 @@ static int _distribute_tickets(List childern_list, uint32_t tickets)
 		if (assoc->usage->active_seqno
 		    != assoc_mgr_root_assoc->usage->active_seqno)
 			continue;
-		if (fuzzy_equal(assoc->usage->usage_efctv, NO_VAL))
-			priority_p_set_assoc_usage(assoc);
-		fs = priority_p_calc_fs_factor(assoc->usage->usage_efctv,
-					       assoc->usage->shares_norm);
-		sfsum += assoc->usage->shares_norm * fs;
+		if (assoc->usage->fs_seqno != fs_seqno) {
+			if (fuzzy_equal(assoc->usage->usage_efctv, NO_VAL))
+				priority_p_set_assoc_usage(assoc);
+			assoc->usage->fs_factor = priority_p_calc_fs_factor(
+				assoc->usage->usage_efctv,
+				assoc->usage->shares_norm);
+			assoc->usage->fs_seqno = fs_seqno;
+		}
+		sfsum += assoc->usage->shares_norm * assoc->usage->fs_factor;
 	}
 	list_iterator_destroy(itr);
 
@@ -460,8 +571,7 @@ static int _distribute_tickets(List childern_list, uint32_t tickets)
 		if (assoc->usage->active_seqno
 		    != assoc_mgr_root_assoc->usage->active_seqno)
 			continue;
-		fs = priority_p_calc_fs_factor(assoc->usage->usage_efctv,
-					       assoc->usage->shares_norm);
+		fs = assoc->usage->fs_factor;
 		assoc->usage->tickets = tickets * assoc->usage->shares_norm
 			* fs / sfsum;
 		if (priority_debug) {
@@ -534,9 +644,15 @@ static double _get_fairshare_priority( struct job_record *job_ptr)
 			     priority_fs);
 		}
 	} else {
-		priority_fs = priority_p_calc_fs_factor(
+		/* Set for every association by _set_tree_usage_efctv()
+		 * unless it was added since */
+		if (fs_assoc->usage->fs_seqno != fs_seqno) {
+			fs_assoc->usage->fs_factor = priority_p_calc_fs_factor(
 				fs_assoc->usage->usage_efctv,
 				(long double)fs_assoc->usage->shares_norm);
+			fs_assoc->usage->fs_seqno = fs_seqno;
+		}
+		priority_fs = fs_assoc->usage->fs_factor;
 		if (priority_debug) {
 			info("Fairshare priority of job %u for user %s in acct"
 			     " %s is 2**(-%Lf/%f) = %f",
@@ -550,6 +666,30 @@ static double _get_fairshare_priority( struct job_record *job_ptr)
 	return priority_fs;
 }
 
+static double _get_age_priority(time_t start_time, struct job_record *job_ptr)
+{
+	uint32_t diff = 0;
+	time_t use_time;
+
+	if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
+		use_time = job_ptr->details->submit_time;
+	else
+		use_time = job_ptr->details->begin_time;
+
+	/* Only really add an age priority if the use_time is
+	   past the start_time.
+	*/
+	if (start_time > use_time)
+		diff = start_time - use_time;
+
+	if (!job_ptr->details->begin_time &&
+	    !(flags & PRIORITY_FLAGS_ACCRUE_ALWAYS))
+		return 0.0;
+	if (diff < max_age)
+		return (double)diff / (double)max_age;
+	return 1.0;
+}
+
 static void _get_priority_factors(time_t start_time, struct job_record *job_ptr)
 {
 	slurmdb_qos_rec_t *qos_ptr = NULL;
@@ -566,33 +706,8 @@ static void _get_priority_factors(time_t start_time, struct job_record *job_ptr)
 	qos_ptr = (slurmdb_qos_rec_t *)job_ptr->qos_ptr;
 
 	if (weight_age) {
-		uint32_t diff = 0;
-		time_t use_time;
-
-		if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS)
-			use_time = job_ptr->details->submit_time;
-		else
-			use_time = job_ptr->details->begin_time;
-
-		/* Only really add an age priority if the use_time is
-		   past the start_time.
-		*/
-		if (start_time > use_time)
-			diff = start_time - use_time;
-
-		if (job_ptr->details->begin_time) {
-			if (diff < max_age) {
-				job_ptr->prio_factors->priority_age =
-					(double)diff / (double)max_age;
-			} else
-				job_ptr->prio_factors->priority_age = 1.0;
-		} else if (flags & PRIORITY_FLAGS_ACCRUE_ALWAYS) {
-			if (diff < max_age) {
-				job_ptr->prio_factors->priority_age =
-					(double)diff / (double)max_age;
-			} else
-				job_ptr->prio_factors->priority_age = 1.0;
-		}
+		job_ptr->prio_factors->priority_age =
+			_get_age_priority(start_time, job_ptr);
 	}
 
 	if (job_ptr->assoc_ptr && weight_fs) {
@@ -654,32 +769,12 @@ static void _get_priority_factors(time_t start_time, struct job_record *job_ptr)
 	job_ptr->prio_factors->nice = job_ptr->details->nice;
 }
 
-static uint32_t _get_priority_internal(time_t start_time,
-				       struct job_record *job_ptr)
+/* Add up the weighted factors in job_ptr->prio_factors.
+ * pre_factors, if set, are the unweighted factors to log. */
+static uint32_t _sum_priority(struct job_record *job_ptr,
+			      priority_factors_object_t *pre_factors)
 {
-	double priority		= 0.0;
-	priority_factors_object_t pre_factors;
-
-	if (job_ptr->direct_set_prio && (job_ptr->priority > 0))
-		return job_ptr->priority;
-
-	if (!job_ptr->details) {
-		error("_get_priority_internal: job %u does not have a "
-		      "details symbol set, can't set priority",
-		      job_ptr->job_id);
-		return 0;
-	}
-
-	/* figure out the priority */
-	_get_priority_factors(start_time, job_ptr);
-	memcpy(&pre_factors, job_ptr->prio_factors,
-	       sizeof(priority_factors_object_t));
-
-	job_ptr->prio_factors->priority_age  *= (double)weight_age;
-	job_ptr->prio_factors->priority_fs   *= (double)weight_fs;
-	job_ptr->prio_factors->priority_js   *= (double)weight_js;
-	job_ptr->prio_factors->priority_part *= (double)weight_part;
-	job_ptr->prio_factors->priority_qos  *= (double)weight_qos;
+	double priority;
 
 	priority = job_ptr->prio_factors->priority_age
 		+ job_ptr->prio_factors->priority_fs
@@ -721,22 +816,24 @@ static uint32_t _get_priority_internal(time_t start_time,
 	if (priority < 1)
 		priority = 1;
 
-	if (priority_debug) {
+	if (priority_debug && pre_factors) {
 		info("Weighted Age priority is %f * %u = %.2f",
-		     pre_factors.priority_age, weight_age,
+		     pre_factors->priority_age, weight_age,
 		     job_ptr->prio_factors->priority_age);
 		info("Weighted Fairshare priority is %f * %u = %.2f",
-		     pre_factors.priority_fs, weight_fs,
+		     pre_factors->priority_fs, weight_fs,
 		     job_ptr->prio_factors->priority_fs);
 		info("Weighted JobSize priority is %f * %u = %.2f",
-		     pre_factors.priority_js, weight_js,
+		     pre_factors->priority_js, weight_js,
 		     job_ptr->prio_factors->priority_js);
 		info("Weighted Partition priority is %f * %u = %.2f",
-		     pre_factors.priority_part, weight_part,
+		     pre_factors->priority_part, weight_part,
 		     job_ptr->prio_factors->priority_part);
 		info("Weighted QOS priority is %f * %u = %.2f",
-		     pre_factors.priority_qos, weight_qos,
+		     pre_factors->priority_qos, weight_qos,
 		     job_ptr->prio_factors->priority_qos);
+	}
+	if (priority_debug) {
 		info("Job %u priority: %.2f + %.2f + %.2f + %.2f + %.2f - %d "
 		     "= %.2f",
 		     job_ptr->job_id, job_ptr->prio_factors->priority_age,
@@ -750,6 +847,71 @@ static uint32_t _get_priority_internal(time_t start_time,
 	return (uint32_t)priority;
 }
 
+static uint32_t _get_priority_internal(time_t start_time,
+				       struct job_record *job_ptr)
+{
+	priority_factors_object_t pre_factors;
+
+	if (job_ptr->direct_set_prio && (job_ptr->priority > 0))
+		return job_ptr->priority;
+
+	if (!job_ptr->details) {
+		error("_get_priority_internal: job %u does not have a "
+		      "details symbol set, can't set priority",
+		      job_ptr->job_id);
+		return 0;
+	}
+
+	/* figure out the priority */
+	_get_priority_factors(start_time, job_ptr);
+	memcpy(&pre_factors, job_ptr->prio_factors,
+	       sizeof(priority_factors_object_t));
+
+	job_ptr->prio_factors->priority_age  *= (double)weight_age;
+	job_ptr->prio_factors->priority_fs   *= (double)weight_fs;
+	job_ptr->prio_factors->priority_js   *= (double)weight_js;
+	job_ptr->prio_factors->priority_part *= (double)weight_part;
+	job_ptr->prio_factors->priority_qos  *= (double)weight_qos;
+
+	return _sum_priority(job_ptr, &pre_factors);
+}
+
+/*
+ * Recalculate the priority of a pending job from the weighted factors
+ * cached in job_ptr->prio_factors by _get_priority_internal(). Only the
+ * age, fairshare and QOS factors are computed again; the job size,
+ * partition and nice inputs change only through job updates, which call
+ * _get_priority_internal(), or a reconfiguration.
+ */
+static uint32_t _update_priority_internal(time_t start_time,
+					  struct job_record *job_ptr)
+{
+	priority_factors_object_t *factors = job_ptr->prio_factors;
+	slurmdb_qos_rec_t *qos_ptr = (slurmdb_qos_rec_t *)job_ptr->qos_ptr;
+
+	if (job_ptr->direct_set_prio && (job_ptr->priority > 0))
+		return job_ptr->priority;
+
+	if (!job_ptr->details || !factors)
+		return _get_priority_internal(start_time, job_ptr);
+
+	if (weight_age) {
+		factors->priority_age = _get_age_priority(start_time, job_ptr)
+					* (double)weight_age;
+	}
+	if (job_ptr->assoc_ptr && weight_fs) {
+		factors->priority_fs = _get_fairshare_priority(job_ptr)
+				       * (double)weight_fs;
+	} else
+		factors->priority_fs = 0.0;
+	if (qos_ptr && qos_ptr->priority && weight_qos) {
+		factors->priority_qos = qos_ptr->usage->norm_priority
+					* (double)weight_qos;
+	} else
+		factors->priority_qos = 0.0;
+
+	return _sum_priority(job_ptr, NULL);
+}
 
 /* Mark an association and its parents as active (i.e. it may be given
  * tickets) during the current scheduling cycle.  The association
@@ -1161,8 +1323,7 @@ static void *_decay_ticket_thread(void *no_data)
 
 		/* now calculate all the normalized usage here */
 		assoc_mgr_lock(&locks);
-		_set_children_usage_efctv(
-			assoc_mgr_root_assoc->usage->childern_list);
+		_set_tree_usage_efctv();
 		assoc_mgr_unlock(&locks);
 
 		if (!last_ran)
@@ -1253,6 +1414,7 @@ static void *_decay_ticket_thread(void *no_data)
 			job_ptr->priority =
 				_get_priority_internal(start_time, job_ptr);
 			last_job_update = time(NULL);
+			job_ptr->last_update = last_job_update;
 			debug2("priority for job %u is now %u",
 			       job_ptr->job_id, job_ptr->priority);
 		}
@@ -1290,7 +1452,16 @@ static void *_decay_usage_thread(void *no_data)
 	double decay_hl = (double)slurm_get_priority_decay_hl();
 	double decay_factor = 1;
 	uint16_t reset_period = slurm_get_priority_reset_period();
-
+	uint32_t *job_ids = NULL;
+	int i, batch_end, job_cnt;
+	bool full_calc = true;
+	time_t calc_part_update = 0;
+	uint32_t calc_cluster_cpus = 0;
+	int calc_node_cnt = 0;
+
+	/* Read lock on jobs */
+	slurmctld_lock_t job_read_lock =
+		{ NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
 	/* Write lock on jobs, read lock on nodes and partitions */
 	slurmctld_lock_t job_write_lock =
 		{ NO_LOCK, WRITE_LOCK, READ_LOCK, READ_LOCK };
@@ -1366,6 +1537,8 @@ static void *_decay_usage_thread(void *no_data)
 			else
 				decay_factor = 1;
 
+			/* priority weights may have changed */
+			full_calc = true;
 			reconfig = 0;
 		}
 
@@ -1399,8 +1572,7 @@ static void *_decay_usage_thread(void *no_data)
 
 		/* now calculate all the normalized usage here */
 		assoc_mgr_lock(&locks);
-		_set_children_usage_efctv(
-			assoc_mgr_root_assoc->usage->childern_list);
+		_set_tree_usage_efctv();
 		assoc_mgr_unlock(&locks);
 
 		if (!last_ran)
@@ -1425,33 +1597,90 @@ static void *_decay_usage_thread(void *no_data)
 			slurm_mutex_unlock(&decay_lock);
 			break;
 		}
-		lock_slurmctld(job_write_lock);
+		/*
+		 * Recalculate every factor only if the weights, partitions
+		 * or cluster size may have changed since the last pass.
+		 * Otherwise only the age, fairshare and QOS factors.
+		 */
+		if (full_calc || (last_part_update != calc_part_update) ||
+		    (cluster_cpus != calc_cluster_cpus) ||
+		    (node_record_count != calc_node_cnt)) {
+			full_calc = true;
+			calc_part_update = last_part_update;
+			calc_cluster_cpus = cluster_cpus;
+			calc_node_cnt = node_record_count;
+		}
+
+		/*
+		 * Work through the jobs in batches, releasing the job write
+		 * lock between them so job RPCs are not blocked for the
+		 * whole pass.  Jobs purged meanwhile are not found again.
+		 */
+		lock_slurmctld(job_read_lock);
+		job_cnt = list_count(job_list);
+		job_ids = xmalloc(sizeof(uint32_t) * (job_cnt + 1));
+		job_cnt = 0;
 		itr = list_iterator_create(job_list);
-		while ((job_ptr = list_next(itr))) {
-			/* apply new usage */
-			if (!IS_JOB_PENDING(job_ptr) &&
-			    job_ptr->start_time && job_ptr->assoc_ptr) {
-				if (!_apply_new_usage(job_ptr, decay_factor,
-						      last_ran, start_time))
+		while ((job_ptr = list_next(itr)))
+			job_ids[job_cnt++] = job_ptr->job_id;
+		list_iterator_destroy(itr);
+		unlock_slurmctld(job_read_lock);
+
+		for (i = 0; i < job_cnt; ) {
+			bool updated = false;
+
+			lock_slurmctld(job_write_lock);
+			for (batch_end = MIN(i + DECAY_BATCH_SIZE, job_cnt);
+			     i < batch_end; i++) {
+				uint32_t new_prio;
+
+				if (!(job_ptr = find_job_record(job_ids[i])))
 					continue;
-			}
 
-			/*
-			 * Priority 0 is reserved for held jobs. Also skip
-			 * priority calculation for non-pending jobs.
-			 */
-			if ((job_ptr->priority == 0)
-			    || !IS_JOB_PENDING(job_ptr))
-				continue;
+				/* apply new usage */
+				if (!IS_JOB_PENDING(job_ptr) &&
+				    job_ptr->start_time &&
+				    job_ptr->assoc_ptr) {
+					if (!_apply_new_usage(job_ptr,
+							      decay_factor,
+							      last_ran,
+							      start_time))
+						continue;
+				}
 
-			job_ptr->priority =
-				_get_priority_internal(start_time, job_ptr);
-			last_job_update = time(NULL);
-			debug2("priority for job %u is now %u",
-			       job_ptr->job_id, job_ptr->priority);
+				/*
+				 * Priority 0 is reserved for held jobs. Also
+				 * skip priority calculation for non-pending
+				 * jobs.
+				 */
+				if ((job_ptr->priority == 0)
+				    || !IS_JOB_PENDING(job_ptr))
+					continue;
+
+				if (full_calc) {
+					new_prio = _get_priority_internal(
+						start_time, job_ptr);
+				} else {
+					new_prio = _update_priority_internal(
+						start_time, job_ptr);
+				}
+				if (new_prio == job_ptr->priority)
+					continue;
+				job_ptr->priority = new_prio;
+				updated = true;
+				job_ptr->last_update = time(NULL);
+				debug2("priority for job %u is now %u",
+				       job_ptr->job_id, job_ptr->priority);
+			}
+			if (updated)
+				last_job_update = time(NULL);
+			unlock_slurmctld(job_write_lock);
+
+			if (i < job_cnt)
+				usleep(DECAY_YIELD_USEC);
 		}
-		list_iterator_destroy(itr);
-		unlock_slurmctld(job_write_lock);
+		xfree(job_ids);
+		full_calc = false;
 
 	get_usage:
 		last_ran = start_time;
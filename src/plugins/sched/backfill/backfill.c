@@ -103,13 +103,51 @@
 
 #define SLURMCTLD_THREAD_LIMIT	5
 
+/* _yield_locks() return values */
+#define BF_YIELD_UNCHANGED	0
+#define BF_YIELD_RESUME		1
+#define BF_YIELD_END		2
+
+/* Nodes available to pending jobs during one slice of time. Records are
+ * kept in an array ordered by time, each record's end_time being the next
+ * record's begin_time, so the slice covering any time can be found with a
+ * binary search. Splitting a record shares its bitmap between the two new
+ * records, which is copied only once either of them is modified. */
 typedef struct node_space_map {
 	time_t begin_time;
 	time_t end_time;
 	bitstr_t *avail_bitmap;
-	int next;	/* next record, by time, zero termination */
+	int *avail_refs;	/* count of records sharing avail_bitmap */
 } node_space_map_t;
 
+/* State of one backfill cycle, shared by the threads evaluating its job
+ * queues when bf_parallel is configured */
+typedef struct bf_cycle {
+	bool filter_root;
+	time_t sched_start;
+	uint32_t *uid;		/* users and their job counts, used with */
+	uint16_t *njobs;	/* bf_max_job_user */
+	uint32_t nuser;
+
+	/* Remaining fields are used only by parallel cycles */
+	bool parallel;
+	pthread_mutex_t mutex;
+	pthread_cond_t cond;
+	int readers;		/* threads holding the lock shared */
+	bool writer;		/* a thread holds the lock exclusively */
+	int writers_waiting;
+	int active;		/* worker threads still running */
+	int paused;		/* worker threads waiting to yield locks */
+	uint32_t yield_gen;	/* count of slurmctld lock yields */
+	int yield_rc;		/* _yield_locks() result of last yield */
+} bf_cycle_t;
+
+typedef struct bf_queue {
+	bf_cycle_t *cycle;
+	List job_queue;
+	pthread_t thread;
+} bf_queue_t;
+
 /* Diag statistics */
 extern diag_stats_t slurmctld_diag_stats;
 int bf_last_yields = 0;
@@ -127,6 +165,7 @@ static int backfill_window = BACKFILL_WINDOW;
 static int max_backfill_job_cnt = 50;
 static int max_backfill_job_per_user = 0;
 static bool backfill_continue = false;
+static int backfill_threads = 1;
 
 /*********************** local functions *********************/
 static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
@@ -134,30 +173,56 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     node_space_map_t *node_space,
 			     int *node_space_recs);
 static int  _attempt_backfill(void);
+static void _bf_lock(bf_cycle_t *cycle, bool exclusive);
+static int  _bf_part_group(int *group, int inx);
+static int  _bf_part_inx(struct part_record **part_array, int part_cnt,
+			 struct part_record *part_ptr);
+static void _bf_part_join(int *group, int inx1, int inx2);
+static bool _bf_part_valid(struct part_record *part_ptr);
+static void *_bf_queue_agent(void *args);
+static void _bf_queue_rec_del(void *x);
+static int  _bf_run_parallel(bf_cycle_t *cycle, List *queues, int queue_cnt,
+			     int yield_sleep);
+static int  _bf_run_queue(bf_cycle_t *cycle, List job_queue);
+static int  _bf_split_queue(List job_queue, int max_queues, List **queues);
+static void _bf_unlock(bf_cycle_t *cycle, bool exclusive);
+static int  _bf_yield(bf_cycle_t *cycle, int yield_sleep);
 static bool _job_is_completing(void);
 static void _load_config(void);
 static bool _many_pending_rpcs(void);
 static bool _more_work(time_t last_backfill_time);
 static void _my_sleep(int secs);
+static void _node_space_and(node_space_map_t *node_space_ptr,
+			    bitstr_t *res_bitmap);
+static int  _node_space_find(node_space_map_t *node_space,
+			     int node_space_recs, time_t when);
+static void _node_space_free(node_space_map_t *node_space,
+			     int node_space_recs);
+static void _node_space_revalidate(node_space_map_t *node_space,
+				   int node_space_recs, bitstr_t *avail_bitmap);
+static void _node_space_split(node_space_map_t *node_space,
+			      int *node_space_recs, int inx, time_t when);
 static int  _num_feature_count(struct job_record *job_ptr);
 static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
-				  node_space_map_t *node_space);
+				  node_space_map_t *node_space,
+				  int node_space_recs);
 static int  _start_job(struct job_record *job_ptr, bitstr_t *avail_bitmap);
 static bool _test_resv_overlap(node_space_map_t *node_space,
-			       bitstr_t *use_bitmap, uint32_t start_time,
-			       uint32_t end_reserve);
+			       int node_space_recs, bitstr_t *use_bitmap,
+			       uint32_t start_time, uint32_t end_reserve);
 static int  _try_sched(struct job_record *job_ptr, bitstr_t **avail_bitmap,
 		       uint32_t min_nodes, uint32_t max_nodes,
 		       uint32_t req_nodes, bitstr_t *exc_core_bitmap);
 
 /* Log resource allocate table */
-static void _dump_node_space_table(node_space_map_t *node_space_ptr)
+static void _dump_node_space_table(node_space_map_t *node_space_ptr,
+				   int node_space_recs)
 {
-	int i = 0;
+	int i;
 	char begin_buf[32], end_buf[32], *node_list;
 
 	info("=========================================");
-	while (1) {
+	for (i = 0; i < node_space_recs; i++) {
 		slurm_make_time_str(&node_space_ptr[i].begin_time,
 				    begin_buf, sizeof(begin_buf));
 		slurm_make_time_str(&node_space_ptr[i].end_time,
@@ -166,12 +231,104 @@ static void _dump_node_space_table(node_space_map_t *node_space_ptr)
 		info("Begin:%s End:%s Nodes:%s",
 		     begin_buf, end_buf, node_list);
 		xfree(node_list);
-		if ((i = node_space_ptr[i].next) == 0)
-			break;
 	}
 	info("=========================================");
 }
 
+/* Return the index of the first node_space record ending after the given
+ *	time, node_space_recs if none */
+static int _node_space_find(node_space_map_t *node_space,
+			    int node_space_recs, time_t when)
+{
+	int lo = 0, hi = node_space_recs, mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (node_space[mid].end_time > when)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+	return lo;
+}
+
+/* Split node_space record inx into two records at the given time. The new
+ *	records share the original record's bitmap. */
+static void _node_space_split(node_space_map_t *node_space,
+			      int *node_space_recs, int inx, time_t when)
+{
+	memmove(&node_space[inx + 1], &node_space[inx],
+		sizeof(node_space_map_t) * (*node_space_recs - inx));
+	(*node_space_recs)++;
+	node_space[inx].end_time = when;
+	node_space[inx + 1].begin_time = when;
+	(*node_space[inx].avail_refs)++;
+}
+
+/* Remove nodes not in res_bitmap from a node_space record, first making a
+ *	private copy of its bitmap if shared with other records */
+static void _node_space_and(node_space_map_t *node_space_ptr,
+			    bitstr_t *res_bitmap)
+{
+	if (*node_space_ptr->avail_refs > 1) {
+		(*node_space_ptr->avail_refs)--;
+		node_space_ptr->avail_bitmap =
+			bit_copy(node_space_ptr->avail_bitmap);
+		node_space_ptr->avail_refs = xmalloc(sizeof(int));
+		*node_space_ptr->avail_refs = 1;
+	}
+	bit_and(node_space_ptr->avail_bitmap, res_bitmap);
+}
+
+static void _node_space_free(node_space_map_t *node_space,
+			     int node_space_recs)
+{
+	int i;
+
+	for (i = 0; i < node_space_recs; i++) {
+		if (--(*node_space[i].avail_refs) == 0) {
+			FREE_NULL_BITMAP(node_space[i].avail_bitmap);
+			xfree(node_space[i].avail_refs);
+		}
+	}
+	xfree(node_space);
+}
+
+/* Bring a node_space map up to date after node availability changed while
+ *	the slurmctld locks were yielded. Nodes no longer available are
+ *	removed from every record. Newly available nodes can not be part of
+ *	any reservation, so they are added to every record.
+ * IN/OUT avail_bitmap - node availability the map was built with, updated */
+static void _node_space_revalidate(node_space_map_t *node_space,
+				   int node_space_recs, bitstr_t *avail_bitmap)
+{
+	bitstr_t *lost_bitmap, *gained_bitmap;
+	bool lost, gained;
+	int i;
+
+	lost_bitmap = bit_copy(avail_node_bitmap);
+	bit_not(lost_bitmap);
+	bit_and(lost_bitmap, avail_bitmap);
+	lost = (bit_ffs(lost_bitmap) != -1);
+	gained_bitmap = bit_copy(avail_bitmap);
+	bit_not(gained_bitmap);
+	bit_and(gained_bitmap, avail_node_bitmap);
+	gained = (bit_ffs(gained_bitmap) != -1);
+
+	/* Shared bitmaps are updated once per record sharing them, which
+	 * is harmless as both operations are idempotent */
+	for (i = 0; (lost || gained) && (i < node_space_recs); i++) {
+		if (lost)
+			bit_and(node_space[i].avail_bitmap, avail_node_bitmap);
+		if (gained)
+			bit_or(node_space[i].avail_bitmap, gained_bitmap);
+	}
+	if (lost || gained)
+		bit_copybits(avail_bitmap, avail_node_bitmap);
+	FREE_NULL_BITMAP(lost_bitmap);
+	FREE_NULL_BITMAP(gained_bitmap);
+}
+
 /*
  * _job_is_completing - Determine if jobs are in the process of completing.
  *	This is a variant of job_is_completing in slurmctld/job_scheduler.c.
@@ -414,6 +571,26 @@ static void _load_config(void)
 		backfill_continue = true;
 	}
 
+	/* bf_parallel evaluates partitions without common nodes on up to
+	 * this many threads. Their will-run tests may then run concurrently,
+	 * which only select/cons_res supports. */
+	backfill_threads = 1;
+	if (sched_params && (tmp_ptr=strstr(sched_params, "bf_parallel=")))
+		backfill_threads = atoi(tmp_ptr + 12);
+	if (backfill_threads < 1) {
+		fatal("Invalid backfill scheduler bf_parallel: %d",
+		      backfill_threads);
+	}
+	if (backfill_threads > 1) {
+		char *select_type = slurm_get_select_type();
+		if (strcmp(select_type, "select/cons_res")) {
+			info("backfill: bf_parallel requires "
+			     "SelectType=select/cons_res, ignored");
+			backfill_threads = 1;
+		}
+		xfree(select_type);
+	}
+
 	xfree(sched_params);
 }
 
@@ -486,8 +663,13 @@ extern void *backfill_agent(void *args)
 	return NULL;
 }
 
-/* Return non-zero to break the backfill loop if change in job, node or
- * partition state or the backfill scheduler needs to be stopped. */
+/* Release the slurmctld locks for a while to let other operations proceed
+ * RET BF_YIELD_UNCHANGED if nothing changed meanwhile,
+ *     BF_YIELD_RESUME if job or node state changed, so that job records and
+ *	node availability (and with bf_continue, partitions) must be
+ *	revalidated before continuing,
+ *     BF_YIELD_END if partitions or configuration changed (unless
+ *	bf_continue is configured) or the backfill scheduler is stopping */
 static int _yield_locks(int secs)
 {
 	slurmctld_lock_t all_locks = {
@@ -503,23 +685,255 @@ static int _yield_locks(int secs)
 	_my_sleep(secs);
 	lock_slurmctld(all_locks);
 
-	if ((last_job_update  == job_update)  &&
-	    (last_node_update == node_update) &&
-	    (last_part_update == part_update) &&
-	    (! stop_backfill) && (! config_flag))
-		return 0;
+	if (stop_backfill)
+		return BF_YIELD_END;
+	if ((last_part_update != part_update) || config_flag)
+		return backfill_continue ? BF_YIELD_RESUME : BF_YIELD_END;
+	if ((last_job_update  != job_update)  ||
+	    (last_node_update != node_update))
+		return BF_YIELD_RESUME;
+	return BF_YIELD_UNCHANGED;
+}
+
+/* Take the lock serializing a parallel backfill cycle's worker threads.
+ *	Exclusive holders may modify job, node and scheduling state, shared
+ *	holders only perform select plugin will-run tests. Waiting exclusive
+ *	holders take precedence. No-op unless the cycle is parallel. */
+static void _bf_lock(bf_cycle_t *cycle, bool exclusive)
+{
+	if (!cycle->parallel)
+		return;
+
+	slurm_mutex_lock(&cycle->mutex);
+	if (exclusive) {
+		cycle->writers_waiting++;
+		while (cycle->writer || cycle->readers)
+			pthread_cond_wait(&cycle->cond, &cycle->mutex);
+		cycle->writers_waiting--;
+		cycle->writer = true;
+	} else {
+		while (cycle->writer || cycle->writers_waiting)
+			pthread_cond_wait(&cycle->cond, &cycle->mutex);
+		cycle->readers++;
+	}
+	slurm_mutex_unlock(&cycle->mutex);
+}
+
+static void _bf_unlock(bf_cycle_t *cycle, bool exclusive)
+{
+	if (!cycle->parallel)
+		return;
+
+	slurm_mutex_lock(&cycle->mutex);
+	if (exclusive)
+		cycle->writer = false;
 	else
-		return 1;
+		cycle->readers--;
+	pthread_cond_broadcast(&cycle->cond);
+	slurm_mutex_unlock(&cycle->mutex);
 }
 
-static int _attempt_backfill(void)
+/* Yield the slurmctld locks so other operations can proceed.
+ *	With worker threads, wait until every running worker has reached
+ *	this point, then let the thread holding the slurmctld locks yield
+ *	them on behalf of all workers.
+ * RET as _yield_locks() */
+static int _bf_yield(bf_cycle_t *cycle, int yield_sleep)
+{
+	uint32_t yield_gen;
+	int yield_rc;
+
+	if (!cycle->parallel) {
+		yield_rc = _yield_locks(yield_sleep);
+		if (yield_rc == BF_YIELD_RESUME)
+			slurmctld_diag_stats.bf_resumes++;
+		return yield_rc;
+	}
+
+	_bf_unlock(cycle, true);
+	slurm_mutex_lock(&cycle->mutex);
+	yield_gen = cycle->yield_gen;
+	cycle->paused++;
+	pthread_cond_broadcast(&cycle->cond);
+	while (yield_gen == cycle->yield_gen)
+		pthread_cond_wait(&cycle->cond, &cycle->mutex);
+	yield_rc = cycle->yield_rc;
+	slurm_mutex_unlock(&cycle->mutex);
+	_bf_lock(cycle, true);
+
+	return yield_rc;
+}
+
+static void _bf_queue_rec_del(void *x)
+{
+	xfree(x);
+}
+
+/* Find the representative of a partition's group, see _bf_split_queue() */
+static int _bf_part_group(int *group, int inx)
+{
+	while (group[inx] != inx) {
+		group[inx] = group[group[inx]];
+		inx = group[inx];
+	}
+	return inx;
+}
+
+static void _bf_part_join(int *group, int inx1, int inx2)
+{
+	inx1 = _bf_part_group(group, inx1);
+	inx2 = _bf_part_group(group, inx2);
+	if (inx1 < inx2)
+		group[inx2] = inx1;
+	else
+		group[inx1] = inx2;
+}
+
+/* Return the index of a partition in part_array, part_cnt if not found */
+static int _bf_part_inx(struct part_record **part_array, int part_cnt,
+			struct part_record *part_ptr)
+{
+	int i;
+
+	for (i = 0; i < part_cnt; i++) {
+		if (part_array[i] == part_ptr)
+			break;
+	}
+	return i;
+}
+
+/* Return true if a partition is still in part_list. With bf_continue
+ *	configured, partitions may be deleted while locks are yielded. */
+static bool _bf_part_valid(struct part_record *part_ptr)
+{
+	struct part_record *list_part_ptr;
+	ListIterator iter;
+
+	iter = list_iterator_create(part_list);
+	while ((list_part_ptr = (struct part_record *) list_next(iter))) {
+		if (list_part_ptr == part_ptr)
+			break;
+	}
+	list_iterator_destroy(iter);
+	return (list_part_ptr != NULL);
+}
+
+/*
+ * _bf_split_queue - Split the backfill job queue into queues which can be
+ *	evaluated independently. Partitions sharing any node, or both
+ *	requested by one job, are placed in the same group. Each group's
+ *	jobs are placed in the least loaded of up to max_queues queues.
+ * IN/OUT job_queue - backfill job queue, emptied if split
+ * IN max_queues - maximum number of queues to build
+ * OUT queues - the new job queues, free with list_destroy() and xfree()
+ * RET number of queues built, zero if the job queue can not be split
+ */
+static int _bf_split_queue(List job_queue, int max_queues, List **queues)
+{
+	struct part_record **part_array, *part_ptr;
+	job_queue_rec_t *job_queue_rec;
+	ListIterator iter, part_iter;
+	int *group, *group_jobs, *group_queue, *queue_jobs;
+	int i, j, inx, part_cnt, group_cnt = 0, queue_cnt;
+
+	part_cnt = list_count(part_list);
+	part_array = xmalloc(sizeof(struct part_record *) * (part_cnt + 1));
+	/* Index part_cnt groups jobs in partitions no longer in part_list */
+	group = xmalloc(sizeof(int) * (part_cnt + 1));
+	group_jobs = xmalloc(sizeof(int) * (part_cnt + 1));
+	iter = list_iterator_create(part_list);
+	for (i = 0; (part_ptr = (struct part_record *) list_next(iter)); i++)
+		part_array[i] = part_ptr;
+	list_iterator_destroy(iter);
+
+	for (i = 0; i <= part_cnt; i++)
+		group[i] = i;
+	for (i = 0; i < part_cnt; i++) {
+		if (!part_array[i]->node_bitmap)
+			continue;
+		for (j = i + 1; j < part_cnt; j++) {
+			if (part_array[j]->node_bitmap &&
+			    bit_overlap_any(part_array[i]->node_bitmap,
+					    part_array[j]->node_bitmap))
+				_bf_part_join(group, i, j);
+		}
+	}
+
+	/* A job in several partitions must be evaluated by one thread */
+	iter = list_iterator_create(job_queue);
+	while ((job_queue_rec = (job_queue_rec_t *) list_next(iter))) {
+		inx = _bf_part_inx(part_array, part_cnt,
+				   job_queue_rec->part_ptr);
+		if (!job_queue_rec->job_ptr->part_ptr_list)
+			continue;
+		part_iter = list_iterator_create(job_queue_rec->job_ptr->
+						 part_ptr_list);
+		while ((part_ptr = (struct part_record *)
+				   list_next(part_iter))) {
+			_bf_part_join(group, inx,
+				      _bf_part_inx(part_array, part_cnt,
+						   part_ptr));
+		}
+		list_iterator_destroy(part_iter);
+	}
+	list_iterator_reset(iter);
+	while ((job_queue_rec = (job_queue_rec_t *) list_next(iter))) {
+		inx = _bf_part_inx(part_array, part_cnt,
+				   job_queue_rec->part_ptr);
+		if (group_jobs[_bf_part_group(group, inx)]++ == 0)
+			group_cnt++;
+	}
+	list_iterator_destroy(iter);
+
+	if (group_cnt < 2) {
+		xfree(part_array);
+		xfree(group);
+		xfree(group_jobs);
+		return 0;
+	}
+
+	/* Assign each group to the queue with the fewest jobs */
+	queue_cnt = MIN(group_cnt, max_queues);
+	*queues = xmalloc(sizeof(List) * queue_cnt);
+	queue_jobs = xmalloc(sizeof(int) * queue_cnt);
+	group_queue = xmalloc(sizeof(int) * (part_cnt + 1));
+	for (i = 0; i < queue_cnt; i++)
+		(*queues)[i] = list_create(_bf_queue_rec_del);
+	for (i = 0; i <= part_cnt; i++) {
+		if (group_jobs[i] == 0)
+			continue;
+		inx = 0;
+		for (j = 1; j < queue_cnt; j++) {
+			if (queue_jobs[j] < queue_jobs[inx])
+				inx = j;
+		}
+		queue_jobs[inx] += group_jobs[i];
+		group_queue[i] = inx;
+	}
+	while ((job_queue_rec = (job_queue_rec_t *) list_pop(job_queue))) {
+		inx = _bf_part_inx(part_array, part_cnt,
+				   job_queue_rec->part_ptr);
+		inx = group_queue[_bf_part_group(group, inx)];
+		list_append((*queues)[inx], job_queue_rec);
+	}
+
+	xfree(part_array);
+	xfree(group);
+	xfree(group_jobs);
+	xfree(group_queue);
+	xfree(queue_jobs);
+	return queue_cnt;
+}
+
+/* Evaluate the jobs of one queue, reserving resources for those which can
+ *	not start now in a node_space map private to the queue.
+ * RET 1 if the backfill cycle was ended due to a system state change */
+static int _bf_run_queue(bf_cycle_t *cycle, List job_queue)
 {
 	DEF_TIMERS;
-	bool filter_root = false;
-	List job_queue;
 	job_queue_rec_t *job_queue_rec;
 	slurmdb_qos_rec_t *qos_ptr = NULL;
-	int i, j, node_space_recs;
+	int j, node_space_recs;
 	struct job_record *job_ptr;
 	struct part_record *part_ptr;
 	uint32_t end_time, end_reserve;
@@ -528,112 +942,78 @@ static int _attempt_backfill(void)
 	bitstr_t *avail_bitmap = NULL, *resv_bitmap = NULL;
 	bitstr_t *exc_core_bitmap = NULL;
 	time_t now, sched_start, later_start, start_res, resv_end;
+	time_t part_update = last_part_update;
 	node_space_map_t *node_space;
-	struct timeval bf_time1, bf_time2;
 	int sched_timeout = 2, yield_sleep = 1;
 	int rc = 0;
 	int job_test_count = 0;
-	uint32_t *uid = NULL, nuser = 0;
-	uint16_t *njobs = NULL;
-	bool already_counted;
-	uint32_t reject_array_job_id = 0;
+	bool already_counted, revalidate_jobs = false;
+	uint32_t job_id, reject_array_job_id = 0;
+	bitstr_t *node_space_avail;
+	int yield_rc;
 
-#ifdef HAVE_CRAY
-	/*
-	 * Run a Basil Inventory immediately before setting up the schedule
-	 * plan, to avoid race conditions caused by ALPS node state change.
-	 * Needs to be done with the node-state lock taken.
-	 */
 	START_TIMER;
-	if (select_g_reconfigure()) {
-		debug4("backfill: not scheduling due to ALPS");
-		return SLURM_SUCCESS;
-	}
-	END_TIMER;
-	if (debug_flags & DEBUG_FLAG_BACKFILL)
-		info("backfill: ALPS inventory completed, %s", TIME_STR);
-
-	/* The Basil inventory can take a long time to complete. Process
-	 * pending RPCs before starting the backfill scheduling logic */
-	_yield_locks(1);
-#endif
-
-	START_TIMER;
-	if (debug_flags & DEBUG_FLAG_BACKFILL)
-		info("backfill: beginning");
-	sched_start = now = time(NULL);
-
-	if (slurm_get_root_filter())
-		filter_root = true;
-
-	job_queue = build_job_queue(true);
-	if (list_count(job_queue) == 0) {
-		debug("backfill: no jobs to backfill");
-		list_destroy(job_queue);
-		return 0;
-	}
-
-	gettimeofday(&bf_time1, NULL);
-
-	slurmctld_diag_stats.bf_queue_len = list_count(job_queue);
-	slurmctld_diag_stats.bf_queue_len_sum += slurmctld_diag_stats.
-						 bf_queue_len;
-	slurmctld_diag_stats.bf_last_depth = 0;
-	slurmctld_diag_stats.bf_last_depth_try = 0;
-	slurmctld_diag_stats.bf_when_last_cycle = now;
-	bf_last_yields = 0;
-	slurmctld_diag_stats.bf_active = 1;
+	sched_start = now = cycle->sched_start;
 
 	node_space = xmalloc(sizeof(node_space_map_t) *
 			     (max_backfill_job_cnt + 3));
 	node_space[0].begin_time = sched_start;
 	node_space[0].end_time = sched_start + backfill_window;
 	node_space[0].avail_bitmap = bit_copy(avail_node_bitmap);
-	node_space[0].next = 0;
+	node_space[0].avail_refs = xmalloc(sizeof(int));
+	*node_space[0].avail_refs = 1;
 	node_space_recs = 1;
+	node_space_avail = bit_copy(avail_node_bitmap);
 	if (debug_flags & DEBUG_FLAG_BACKFILL)
-		_dump_node_space_table(node_space);
+		_dump_node_space_table(node_space, node_space_recs);
 
-	if (max_backfill_job_per_user) {
-		uid = xmalloc(BF_MAX_USERS * sizeof(uint32_t));
-		njobs = xmalloc(BF_MAX_USERS * sizeof(uint16_t));
-	}
 	while ((job_queue_rec = (job_queue_rec_t *)
 				list_pop_bottom(job_queue, sort_job_queue2))) {
-		job_ptr  = job_queue_rec->job_ptr;
-		orig_time_limit = job_ptr->time_limit;
-
 		if ((time(NULL) - sched_start) >= sched_timeout) {
-			uint32_t save_time_limit = job_ptr->time_limit;
-			job_ptr->time_limit = orig_time_limit;
 			if (debug_flags & DEBUG_FLAG_BACKFILL) {
 				END_TIMER;
 				info("backfill: completed yielding locks "
 				     "after testing %d jobs, %s",
 				     job_test_count, TIME_STR);
 			}
-			if (_yield_locks(yield_sleep) && !backfill_continue) {
+			yield_rc = _bf_yield(cycle, yield_sleep);
+			if (yield_rc == BF_YIELD_END) {
 				if (debug_flags & DEBUG_FLAG_BACKFILL) {
 					info("backfill: system state changed, "
 					     "breaking out after testing %d "
 					     "jobs", job_test_count);
 				}
+				xfree(job_queue_rec);
 				rc = 1;
 				break;
 			}
-			job_ptr->time_limit = save_time_limit;
+			if (yield_rc == BF_YIELD_RESUME) {
+				_node_space_revalidate(node_space,
+						       node_space_recs,
+						       node_space_avail);
+				revalidate_jobs = true;
+			}
 			/* Reset backfill scheduling timers, resume testing */
 			sched_start = time(NULL);
 			job_test_count = 0;
 			START_TIMER;
 		}
 
+		job_id   = job_queue_rec->job_id;
+		job_ptr  = job_queue_rec->job_ptr;
 		part_ptr = job_queue_rec->part_ptr;
 		job_test_count++;
 
 		xfree(job_queue_rec);
+		/* Job records may have been purged while locks were yielded */
+		if (revalidate_jobs && (find_job_record(job_id) != job_ptr))
+			continue;
+		if ((last_part_update != part_update) &&
+		    !_bf_part_valid(part_ptr))
+			continue;
 		if (!IS_JOB_PENDING(job_ptr))
 			continue;	/* started in other partition */
+		orig_time_limit = job_ptr->time_limit;
 		if (job_ptr->array_task_id != (uint16_t) NO_VAL) {
 			if (reject_array_job_id == job_ptr->array_job_id)
 				continue;  /* already rejected array element */
@@ -649,21 +1029,22 @@ static int _attempt_backfill(void)
 		already_counted = false;
 
 		if (max_backfill_job_per_user) {
-			for (j = 0; j < nuser; j++) {
-				if (job_ptr->user_id == uid[j]) {
-					njobs[j]++;
+			for (j = 0; j < cycle->nuser; j++) {
+				if (job_ptr->user_id == cycle->uid[j]) {
+					cycle->njobs[j]++;
 					if (debug_flags & DEBUG_FLAG_BACKFILL)
 						debug("backfill: user %u: "
 						      "#jobs %u",
-						      uid[j], njobs[j]);
+						      cycle->uid[j],
+						      cycle->njobs[j]);
 					break;
 				}
 			}
-			if (j == nuser) { /* user not found */
-				if (nuser < BF_MAX_USERS) {
-					uid[j] = job_ptr->user_id;
-					njobs[j] = 1;
-					nuser++;
+			if (j == cycle->nuser) { /* user not found */
+				if (cycle->nuser < BF_MAX_USERS) {
+					cycle->uid[j] = job_ptr->user_id;
+					cycle->njobs[j] = 1;
+					cycle->nuser++;
 				} else {
 					error("backfill: too many users in "
 					      "queue. Consider increasing "
@@ -672,9 +1053,10 @@ static int _attempt_backfill(void)
 				if (debug_flags & DEBUG_FLAG_BACKFILL)
 					debug2("backfill: found new user %u. "
 					       "Total #users now %u",
-					       job_ptr->user_id, nuser);
+					       job_ptr->user_id, cycle->nuser);
 			} else {
-				if (njobs[j] > max_backfill_job_per_user) {
+				if (cycle->njobs[j] >
+				    max_backfill_job_per_user) {
 					/* skip job */
 					if (debug_flags & DEBUG_FLAG_BACKFILL)
 						debug("backfill: have already "
@@ -692,7 +1074,7 @@ static int _attempt_backfill(void)
 		if (((part_ptr->state_up & PARTITION_SCHED) == 0) ||
 		    (part_ptr->node_bitmap == NULL))
 		 	continue;
-		if ((part_ptr->flags & PART_FLAG_ROOT_ONLY) && filter_root)
+		if ((part_ptr->flags & PART_FLAG_ROOT_ONLY) && cycle->filter_root)
 			continue;
 
 		if ((!job_independent(job_ptr, 0)) ||
@@ -750,7 +1132,8 @@ static int _attempt_backfill(void)
 				     "after testing %d jobs, %s",
 				     job_test_count, TIME_STR);
 			}
-			if (_yield_locks(yield_sleep) && !backfill_continue) {
+			yield_rc = _bf_yield(cycle, yield_sleep);
+			if (yield_rc == BF_YIELD_END) {
 				if (debug_flags & DEBUG_FLAG_BACKFILL) {
 					info("backfill: system state changed, "
 					     "breaking out after testing %d "
@@ -759,11 +1142,23 @@ static int _attempt_backfill(void)
 				rc = 1;
 				break;
 			}
-			job_ptr->time_limit = save_time_limit;
+			if (yield_rc == BF_YIELD_RESUME) {
+				_node_space_revalidate(node_space,
+						       node_space_recs,
+						       node_space_avail);
+				revalidate_jobs = true;
+			}
 			/* Reset backfill scheduling timers, resume testing */
 			sched_start = time(NULL);
 			job_test_count = 1;
 			START_TIMER;
+			if ((yield_rc == BF_YIELD_RESUME) &&
+			    ((find_job_record(job_id) != job_ptr) ||
+			     !IS_JOB_PENDING(job_ptr) ||
+			     ((last_part_update != part_update) &&
+			      !_bf_part_valid(part_ptr))))
+				continue;
+			job_ptr->time_limit = save_time_limit;
 		}
 
 		FREE_NULL_BITMAP(avail_bitmap);
@@ -784,19 +1179,14 @@ static int _attempt_backfill(void)
 		/* Identify usable nodes for this job */
 		bit_and(avail_bitmap, part_ptr->node_bitmap);
 		bit_and(avail_bitmap, up_node_bitmap);
-		for (j=0; ; ) {
-			if ((node_space[j].end_time > start_res) &&
-			     node_space[j].next && (later_start == 0))
+		for (j = _node_space_find(node_space, node_space_recs,
+					  start_res);
+		     j < node_space_recs; j++) {
+			if (((j + 1) < node_space_recs) && (later_start == 0))
 				later_start = node_space[j].end_time;
-			if (node_space[j].end_time <= start_res)
-				;
-			else if (node_space[j].begin_time <= end_time) {
-				bit_and(avail_bitmap,
-					node_space[j].avail_bitmap);
-			} else
-				break;
-			if ((j = node_space[j].next) == 0)
+			if (node_space[j].begin_time > end_time)
 				break;
+			bit_and(avail_bitmap, node_space[j].avail_bitmap);
 		}
 		if ((resv_end++) &&
 		    ((later_start == 0) || (resv_end < later_start))) {
@@ -842,8 +1232,13 @@ static int _attempt_backfill(void)
 			already_counted = true;
 		}
 
+		/* Other threads may test jobs while this one does */
+		_bf_unlock(cycle, true);
+		_bf_lock(cycle, false);
 		j = _try_sched(job_ptr, &avail_bitmap, min_nodes, max_nodes,
 			       req_nodes, exc_core_bitmap);
+		_bf_unlock(cycle, false);
+		_bf_lock(cycle, true);
 
 		now = time(NULL);
 		if (j != SLURM_SUCCESS) {
@@ -855,6 +1250,7 @@ static int _attempt_backfill(void)
 		if (start_res > job_ptr->start_time) {
 			job_ptr->start_time = start_res;
 			last_job_update = now;
+			job_ptr->last_update = now;
 		}
 		if (job_ptr->start_time <= now) {
 			uint32_t save_time_limit = job_ptr->time_limit;
@@ -872,7 +1268,8 @@ static int _attempt_backfill(void)
 				job_ptr->end_time = job_ptr->start_time +
 						    (comp_time_limit * 60);
 				_reset_job_time_limit(job_ptr, now,
-						      node_space);
+						      node_space,
+						      node_space_recs);
 				time_limit = job_ptr->time_limit;
 			} else {
 				job_ptr->time_limit = orig_time_limit;
@@ -918,8 +1315,9 @@ static int _attempt_backfill(void)
 		}
 
 		end_reserve = job_ptr->start_time + (time_limit * 60);
-		if (_test_resv_overlap(node_space, avail_bitmap,
-				       job_ptr->start_time, end_reserve)) {
+		if (_test_resv_overlap(node_space, node_space_recs,
+				       avail_bitmap, job_ptr->start_time,
+				       end_reserve)) {
 			/* This job overlaps with an existing reservation for
 			 * job to be backfill scheduled, which the sched
 			 * plugin does not know about. Try again later. */
@@ -938,27 +1336,187 @@ static int _attempt_backfill(void)
 		_add_reservation(job_ptr->start_time, end_reserve,
 				 avail_bitmap, node_space, &node_space_recs);
 		if (debug_flags & DEBUG_FLAG_BACKFILL)
-			_dump_node_space_table(node_space);
+			_dump_node_space_table(node_space, node_space_recs);
 	}
-	xfree(uid);
-	xfree(njobs);
 	FREE_NULL_BITMAP(avail_bitmap);
 	FREE_NULL_BITMAP(exc_core_bitmap);
 	FREE_NULL_BITMAP(resv_bitmap);
 
-	for (i=0; ; ) {
-		FREE_NULL_BITMAP(node_space[i].avail_bitmap);
-		if ((i = node_space[i].next) == 0)
-			break;
+	_node_space_free(node_space, node_space_recs);
+	FREE_NULL_BITMAP(node_space_avail);
+	if (debug_flags & DEBUG_FLAG_BACKFILL) {
+		END_TIMER;
+		info("backfill: completed testing %d jobs, %s",
+		     job_test_count, TIME_STR);
 	}
-	xfree(node_space);
+	return rc;
+}
+
+/* Backfill worker thread, evaluates one of the queues built by
+ *	_bf_split_queue() */
+static void *_bf_queue_agent(void *args)
+{
+	bf_queue_t *queue = (bf_queue_t *) args;
+	bf_cycle_t *cycle = queue->cycle;
+
+	_bf_lock(cycle, true);
+	(void) _bf_run_queue(cycle, queue->job_queue);
+	_bf_unlock(cycle, true);
+
+	slurm_mutex_lock(&cycle->mutex);
+	cycle->active--;
+	pthread_cond_broadcast(&cycle->cond);
+	slurm_mutex_unlock(&cycle->mutex);
+	return NULL;
+}
+
+/* Evaluate the queues on separate threads. The calling thread holds the
+ *	slurmctld locks and yields them whenever all workers ask for it.
+ * RET 1 if the backfill cycle was ended due to a system state change */
+static int _bf_run_parallel(bf_cycle_t *cycle, List *queues, int queue_cnt,
+			    int yield_sleep)
+{
+	bf_queue_t *queue;
+	pthread_attr_t attr;
+	int i, retries;
+	int yield_rc = BF_YIELD_UNCHANGED;
+
+	slurm_mutex_init(&cycle->mutex);
+	pthread_cond_init(&cycle->cond, NULL);
+	cycle->parallel = true;
+	cycle->active = queue_cnt;
+
+	queue = xmalloc(sizeof(bf_queue_t) * queue_cnt);
+	for (i = 0; i < queue_cnt; i++) {
+		queue[i].cycle = cycle;
+		queue[i].job_queue = queues[i];
+		slurm_attr_init(&attr);
+		if (pthread_attr_setdetachstate(&attr,
+						PTHREAD_CREATE_JOINABLE))
+			error("pthread_attr_setdetachstate error %m");
+		retries = 0;
+		while (pthread_create(&queue[i].thread, &attr,
+				      _bf_queue_agent, &queue[i])) {
+			error("pthread_create error %m");
+			if (++retries > 5)
+				fatal("Can't create pthread");
+			usleep(10000);	/* sleep and retry */
+		}
+		slurm_attr_destroy(&attr);
+	}
+
+	slurm_mutex_lock(&cycle->mutex);
+	while (cycle->active) {
+		if (cycle->paused && (cycle->paused == cycle->active)) {
+			slurm_mutex_unlock(&cycle->mutex);
+			yield_rc = _yield_locks(yield_sleep);
+			if (yield_rc == BF_YIELD_RESUME)
+				slurmctld_diag_stats.bf_resumes++;
+			slurm_mutex_lock(&cycle->mutex);
+			cycle->yield_rc = yield_rc;
+			cycle->paused = 0;
+			cycle->yield_gen++;
+			pthread_cond_broadcast(&cycle->cond);
+			continue;
+		}
+		pthread_cond_wait(&cycle->cond, &cycle->mutex);
+	}
+	slurm_mutex_unlock(&cycle->mutex);
+
+	for (i = 0; i < queue_cnt; i++)
+		pthread_join(queue[i].thread, NULL);
+	xfree(queue);
+	pthread_cond_destroy(&cycle->cond);
+	slurm_mutex_destroy(&cycle->mutex);
+
+	return (yield_rc == BF_YIELD_END) ? 1 : 0;
+}
+
+static int _attempt_backfill(void)
+{
+	DEF_TIMERS;
+	bf_cycle_t cycle;
+	List job_queue, *queues = NULL;
+	struct timeval bf_time1, bf_time2;
+	int i, queue_cnt = 0, yield_sleep = 1;
+	int rc = 0;
+
+#ifdef HAVE_CRAY
+	/*
+	 * Run a Basil Inventory immediately before setting up the schedule
+	 * plan, to avoid race conditions caused by ALPS node state change.
+	 * Needs to be done with the node-state lock taken.
+	 */
+	START_TIMER;
+	if (select_g_reconfigure()) {
+		debug4("backfill: not scheduling due to ALPS");
+		return SLURM_SUCCESS;
+	}
+	END_TIMER;
+	if (debug_flags & DEBUG_FLAG_BACKFILL)
+		info("backfill: ALPS inventory completed, %s", TIME_STR);
+
+	/* The Basil inventory can take a long time to complete. Process
+	 * pending RPCs before starting the backfill scheduling logic */
+	_yield_locks(1);
+#endif
+
+	START_TIMER;
+	if (debug_flags & DEBUG_FLAG_BACKFILL)
+		info("backfill: beginning");
+	memset(&cycle, 0, sizeof(bf_cycle_t));
+	cycle.sched_start = time(NULL);
+
+	if (slurm_get_root_filter())
+		cycle.filter_root = true;
+
+	job_queue = build_job_queue(true);
+	if (list_count(job_queue) == 0) {
+		debug("backfill: no jobs to backfill");
+		list_destroy(job_queue);
+		return 0;
+	}
+
+	gettimeofday(&bf_time1, NULL);
+
+	slurmctld_diag_stats.bf_queue_len = list_count(job_queue);
+	slurmctld_diag_stats.bf_queue_len_sum += slurmctld_diag_stats.
+						 bf_queue_len;
+	slurmctld_diag_stats.bf_last_depth = 0;
+	slurmctld_diag_stats.bf_last_depth_try = 0;
+	slurmctld_diag_stats.bf_when_last_cycle = cycle.sched_start;
+	bf_last_yields = 0;
+	slurmctld_diag_stats.bf_active = 1;
+
+	if (max_backfill_job_per_user) {
+		cycle.uid = xmalloc(BF_MAX_USERS * sizeof(uint32_t));
+		cycle.njobs = xmalloc(BF_MAX_USERS * sizeof(uint16_t));
+	}
+	if (backfill_threads > 1)
+		queue_cnt = _bf_split_queue(job_queue, backfill_threads,
+					    &queues);
+	if (queue_cnt) {
+		if (debug_flags & DEBUG_FLAG_BACKFILL) {
+			info("backfill: testing %d independent queues in "
+			     "parallel", queue_cnt);
+		}
+		rc = _bf_run_parallel(&cycle, queues, queue_cnt, yield_sleep);
+		for (i = 0; i < queue_cnt; i++)
+			list_destroy(queues[i]);
+		xfree(queues);
+	} else
+		rc = _bf_run_queue(&cycle, job_queue);
+	if (rc)
+		slurmctld_diag_stats.bf_restarts++;
+	xfree(cycle.uid);
+	xfree(cycle.njobs);
+
 	list_destroy(job_queue);
 	gettimeofday(&bf_time2, NULL);
 	_do_diag_stats(&bf_time1, &bf_time2, yield_sleep);
 	if (debug_flags & DEBUG_FLAG_BACKFILL) {
 		END_TIMER;
-		info("backfill: completed testing %d jobs, %s",
-		     job_test_count, TIME_STR);
+		info("backfill: cycle completed, %s", TIME_STR);
 	}
 	return rc;
 }
@@ -985,6 +1543,7 @@ static int _start_job(struct job_record *job_ptr, bitstr_t *resv_bitmap)
 	if (rc == SLURM_SUCCESS) {
 		/* job initiated */
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 		info("backfill: Started JobId=%u on %s",
 		     job_ptr->job_id, job_ptr->nodes);
 		if (job_ptr->batch_flag == 0)
@@ -1022,14 +1581,16 @@ static int _start_job(struct job_record *job_ptr, bitstr_t *resv_bitmap)
  *	Avoid using resources reserved for pending jobs or in resource
  *	reservations */
 static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
-				  node_space_map_t *node_space)
+				  node_space_map_t *node_space,
+				  int node_space_recs)
 {
 	int32_t j, resv_delay;
 	uint32_t orig_time_limit = job_ptr->time_limit;
 
-	for (j=0; ; ) {
+	for (j = 0; j < node_space_recs; j++) {
+		if (node_space[j].begin_time >= job_ptr->end_time)
+			break;
 		if ((node_space[j].begin_time != now) &&
-		    (node_space[j].begin_time < job_ptr->end_time) &&
 		    (!bit_super_set(job_ptr->node_bitmap,
 				    node_space[j].avail_bitmap))) {
 			/* Job overlaps pending job's resource reservation */
@@ -1038,8 +1599,6 @@ static void _reset_job_time_limit(struct job_record *job_ptr, time_t now,
 			if (resv_delay < job_ptr->time_limit)
 				job_ptr->time_limit = resv_delay;
 		}
-		if ((j = node_space[j].next) == 0)
-			break;
 	}
 	job_ptr->time_limit = MAX(job_ptr->time_min, job_ptr->time_limit);
 	job_ptr->end_time = job_ptr->start_time + (job_ptr->time_limit * 60);
@@ -1073,60 +1632,31 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
 			     node_space_map_t *node_space,
 			     int *node_space_recs)
 {
-	bool placed = false;
 	int i, j;
 
 	/* If we decrease the resolution of our timing information, this can
 	 * decrease the number of records managed and increase performance */
 	start_time = (start_time / backfill_resolution) * backfill_resolution;
 	end_reserve = (end_reserve / backfill_resolution) * backfill_resolution;
-
-	for (j=0; ; ) {
-		if (node_space[j].end_time > start_time) {
-			/* insert start entry record */
-			i = *node_space_recs;
-			node_space[i].begin_time = start_time;
-			node_space[i].end_time = node_space[j].end_time;
-			node_space[j].end_time = start_time;
-			node_space[i].avail_bitmap =
-				bit_copy(node_space[j].avail_bitmap);
-			node_space[i].next = node_space[j].next;
-			node_space[j].next = i;
-			(*node_space_recs)++;
-			placed = true;
-		}
-		if (node_space[j].end_time == start_time) {
-			/* no need to insert new start entry record */
-			placed = true;
-		}
-		if (placed == true) {
-			j = node_space[j].next;
-			if (j && (end_reserve < node_space[j].end_time)) {
-				/* insert end entry record */
-				i = *node_space_recs;
-				node_space[i].begin_time = end_reserve;
-				node_space[i].end_time = node_space[j].
-							 end_time;
-				node_space[j].end_time = end_reserve;
-				node_space[i].avail_bitmap =
-					bit_copy(node_space[j].avail_bitmap);
-				node_space[i].next = node_space[j].next;
-				node_space[j].next = i;
-				(*node_space_recs)++;
-			}
-			break;
-		}
-		if ((j = node_space[j].next) == 0)
-			break;
+	if (end_reserve <= start_time)
+		return;
+
+	/* Insert records beginning at start_time and at end_reserve */
+	j = _node_space_find(node_space, *node_space_recs, start_time);
+	if (j >= *node_space_recs)
+		return;		/* beyond the backfill window */
+	if (node_space[j].begin_time < start_time) {
+		_node_space_split(node_space, node_space_recs, j, start_time);
+		j++;
 	}
+	i = _node_space_find(node_space, *node_space_recs, end_reserve);
+	if ((i < *node_space_recs) && (node_space[i].begin_time < end_reserve))
+		_node_space_split(node_space, node_space_recs, i, end_reserve);
 
-	for (j=0; ; ) {
-		if ((node_space[j].begin_time >= start_time) &&
-		    (node_space[j].end_time <= end_reserve))
-			bit_and(node_space[j].avail_bitmap, res_bitmap);
-		if ((node_space[j].begin_time >= end_reserve) ||
-		    ((j = node_space[j].next) == 0))
+	for ( ; j < *node_space_recs; j++) {
+		if (node_space[j].begin_time >= end_reserve)
 			break;
+		_node_space_and(&node_space[j], res_bitmap);
 	}
 }
 
@@ -1139,21 +1669,20 @@ static void _add_reservation(uint32_t start_time, uint32_t end_reserve,
  * IN end_reserve - end time of job
  */
 static bool _test_resv_overlap(node_space_map_t *node_space,
-			       bitstr_t *use_bitmap, uint32_t start_time,
-			       uint32_t end_reserve)
+			       int node_space_recs, bitstr_t *use_bitmap,
+			       uint32_t start_time, uint32_t end_reserve)
 {
 	bool overlap = false;
 	int j;
 
-	for (j=0; ; ) {
-		if ((node_space[j].end_time   > start_time) &&
-		    (node_space[j].begin_time < end_reserve) &&
-		    (!bit_super_set(use_bitmap, node_space[j].avail_bitmap))) {
+	for (j = _node_space_find(node_space, node_space_recs, start_time);
+	     j < node_space_recs; j++) {
+		if (node_space[j].begin_time >= end_reserve)
+			break;
+		if (!bit_super_set(use_bitmap, node_space[j].avail_bitmap)) {
 			overlap = true;
 			break;
 		}
-		if ((j = node_space[j].next) == 0)
-			break;
 	}
 	return overlap;
 }
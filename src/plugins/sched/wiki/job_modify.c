@@ -97,6 +97,7 @@ static int	_job_modify(uint32_t jobid, char *bank_ptr,
 				((job_ptr->time_limit -
 				  old_time) * 60);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
 	if (bank_ptr) {
@@ -183,6 +184,7 @@ host_fini:	if (rc) {
 		job_ptr->partition = xstrdup(part_name_ptr);
 		job_ptr->part_ptr = part_ptr;
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 		update_accounting = true;
 	}
 	if (new_node_cnt) {
@@ -194,6 +196,7 @@ host_fini:	if (rc) {
 			info("wiki: change job %u min_nodes to %u",
 				jobid, new_node_cnt);
 			last_job_update = time(NULL);
+			job_ptr->last_update = last_job_update;
 			update_accounting = true;
 		} else {
 			error("wiki: MODIFYJOB node count of non-pending "
@@ -2130,6 +2130,7 @@ extern int submit_job(struct job_record *job_ptr, bitstr_t *slurm_block_bitmap,
 			blocks_added = 0;
 		}
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
 	if (bg_conf->layout_mode == LAYOUT_DYNAMIC) {
@@ -161,6 +161,7 @@ static void _sync_agent(bg_action_t *bg_action_ptr, bg_record_t *bg_record)
 		int sync_user_rc;
 		job_ptr->job_state &= (~JOB_CONFIGURING);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 		/* Just in case reset the boot flags */
 		bg_record->boot_state = 0;
 		bg_record->boot_count = 0;
@@ -570,6 +571,7 @@ no_reboot:
 		lock_slurmctld(job_write_lock);
 		bg_action_ptr->job_ptr->job_state &= (~JOB_CONFIGURING);
 		last_job_update = time(NULL);
+		bg_action_ptr->job_ptr->last_update = last_job_update;
 		unlock_slurmctld(job_write_lock);
 	}
 
@@ -330,6 +330,7 @@ extern int select_nodeinfo_set_all(void)
 		select_nodeinfo_t *nodeinfo;
 
 		node_ptr = &(node_record_table_ptr[i]);
+		node_ptr->last_update = last_node_update;
 		xassert(node_ptr->select_nodeinfo);
 		nodeinfo = node_ptr->select_nodeinfo->data;
 		xassert(nodeinfo);
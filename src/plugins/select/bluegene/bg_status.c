@@ -228,6 +228,7 @@ nochange_state:
 				bg_record->job_ptr->job_state |=
 					JOB_CONFIGURING;
 				last_job_update = time(NULL);
+				bg_record->job_ptr->last_update = last_job_update;
 			} else if (bg_record->job_list
 				   && list_count(bg_record->job_list)) {
 				struct job_record *job_ptr;
@@ -245,6 +246,7 @@ nochange_state:
 						continue;
 					}
 					job_ptr->job_state |= JOB_CONFIGURING;
+					job_ptr->last_update = time(NULL);
 				}
 				list_iterator_destroy(job_itr);
 				last_job_update = time(NULL);
@@ -294,6 +296,7 @@ nochange_state:
 				bg_record->job_ptr->job_state &=
 					(~JOB_CONFIGURING);
 				last_job_update = time(NULL);
+				bg_record->job_ptr->last_update = last_job_update;
 			} else if (bg_record->job_list
 				   && list_count(bg_record->job_list)) {
 				struct job_record *job_ptr;
@@ -312,6 +315,7 @@ nochange_state:
 					}
 					job_ptr->job_state &=
 						(~JOB_CONFIGURING);
+					job_ptr->last_update = time(NULL);
 				}
 				list_iterator_destroy(job_itr);
 				last_job_update = time(NULL);
@@ -1771,6 +1771,7 @@ extern int select_p_job_ready(struct job_record *job_ptr)
 				 * missed it somehow. */
 				job_ptr->job_state &= (~JOB_CONFIGURING);
 				last_job_update = time(NULL);
+				job_ptr->last_update = last_job_update;
 				rc = 1;
 			} else if (uid != job_ptr->user_id)
 				rc = 0;
@@ -115,6 +115,33 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *node_map,
 			uint32_t req_nodes, uint32_t cr_node_cnt,
 			uint16_t *cpu_cnt);
 
+/* _count_free_cores - Count the available cores of each socket of the given
+ *                     node a word at a time rather than testing each bit.
+ *                     Returns the total count of available cores.
+ *
+ * IN core_map         - core_bitmap of available cores
+ * IN node_i           - index of node to be evaluated
+ * OUT free_cores      - count of available cores on each socket
+ */
+static uint16_t _count_free_cores(bitstr_t *core_map, const uint32_t node_i,
+				  uint16_t *free_cores)
+{
+	uint32_t core_begin    = cr_get_coremap_offset(node_i);
+	uint32_t core_end      = cr_get_coremap_offset(node_i+1);
+	uint32_t c, socket_end;
+	uint16_t i, free_core_count = 0;
+	uint16_t sockets          = select_node_record[node_i].sockets;
+	uint16_t cores_per_socket = select_node_record[node_i].cores;
+
+	for (i = 0, c = core_begin; (i < sockets) && (c < core_end); i++) {
+		socket_end = MIN(c + cores_per_socket, core_end);
+		free_cores[i] = bit_set_count_range(core_map, c, socket_end);
+		free_core_count += free_cores[i];
+		c = socket_end;
+	}
+	return free_core_count;
+}
+
 /* _allocate_sockets - Given the job requirements, determine which sockets
  *                     from the given node can be allocated (if any) to this
  *                     job. Returns the number of cpus that can be used by
@@ -134,7 +161,7 @@ uint16_t _allocate_sockets(struct job_record *job_ptr, bitstr_t *core_map,
 	uint32_t core_end      = cr_get_coremap_offset(node_i+1);
 	uint32_t c;
 	uint16_t cpus_per_task = job_ptr->details->cpus_per_task;
-	uint16_t *used_cores, *free_cores, free_core_count = 0;
+	uint16_t *free_cores, free_core_count = 0;
 	uint16_t i, j, sockets    = select_node_record[node_i].sockets;
 	uint16_t cores_per_socket = select_node_record[node_i].cores;
 	uint16_t threads_per_core = select_node_record[node_i].vpus;
@@ -215,28 +242,16 @@ uint16_t _allocate_sockets(struct job_record *job_ptr, bitstr_t *core_map,
 	/* Step 1: create and compute core-count-per-socket
 	 * arrays and total core counts */
 	free_cores = xmalloc(sockets * sizeof(uint16_t));
-	used_cores = xmalloc(sockets * sizeof(uint16_t));
+	free_core_count = _count_free_cores(core_map, node_i, free_cores);
 
-	for (c = core_begin; c < core_end; c++) {
-		i = (uint16_t) (c - core_begin) / cores_per_socket;
-		if (bit_test(core_map, c)) {
-			free_cores[i]++;
-			free_core_count++;
-		} else {
-			used_cores[i]++;
-		}
-	}
 	/* if a socket is already in use, it cannot be used
 	 * by this job */
-	for (i = 0; i < sockets; i++) {
-		if (used_cores[i]) {
+	for (i = 0, c = core_begin; i < sockets; i++, c += cores_per_socket) {
+		if (free_cores[i] < MIN(cores_per_socket, core_end - c)) {
 			free_core_count -= free_cores[i];
-			used_cores[i] += free_cores[i];
 			free_cores[i] = 0;
 		}
 	}
-	xfree(used_cores);
-	used_cores = NULL;
 
 	/* Step 2: check min_cores per socket and min_sockets per node */
 	j = 0;
@@ -465,14 +480,7 @@ uint16_t _allocate_cores(struct job_record *job_ptr, bitstr_t *core_map,
 	/* Step 1: create and compute core-count-per-socket
 	 * arrays and total core counts */
 	free_cores = xmalloc(sockets * sizeof(uint16_t));
-
-	for (c = core_begin; c < core_end; c++) {
-		i = (uint16_t) (c - core_begin) / cores_per_socket;
-		if (bit_test(core_map, c)) {
-			free_cores[i]++;
-			free_core_count++;
-		}
-	}
+	free_core_count = _count_free_cores(core_map, node_i, free_cores);
 
 	/* Step 2: check min_cores per socket and min_sockets per node */
 	j = 0;
@@ -924,6 +932,11 @@ static void _get_res_usage(struct job_record *job_ptr, bitstr_t *node_map,
 	for (n = 0; n < cr_node_cnt; n++) {
 		if (!bit_test(node_map, n))
 			continue;
+		/* nodes without an available core can not be used, so skip
+		 * the per socket, memory and gres evaluation */
+		if (bit_set_count_range(core_map, cr_get_coremap_offset(n),
+					cr_get_coremap_offset(n+1)) == 0)
+			continue;
 		cpu_cnt[n] = _can_job_run_on_node(job_ptr, core_map, n,
 						  node_usage, cr_type,
 						  test_only);
@@ -1334,6 +1347,56 @@ fini:	xfree(consec_cpus);
 	return error_code;
 }
 
+/*
+ * _sum_switch_cpus - Add up the CPUs available to a job on each switch.
+ *	Leaf switches, and switches with nodes below more than one of their
+ *	descendent switches, count their nodes. Other switches add up their
+ *	descendent switches, so most nodes are only visited once rather than
+ *	once per switch level.
+ *
+ * IN job_ptr           - job being considered
+ * IN switches_bitmap   - usable nodes on each switch
+ * OUT switches_cpu_cnt - usable CPUs on each switch
+ * IN cpu_cnt           - usable CPUs on each node
+ */
+static void _sum_switch_cpus(struct job_record *job_ptr,
+			     bitstr_t **switches_bitmap, int *switches_cpu_cnt,
+			     uint16_t *cpu_cnt)
+{
+	struct switch_record *switch_ptr;
+	int i, j, first, last, level, max_level = 0;
+
+	for (j=0; j<switch_record_cnt; j++)
+		max_level = MAX(max_level, switch_record_table[j].level);
+
+	/* descendent switches are always at a lower level */
+	for (level=0; level<=max_level; level++) {
+		switch_ptr = switch_record_table;
+		for (j=0; j<switch_record_cnt; j++, switch_ptr++) {
+			if (switch_ptr->level != level)
+				continue;
+			switches_cpu_cnt[j] = 0;
+			if (switch_ptr->num_switches && switch_ptr->disjoint) {
+				for (i=0; i<switch_ptr->num_switches; i++) {
+					switches_cpu_cnt[j] += switches_cpu_cnt
+						[switch_ptr->switch_index[i]];
+				}
+				continue;
+			}
+			first = bit_ffs(switches_bitmap[j]);
+			if (first < 0)
+				continue;
+			last = bit_fls(switches_bitmap[j]);
+			for (i=first; i<=last; i++) {
+				if (!bit_test(switches_bitmap[j], i))
+					continue;
+				switches_cpu_cnt[j] +=
+					_get_cpu_cnt(job_ptr, i, cpu_cnt);
+			}
+		}
+	}
+}
+
 /*
  * A network topology aware version of _eval_nodes().
  * NOTE: The logic here is almost identical to that of _job_test_topo()
@@ -1519,18 +1582,8 @@ static int _eval_nodes_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 		}
 	} else {
 		/* No specific required nodes, calculate CPU counts */
-		for (j=0; j<switch_record_cnt; j++) {
-			first = bit_ffs(switches_bitmap[j]);
-			if (first < 0)
-				continue;
-			last  = bit_fls(switches_bitmap[j]);
-			for (i=first; i<=last; i++) {
-				if (!bit_test(switches_bitmap[j], i))
-					continue;
-				switches_cpu_cnt[j] +=
-					_get_cpu_cnt(job_ptr, i, cpu_cnt);
-			}
-		}
+		_sum_switch_cpus(job_ptr, switches_bitmap, switches_cpu_cnt,
+				 cpu_cnt);
 	}
 
 	/* Determine lowest level switch satisfying request with best fit 
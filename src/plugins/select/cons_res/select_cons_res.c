@@ -109,6 +109,10 @@
 
 #define NODEINFO_MAGIC 0x82aa
 
+/* Minimum seconds between rebuilds of a partition's rows to repack its jobs,
+ * see _rm_job_from_row() */
+#define CR_ROW_COMPACT_INTERVAL 10
+
 /* These are defined here so when we link with something other than
  * the slurmctld we will have these symbols defined.  They will get
  * overwritten when linking with the slurmctld.
@@ -195,6 +199,14 @@ struct select_nodeinfo {
 	uint32_t alloc_memory;
 };
 
+/* Data copied to give a will-run or preemption test its own view of
+ * select_part_record and select_node_usage */
+typedef struct cow_stats {
+	uint32_t part_bytes;	/* part_res_records, rows and job lists */
+	uint32_t usage_bytes;	/* node_use_record array */
+	uint32_t gres_nodes;	/* nodes with a duplicated gres_list */
+} cow_stats_t;
+
 extern select_nodeinfo_t *select_p_select_nodeinfo_alloc(void);
 extern int select_p_select_nodeinfo_free(select_nodeinfo_t *nodeinfo);
 
@@ -291,7 +303,8 @@ static void _dump_state(struct part_res_record *p_ptr)
 	return;
 }
 
-/* Helper function for _dup_part_data: create a duplicate part_row_data array */
+/* Helper function for _cow_part_rows and _build_row_bitmaps: create a
+ * duplicate part_row_data array */
 static struct part_row_data *_dup_row_data(struct part_row_data *orig_row,
 					   uint16_t num_rows)
 {
@@ -305,6 +318,7 @@ static struct part_row_data *_dup_row_data(struct part_row_data *orig_row,
 	for (i = 0; i < num_rows; i++) {
 		new_row[i].num_jobs = orig_row[i].num_jobs;
 		new_row[i].job_list_size = orig_row[i].job_list_size;
+		new_row[i].overlap = orig_row[i].overlap;
 		if (orig_row[i].row_bitmap)
 			new_row[i].row_bitmap= bit_copy(orig_row[i].
 							row_bitmap);
@@ -321,10 +335,14 @@ static struct part_row_data *_dup_row_data(struct part_row_data *orig_row,
 }
 
 
-/* Create a duplicate part_res_record list */
-static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
+/* Create a copy-on-write duplicate of a part_res_record list. Each record
+ * gets its own row array, but the row bitmaps and job lists stay shared with
+ * orig_ptr until _cow_part_rows() is called for that record. */
+static struct part_res_record *_cow_part_data(struct part_res_record *orig_ptr,
+					      cow_stats_t *stats)
 {
 	struct part_res_record *new_part_ptr, *new_ptr;
+	int size;
 
 	if (orig_ptr == NULL)
 		return NULL;
@@ -333,10 +351,19 @@ static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
 	new_ptr = new_part_ptr;
 
 	while (orig_ptr) {
+		stats->part_bytes += sizeof(struct part_res_record);
 		new_ptr->part_ptr = orig_ptr->part_ptr;
 		new_ptr->num_rows = orig_ptr->num_rows;
-		new_ptr->row = _dup_row_data(orig_ptr->row,
-					     orig_ptr->num_rows);
+		new_ptr->compact_time = orig_ptr->compact_time;
+		new_ptr->compact_needed = orig_ptr->compact_needed;
+		if (orig_ptr->row && orig_ptr->num_rows) {
+			size = orig_ptr->num_rows *
+			       sizeof(struct part_row_data);
+			new_ptr->row = xmalloc(size);
+			memcpy(new_ptr->row, orig_ptr->row, size);
+			new_ptr->rows_shared = true;
+			stats->part_bytes += size;
+		}
 		if (orig_ptr->next) {
 			new_ptr->next = xmalloc(sizeof(struct part_res_record));
 			new_ptr = new_ptr->next;
@@ -346,12 +373,37 @@ static struct part_res_record *_dup_part_data(struct part_res_record *orig_ptr)
 	return new_part_ptr;
 }
 
+/* Give a record created by _cow_part_data() private copies of its row
+ * bitmaps and job lists, so that its rows can be modified */
+static void _cow_part_rows(struct part_res_record *p_ptr, cow_stats_t *stats)
+{
+	struct part_row_data *new_row;
+	int i;
+
+	if (!p_ptr->rows_shared)
+		return;
+
+	new_row = _dup_row_data(p_ptr->row, p_ptr->num_rows);
+	for (i = 0; i < p_ptr->num_rows; i++) {
+		if (new_row[i].row_bitmap) {
+			stats->part_bytes += (bit_size(new_row[i].row_bitmap)
+					      + 7) / 8;
+		}
+		stats->part_bytes += new_row[i].job_list_size *
+				     sizeof(struct job_resources *);
+	}
+	xfree(p_ptr->row);
+	p_ptr->row = new_row;
+	p_ptr->rows_shared = false;
+}
 
-/* Create a duplicate part_res_record list */
-static struct node_use_record *_dup_node_usage(struct node_use_record *orig_ptr)
+/* Create a copy-on-write duplicate of a node_use_record array. The gres_list
+ * of each node stays shared with orig_ptr (or the node record) until
+ * _cow_node_gres() is called for that node. */
+static struct node_use_record *_cow_node_usage(struct node_use_record *orig_ptr,
+					       cow_stats_t *stats)
 {
 	struct node_use_record *new_use_ptr, *new_ptr;
-	List gres_list;
 	uint32_t i;
 
 	if (orig_ptr == NULL)
@@ -359,19 +411,35 @@ static struct node_use_record *_dup_node_usage(struct node_use_record *orig_ptr)
 
 	new_use_ptr = xmalloc(select_node_cnt * sizeof(struct node_use_record));
 	new_ptr = new_use_ptr;
+	stats->usage_bytes += select_node_cnt * sizeof(struct node_use_record);
 
 	for (i = 0; i < select_node_cnt; i++) {
 		new_ptr[i].node_state   = orig_ptr[i].node_state;
 		new_ptr[i].alloc_memory = orig_ptr[i].alloc_memory;
 		if (orig_ptr[i].gres_list)
-			gres_list = orig_ptr[i].gres_list;
+			new_ptr[i].gres_list = orig_ptr[i].gres_list;
 		else
-			gres_list = node_record_table_ptr[i].gres_list;
-		new_ptr[i].gres_list = gres_plugin_node_state_dup(gres_list);
+			new_ptr[i].gres_list = node_record_table_ptr[i].
+					       gres_list;
+		new_ptr[i].gres_shared = true;
 	}
 	return new_use_ptr;
 }
 
+/* Give node node_inx of an array created by _cow_node_usage() a private
+ * copy of its gres_list, so that its gres state can be modified */
+static void _cow_node_gres(struct node_use_record *node_usage, int node_inx,
+			   cow_stats_t *stats)
+{
+	if (!node_usage[node_inx].gres_shared)
+		return;
+
+	node_usage[node_inx].gres_list =
+		gres_plugin_node_state_dup(node_usage[node_inx].gres_list);
+	node_usage[node_inx].gres_shared = false;
+	stats->gres_nodes++;
+}
+
 /* delete the given row data */
 static void _destroy_row_data(struct part_row_data *row, uint16_t num_rows) {
 	uint16_t i;
@@ -395,7 +463,9 @@ static void _destroy_part_data(struct part_res_record *this_ptr)
 		this_ptr = this_ptr->next;
 		tmp->part_ptr = NULL;
 
-		if (tmp->row) {
+		if (tmp->rows_shared) {
+			xfree(tmp->row);
+		} else if (tmp->row) {
 			_destroy_row_data(tmp->row, tmp->num_rows);
 			tmp->row = NULL;
 		}
@@ -464,7 +534,8 @@ static void _destroy_node_data(struct node_use_record *node_usage,
 	xfree(node_data);
 	if (node_usage) {
 		for (i = 0; i < select_node_cnt; i++) {
-			if (node_usage[i].gres_list) {
+			if (node_usage[i].gres_list &&
+			    !node_usage[i].gres_shared) {
 				list_destroy(node_usage[i].gres_list);
 			}
 		}
@@ -477,6 +548,8 @@ static void _add_job_to_row(struct job_resources *job,
 			    struct part_row_data *r_ptr)
 {
 	/* add the job to the row_bitmap */
+	if (r_ptr->num_jobs == 0)
+		r_ptr->overlap = false;
 	if (r_ptr->row_bitmap && r_ptr->num_jobs == 0) {
 		/* if no jobs, clear the existing row_bitmap first */
 		uint32_t size = bit_size(r_ptr->row_bitmap);
@@ -514,16 +587,19 @@ static void _swap_rows(struct part_row_data *a, struct part_row_data *b)
 	tmprow.num_jobs      = a->num_jobs;
 	tmprow.job_list      = a->job_list;
 	tmprow.job_list_size = a->job_list_size;
+	tmprow.overlap       = a->overlap;
 
 	a->row_bitmap    = b->row_bitmap;
 	a->num_jobs      = b->num_jobs;
 	a->job_list      = b->job_list;
 	a->job_list_size = b->job_list_size;
+	a->overlap       = b->overlap;
 
 	b->row_bitmap    = tmprow.row_bitmap;
 	b->num_jobs      = tmprow.num_jobs;
 	b->job_list      = tmprow.job_list;
 	b->job_list_size = tmprow.job_list_size;
+	b->overlap       = tmprow.overlap;
 
 	return;
 }
@@ -574,9 +650,13 @@ static void _build_row_bitmaps(struct part_res_record *p_ptr,
 	if (!p_ptr->row)
 		return;
 
+	p_ptr->compact_time = time(NULL);
+	p_ptr->compact_needed = false;
+
 	if (p_ptr->num_rows == 1) {
 		this_row = &(p_ptr->row[0]);
 		if (this_row->num_jobs == 0) {
+			this_row->overlap = false;
 			if (this_row->row_bitmap) {
 				size = bit_size(this_row->row_bitmap);
 				bit_nclear(this_row->row_bitmap, 0, size-1);
@@ -595,6 +675,7 @@ static void _build_row_bitmaps(struct part_res_record *p_ptr,
 	if (num_jobs == 0) {
 		size = bit_size(p_ptr->row[0].row_bitmap);
 		for (i = 0; i < p_ptr->num_rows; i++) {
+			p_ptr->row[i].overlap = false;
 			if (p_ptr->row[i].row_bitmap) {
 				bit_nclear(p_ptr->row[i].row_bitmap, 0,
 					   size-1);
@@ -632,6 +713,7 @@ static void _build_row_bitmaps(struct part_res_record *p_ptr,
 			x++;
 		}
 		p_ptr->row[i].num_jobs = 0;
+		p_ptr->row[i].overlap = false;
 		if (p_ptr->row[i].row_bitmap) {
 			bit_nclear(p_ptr->row[i].row_bitmap, 0, size-1);
 		}
@@ -770,6 +852,77 @@ static void _build_row_bitmaps(struct part_res_record *p_ptr,
 }
 
 
+/*
+ * _rm_job_from_row: A job has been removed from the job_list of the given
+ *                   row, so clear its cores from the row_bitmap. Jobs
+ *                   ending are frequent, so rather than rebuilding the rows
+ *                   each time, _build_row_bitmaps() is only used if jobs in
+ *                   the row share cores, or to repack the jobs of a
+ *                   partition with several rows at most once every
+ *                   CR_ROW_COMPACT_INTERVAL seconds.
+ *
+ * IN/OUT: p_ptr   - the partition the job was removed from
+ * IN: row_inx     - the row the job was removed from
+ */
+static void _rm_job_from_row(struct part_res_record *p_ptr, uint32_t row_inx,
+			     struct job_record *job_ptr)
+{
+	struct job_resources *job = job_ptr->job_resrcs;
+	struct part_row_data *r_ptr = &(p_ptr->row[row_inx]);
+	int first_bit, last_bit, i;
+	uint32_t c, job_bit, row_bit;
+
+	if (r_ptr->overlap ||
+	    ((p_ptr->num_rows > 1) &&
+	     (difftime(time(NULL), p_ptr->compact_time) >=
+	      CR_ROW_COMPACT_INTERVAL))) {
+		_build_row_bitmaps(p_ptr, job_ptr);
+		return;
+	}
+	if (p_ptr->num_rows > 1)
+		p_ptr->compact_needed = true;
+
+	if (!r_ptr->row_bitmap)
+		return;
+	if (r_ptr->num_jobs == 0) {
+		bit_nclear(r_ptr->row_bitmap, 0,
+			   bit_size(r_ptr->row_bitmap) - 1);
+		return;
+	}
+	first_bit = bit_ffs(job->node_bitmap);
+	if (first_bit == -1)
+		return;
+	last_bit = bit_fls(job->node_bitmap);
+	for (i = first_bit, job_bit = 0; i <= last_bit; i++) {
+		if (!bit_test(job->node_bitmap, i))
+			continue;
+		row_bit = cr_get_coremap_offset(i);
+		for (c = 0; c < cr_node_num_cores[i]; c++) {
+			if (bit_test(job->core_bitmap, job_bit + c))
+				bit_clear(r_ptr->row_bitmap, row_bit + c);
+		}
+		job_bit += cr_node_num_cores[i];
+	}
+}
+
+/* Repack the rows of a job's partition if jobs were removed from them without
+ * a rebuild and CR_ROW_COMPACT_INTERVAL has passed, see _rm_job_from_row() */
+static void _compact_part_rows(struct job_record *job_ptr)
+{
+	struct part_res_record *p_ptr;
+
+	for (p_ptr = select_part_record; p_ptr; p_ptr = p_ptr->next) {
+		if (p_ptr->part_ptr != job_ptr->part_ptr)
+			continue;
+		if (p_ptr->compact_needed &&
+		    (difftime(time(NULL), p_ptr->compact_time) >=
+		     CR_ROW_COMPACT_INTERVAL))
+			_build_row_bitmaps(p_ptr, job_ptr);
+		break;
+	}
+}
+
+
 /* allocate resources to the given job
  * - add 'struct job_resources' resources to 'struct part_res_record'
  * - add job's memory requirements to 'struct node_res_record'
@@ -870,6 +1023,7 @@ static int _add_job_to_res(struct job_record *job_ptr, int action)
 			      job_ptr->job_id);
 			/* just add the job to the last row for now */
 			_add_job_to_row(job, &(p_ptr->row[p_ptr->num_rows-1]));
+			p_ptr->row[p_ptr->num_rows-1].overlap = true;
 		}
 		/* update the node state */
 		for (i = 0, n = -1; i < select_node_cnt; i++) {
@@ -1188,6 +1342,7 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 	if (action != 1) {
 		/* reconstruct rows with remaining jobs */
 		struct part_res_record *p_ptr;
+		uint32_t row_inx = 0;
 
 		if (!job_ptr->part_ptr) {
 			error("cons_res: removed job %u does not have a "
@@ -1220,6 +1375,7 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 				       "part %s row %u",
 				       job_ptr->job_id,
 				       p_ptr->part_ptr->name, i);
+				row_inx = i;
 				for (; j < p_ptr->row[i].num_jobs-1; j++) {
 					p_ptr->row[i].job_list[j] =
 						p_ptr->row[i].job_list[j+1];
@@ -1235,7 +1391,7 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 
 		if (n) {
 			/* job was found and removed, so refresh the bitmaps */
-			_build_row_bitmaps(p_ptr, job_ptr);
+			_rm_job_from_row(p_ptr, row_inx, job_ptr);
 
 			/* Adjust the node_state of all nodes affected by
 			 * the removal of this job. If all cores are now
@@ -1264,6 +1420,54 @@ static int _rm_job_from_res(struct part_res_record *part_record_ptr,
 	return SLURM_SUCCESS;
 }
 
+/*
+ * _rm_job_from_cow - remove a job from the copies of select_part_record and
+ *	select_node_usage made by _cow_part_data() and _cow_node_usage(),
+ *	first copying the row and gres data that _rm_job_from_res() will modify
+ * action is as for _rm_job_from_res()
+ */
+static int _rm_job_from_cow(struct part_res_record *part_record_ptr,
+			    struct node_use_record *node_usage,
+			    struct job_record *job_ptr, int action,
+			    cow_stats_t *stats)
+{
+	struct job_resources *job = job_ptr->job_resrcs;
+	struct part_res_record *p_ptr;
+	int first_bit, last_bit;
+	int i, n;
+
+	if (select_state_initializing || !job || !job->core_bitmap)
+		return _rm_job_from_res(part_record_ptr, node_usage, job_ptr,
+					action);
+
+	if (action != 2) {
+		first_bit = bit_ffs(job->node_bitmap);
+		if (first_bit == -1)
+			last_bit = -2;
+		else
+			last_bit =  bit_fls(job->node_bitmap);
+		for (i = first_bit, n = -1; i <= last_bit; i++) {
+			if (!bit_test(job->node_bitmap, i))
+				continue;
+			n++;
+			if (job->cpus[n] == 0)
+				continue;  /* node lost by job resize */
+			_cow_node_gres(node_usage, i, stats);
+		}
+	}
+
+	if ((action != 1) && job_ptr->part_ptr) {
+		for (p_ptr = part_record_ptr; p_ptr; p_ptr = p_ptr->next) {
+			if (p_ptr->part_ptr == job_ptr->part_ptr) {
+				_cow_part_rows(p_ptr, stats);
+				break;
+			}
+		}
+	}
+
+	return _rm_job_from_res(part_record_ptr, node_usage, job_ptr, action);
+}
+
 static int _rm_job_from_one_node(struct job_record *job_ptr,
 				 struct node_record *node_ptr)
 {
@@ -1488,6 +1692,19 @@ static int _sort_usable_nodes_dec(struct job_record *job_a,
 	return 0;
 }
 
+/* Report how much select data a will-run or preemption test had to copy */
+static void _log_cow_stats(char *caller, struct job_record *job_ptr,
+			   cow_stats_t *stats)
+{
+	if (!(select_debug_flags & DEBUG_FLAG_SELECT_TYPE))
+		return;
+
+	info("cons_res: %s: job %u copied %u bytes of partition data, "
+	     "%u bytes of node usage data and %u of %d node gres lists",
+	     caller, job_ptr->job_id, stats->part_bytes, stats->usage_bytes,
+	     stats->gres_nodes, select_node_cnt);
+}
+
 /* Allocate resources for a job now, if possible */
 static int _run_now(struct job_record *job_ptr, bitstr_t *bitmap,
 		    uint32_t min_nodes, uint32_t max_nodes,
@@ -1501,11 +1718,13 @@ static int _run_now(struct job_record *job_ptr, bitstr_t *bitmap,
 	ListIterator job_iterator, preemptee_iterator;
 	struct part_res_record *future_part;
 	struct node_use_record *future_usage;
+	cow_stats_t cow_stats;
 	bool remove_some_jobs = false;
 	uint16_t pass_count = 0;
 	uint16_t mode;
 	uint16_t tmp_cr_type = cr_type;
 
+	_compact_part_rows(job_ptr);
 	save_bitmap = bit_copy(bitmap);
 top:	orig_map = bit_copy(save_bitmap);
 
@@ -1528,13 +1747,14 @@ top:	orig_map = bit_copy(save_bitmap);
 
 	if ((rc != SLURM_SUCCESS) && preemptee_candidates) {
 		/* Remove preemptable jobs from simulated environment */
-		future_part = _dup_part_data(select_part_record);
+		memset(&cow_stats, 0, sizeof(cow_stats_t));
+		future_part = _cow_part_data(select_part_record, &cow_stats);
 		if (future_part == NULL) {
 			FREE_NULL_BITMAP(orig_map);
 			FREE_NULL_BITMAP(save_bitmap);
 			return SLURM_ERROR;
 		}
-		future_usage = _dup_node_usage(select_node_usage);
+		future_usage = _cow_node_usage(select_node_usage, &cow_stats);
 		if (future_usage == NULL) {
 			_destroy_part_data(future_part);
 			FREE_NULL_BITMAP(orig_map);
@@ -1554,8 +1774,8 @@ top:	orig_map = bit_copy(save_bitmap);
 			    (mode != PREEMPT_MODE_CANCEL))
 				continue;	/* can't remove job */
 			/* Remove preemptable job now */
-			_rm_job_from_res(future_part, future_usage,
-					 tmp_job_ptr, 0);
+			_rm_job_from_cow(future_part, future_usage,
+					 tmp_job_ptr, 0, &cow_stats);
 			bit_or(bitmap, orig_map);
 			rc = cr_job_test(job_ptr, bitmap, min_nodes,
 					 max_nodes, req_nodes,
@@ -1596,6 +1816,10 @@ top:	orig_map = bit_copy(save_bitmap);
 					  (ListCmpF)_sort_usable_nodes_dec);
 				FREE_NULL_BITMAP(orig_map);
 				list_iterator_destroy(job_iterator);
+				_log_cow_stats("_run_now", job_ptr,
+					       &cow_stats);
+				_destroy_part_data(future_part);
+				_destroy_node_data(future_usage, NULL);
 				goto top;
 			}
 		}
@@ -1630,6 +1854,7 @@ top:	orig_map = bit_copy(save_bitmap);
 			}
 		}
 
+		_log_cow_stats("_run_now", job_ptr, &cow_stats);
 		_destroy_part_data(future_part);
 		_destroy_node_data(future_usage, NULL);
 	}
@@ -1650,6 +1875,7 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 {
 	struct part_res_record *future_part;
 	struct node_use_record *future_usage;
+	cow_stats_t cow_stats;
 	struct job_record *tmp_job_ptr;
 	List cr_job_list;
 	ListIterator job_iterator, preemptee_iterator;
@@ -1685,12 +1911,13 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 
 	/* Job is still pending. Simulate termination of jobs one at a time
 	 * to determine when and where the job can start. */
-	future_part = _dup_part_data(select_part_record);
+	memset(&cow_stats, 0, sizeof(cow_stats_t));
+	future_part = _cow_part_data(select_part_record, &cow_stats);
 	if (future_part == NULL) {
 		FREE_NULL_BITMAP(orig_map);
 		return SLURM_ERROR;
 	}
-	future_usage = _dup_node_usage(select_node_usage);
+	future_usage = _cow_node_usage(select_node_usage, &cow_stats);
 	if (future_usage == NULL) {
 		_destroy_part_data(future_part);
 		FREE_NULL_BITMAP(orig_map);
@@ -1719,8 +1946,8 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 			else
 				action = 0;	/* remove cores and memory */
 			/* Remove preemptable job now */
-			_rm_job_from_res(future_part, future_usage,
-					 tmp_job_ptr, action);
+			_rm_job_from_cow(future_part, future_usage,
+					 tmp_job_ptr, action, &cow_stats);
 		} else
 			list_append(cr_job_list, tmp_job_ptr);
 	}
@@ -1754,8 +1981,8 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 				continue;	/* skip it */
 			debug2("cons_res: _will_run_test, job %u: overlap=%d",
 			       tmp_job_ptr->job_id, ovrlap);
-			_rm_job_from_res(future_part, future_usage,
-					 tmp_job_ptr, 0);
+			_rm_job_from_cow(future_part, future_usage,
+					 tmp_job_ptr, 0, &cow_stats);
 			rc = cr_job_test(job_ptr, bitmap, min_nodes,
 					 max_nodes, req_nodes,
 					 SELECT_MODE_WILL_RUN, tmp_cr_type,
@@ -1794,6 +2021,7 @@ static int _will_run_test(struct job_record *job_ptr, bitstr_t *bitmap,
 	}
 
 	list_destroy(cr_job_list);
+	_log_cow_stats("_will_run_test", job_ptr, &cow_stats);
 	_destroy_part_data(future_part);
 	_destroy_node_data(future_usage, NULL);
 	FREE_NULL_BITMAP(orig_map);
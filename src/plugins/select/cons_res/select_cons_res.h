@@ -71,6 +71,7 @@ struct part_row_data {
 	uint32_t num_jobs;		/* Number of jobs in this row */
 	struct job_resources **job_list;/* List of jobs in this row */
 	uint32_t job_list_size;		/* Size of job_list array */
+	bool overlap;			/* some jobs in this row share cores */
 };
 
 /* partition CPU allocation data */
@@ -79,6 +80,12 @@ struct part_res_record {
 	uint16_t num_rows;		/* Number of row_bitmaps */
 	struct part_record *part_ptr;   /* controller part record pointer */
 	struct part_row_data *row;	/* array of rows containing jobs */
+	time_t compact_time;		/* when the rows were last rebuilt by
+					 * _build_row_bitmaps() */
+	bool compact_needed;		/* jobs removed from the rows since */
+	bool rows_shared;		/* row_bitmap and job_list of each row
+					 * belong to the record this one was
+					 * copied from, see _cow_part_data() */
 };
 
 /* per-node resource data */
@@ -100,6 +107,9 @@ struct node_use_record {
 	List gres_list;			/* list of gres state info managed by 
 					 * plugins */
 	uint16_t node_state;		/* see node_cr_state comments */
+	bool gres_shared;		/* gres_list belongs to the record this
+					 * one was copied from, see
+					 * _cow_node_usage() */
 };
 
 extern uint32_t select_debug_flags;
@@ -156,6 +156,8 @@ static int _run_now(struct job_record *job_ptr, bitstr_t *bitmap,
 		    List *preemptee_job_list);
 static int _sort_usable_nodes_dec(struct job_record *job_a,
 				  struct job_record *job_b);
+static void _sum_switch_cpus(struct job_record *job_ptr,
+			     bitstr_t **switches_bitmap, int *switches_cpu_cnt);
 static bool _test_run_job(struct cr_record *cr_ptr, uint32_t job_id);
 static bool _test_tot_job(struct cr_record *cr_ptr, uint32_t job_id);
 static int _test_only(struct job_record *job_ptr, bitstr_t *bitmap,
@@ -1046,6 +1048,53 @@ static int _job_test(struct job_record *job_ptr, bitstr_t *bitmap,
 	return error_code;
 }
 
+/*
+ * _sum_switch_cpus - Add up the CPUs available to a job on each switch.
+ *	Leaf switches, and switches with nodes below more than one of their
+ *	descendent switches, count their nodes. Other switches add up their
+ *	descendent switches, so most nodes are only visited once rather than
+ *	once per switch level.
+ * IN job_ptr - job being considered
+ * IN switches_bitmap - usable nodes on each switch
+ * OUT switches_cpu_cnt - usable CPUs on each switch
+ */
+static void _sum_switch_cpus(struct job_record *job_ptr,
+			     bitstr_t **switches_bitmap, int *switches_cpu_cnt)
+{
+	struct switch_record *switch_ptr;
+	int i, j, first, last, level, max_level = 0;
+
+	for (j=0; j<switch_record_cnt; j++)
+		max_level = MAX(max_level, switch_record_table[j].level);
+
+	/* descendent switches are always at a lower level */
+	for (level=0; level<=max_level; level++) {
+		switch_ptr = switch_record_table;
+		for (j=0; j<switch_record_cnt; j++, switch_ptr++) {
+			if (switch_ptr->level != level)
+				continue;
+			switches_cpu_cnt[j] = 0;
+			if (switch_ptr->num_switches && switch_ptr->disjoint) {
+				for (i=0; i<switch_ptr->num_switches; i++) {
+					switches_cpu_cnt[j] += switches_cpu_cnt
+						[switch_ptr->switch_index[i]];
+				}
+				continue;
+			}
+			first = bit_ffs(switches_bitmap[j]);
+			if (first < 0)
+				continue;
+			last = bit_fls(switches_bitmap[j]);
+			for (i=first; i<=last; i++) {
+				if (bit_test(switches_bitmap[j], i)) {
+					switches_cpu_cnt[j] +=
+						_get_avail_cpus(job_ptr, i);
+				}
+			}
+		}
+	}
+}
+
 /*
  * _job_test_topo - A topology aware version of _job_test()
  * NOTE: The logic here is almost identical to that of _eval_nodes_topo() in
@@ -1149,14 +1198,7 @@ static int _job_test_topo(struct job_record *job_ptr, bitstr_t *bitmap,
 #if SELECT_DEBUG
 	debug5("_job_test_topo: phase 2");
 #endif
-	for (i = 0; i < node_record_count; i++) {
-		avail_cpus = _get_avail_cpus(job_ptr, i);
-		for (j=0; j<switch_record_cnt; j++) {
-			if (bit_test(switches_bitmap[j], i)) {
-				switches_cpu_cnt[j] += avail_cpus;
-			}
-		}
-	}
+	_sum_switch_cpus(job_ptr, switches_bitmap, switches_cpu_cnt);
 
 	/* phase 3 */
 #if SELECT_DEBUG
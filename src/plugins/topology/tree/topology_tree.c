@@ -104,6 +104,7 @@ static int  _parse_switches(void **dest, slurm_parser_enum_t type,
 			    const char *key, const char *value,
 			    const char *line, char **leftover);
 extern int  _read_topo_file(slurm_conf_switches_t **ptr_array[]);
+static void _set_disjoint(struct switch_record *switch_ptr);
 static void _validate_switches(void);
 
 
@@ -311,9 +312,16 @@ static void _validate_switches(void)
 					switch_ptr->level = -1;
 					FREE_NULL_BITMAP(switch_ptr->
 							 node_bitmap);
+					xfree(switch_ptr->switch_index);
+					switch_ptr->num_switches = 0;
 					free(child);
 					break;
 				}
+				xrealloc(switch_ptr->switch_index,
+					 sizeof(uint16_t) *
+					 (switch_ptr->num_switches + 1));
+				switch_ptr->switch_index[switch_ptr->
+							 num_switches++] = j;
 				if (switch_ptr->level == -1) {
 					switch_ptr->level = 1 +
 						switch_record_table[j].level;
@@ -341,6 +349,7 @@ static void _validate_switches(void)
 	for (i=0; i<switch_record_cnt; i++, switch_ptr++) {
 		if (switch_ptr->node_bitmap == NULL)
 			error("switch %s has no nodes", switch_ptr->name);
+		_set_disjoint(switch_ptr);
 	}
 	if (switches_bitmap) {
 		bit_not(switches_bitmap);
@@ -396,6 +405,26 @@ static void _log_switches(void)
 	}
 }
 
+/* Note if the descendent switches of a switch have no nodes in common, in
+ * which case the select plugins can sum counts over them rather than over
+ * the switch's nodes */
+static void _set_disjoint(struct switch_record *switch_ptr)
+{
+	struct switch_record *child_ptr;
+	int i, node_cnt = 0;
+
+	switch_ptr->disjoint = true;
+	if ((switch_ptr->num_switches == 0) || !switch_ptr->node_bitmap)
+		return;
+	for (i=0; i<switch_ptr->num_switches; i++) {
+		child_ptr = switch_record_table + switch_ptr->switch_index[i];
+		if (child_ptr->node_bitmap)
+			node_cnt += bit_set_count(child_ptr->node_bitmap);
+	}
+	if (node_cnt != bit_set_count(switch_ptr->node_bitmap))
+		switch_ptr->disjoint = false;
+}
+
 /* Return the index of a given switch name or -1 if not found */
 static int _get_switch_inx(const char *name)
 {
@@ -421,6 +450,7 @@ static void _free_switch_record_table(void)
 			xfree(switch_record_table[i].name);
 			xfree(switch_record_table[i].nodes);
 			xfree(switch_record_table[i].switches);
+			xfree(switch_record_table[i].switch_index);
 			FREE_NULL_BITMAP(switch_record_table[i].node_bitmap);
 		}
 		xfree(switch_record_table);
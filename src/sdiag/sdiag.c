@@ -163,6 +163,18 @@ static int _print_info(void)
 		printf("\tQueue length mean: %u\n",
 		       buf->bf_queue_len_sum / buf->bf_cycle_counter);
 	}
+	printf("\tResumed after state change: %u\n", buf->bf_resumes);
+	printf("\tRestarted after state change: %u\n", buf->bf_restarts);
+
+	printf("\nJob hash table statistics:\n");
+	printf("\tTable size:   %u\n", buf->job_hash_size);
+	printf("\tJob count:    %u\n", buf->job_hash_cnt);
+	if (buf->job_hash_size > 0) {
+		printf("\tLoad factor:  %.2f\n",
+		       (double) buf->job_hash_cnt / buf->job_hash_size);
+	}
+	printf("\tMax chain:    %u\n", buf->job_hash_max_chain);
+	printf("\tResizes:      %u\n", buf->job_hash_resizes);
 	return 0;
 }
 
@@ -281,8 +281,9 @@ _query_server(partition_info_msg_t ** part_pptr,
 							    params.nodes,
 							    show_flags);
 		} else {
-			error_code = slurm_load_node(old_node_ptr->last_update,
-						     &new_node_ptr, show_flags);
+			error_code = slurm_load_node_delta(old_node_ptr,
+							   &new_node_ptr,
+							   show_flags);
 		}
 		if (error_code == SLURM_SUCCESS)
 			slurm_free_node_info_msg(old_node_ptr);
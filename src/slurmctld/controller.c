@@ -1296,6 +1296,7 @@ static void _queue_reboot_msg(void)
 		bit_clear(avail_node_bitmap, i);
 		bit_clear(idle_node_bitmap, i);
 		node_ptr->last_response = now;
+		node_ptr->last_update = now;
 	}
 	if (reboot_agent_args != NULL) {
 		hostlist_uniq(reboot_agent_args->hostlist);
@@ -100,6 +100,14 @@
 #define TOP_PRIORITY 0xffff0000	/* large, but leave headroom for higher */
 
 #define JOB_HASH_INX(_job_id)	(_job_id % hash_table_size)
+#define JOB_HASH_OLD_INX(_job_id) (_job_id % hash_table_size_old)
+
+/* The job hash table doubles in size once it holds more than
+ * JOB_HASH_LOAD_MAX jobs per slot. Records are moved from the old table
+ * JOB_HASH_MOVE_CNT slots at a time as jobs are added or removed rather
+ * than all at once, so no single operation pays for the full rehash. */
+#define JOB_HASH_LOAD_MAX	2
+#define JOB_HASH_MOVE_CNT	16
 
 /* Change JOB_STATE_VERSION value when changing the state save format */
 #define JOB_STATE_VERSION      "VER014"
@@ -122,12 +130,22 @@ time_t last_job_update;		/* time of last update to job records */
 static uint32_t highest_prio = 0;
 static uint32_t lowest_prio  = TOP_PRIORITY;
 static int      hash_table_size = 0;
+static int      hash_table_size_old = 0;
+static int      hash_move_inx = 0;	/* next job_hash_old slot to move */
 static int      job_count = 0;		/* job's in the system */
 static uint32_t job_id_sequence = 0;	/* first job_id to assign new job */
 static struct   job_record **job_hash = NULL;
+static struct   job_record **job_hash_old = NULL; /* being moved to job_hash */
 static bool     wiki_sched = false;
 static bool     wiki2_sched = false;
 static bool     wiki_sched_test = false;
+/* Jobs are packed under a job read lock, so the nodes_cg_cache of a job may
+ * be rebuilt by several RPC threads at once */
+static pthread_mutex_t nodes_cg_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Protects last_update, pack_reason, pack_start_time and pack_cache* of job
+ * records, which are set by _job_last_update() and _pack_job_cached() under
+ * a job read lock */
+static pthread_mutex_t job_pack_state_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /* Local functions */
 static void _add_job_hash(struct job_record *job_ptr);
@@ -156,6 +174,10 @@ static void _get_batch_job_dir_ids(List batch_dirs);
 static void _job_timed_out(struct job_record *job_ptr);
 static int  _job_create(job_desc_msg_t * job_specs, int allocate, int will_run,
 			struct job_record **job_rec_ptr, uid_t submit_uid);
+static void _job_hash_grow(int new_size);
+static void _job_hash_move(int slot_cnt);
+static struct job_record **_job_hash_pptr(struct job_record *job_ptr);
+static time_t _job_last_update(struct job_record *job_ptr, time_t now);
 static void _list_delete_job(void *job_entry);
 static int  _list_find_job_id(void *job_entry, void *key);
 static int  _list_find_job_old(void *job_entry, void *key);
@@ -166,6 +188,9 @@ static uint32_t _max_switch_wait(uint32_t input_wait);
 static void _notify_srun_missing_step(struct job_record *job_ptr, int node_inx,
 				      time_t now, time_t node_boot_time);
 static int  _open_job_state_file(char **state_file);
+static void _pack_job_cached(struct job_record *job_ptr, uint16_t show_flags,
+			     Buf buffer, uint16_t protocol_version,
+			     uid_t uid, time_t pack_gen, time_t now);
 static void _pack_job_for_ckpt (struct job_record *job_ptr, Buf buffer);
 static void _pack_default_job_details(struct job_record *job_ptr,
 				      Buf buffer,
@@ -230,6 +255,7 @@ struct job_record *create_job_record(int *error_code)
 	detail_ptr = (struct job_details *)xmalloc(sizeof(struct job_details));
 
 	job_ptr->magic = JOB_MAGIC;
+	job_ptr->last_update = last_job_update;
 	job_ptr->array_task_id = (uint16_t) NO_VAL;
 	job_ptr->details = detail_ptr;
 	job_ptr->prio_factors = xmalloc(sizeof(priority_factors_object_t));
@@ -1891,11 +1917,129 @@ void _add_job_hash(struct job_record *job_ptr)
 {
 	int inx;
 
+	if (job_hash_old)
+		_job_hash_move(JOB_HASH_MOVE_CNT);
+	else if (job_count > (hash_table_size * JOB_HASH_LOAD_MAX))
+		_job_hash_grow(hash_table_size * 2);
+
 	inx = JOB_HASH_INX(job_ptr->job_id);
 	job_ptr->job_next = job_hash[inx];
 	job_hash[inx] = job_ptr;
 }
 
+/* _job_hash_grow - replace the job hash table with a larger one. Existing
+ *	records remain in job_hash_old until moved by _job_hash_move().
+ * IN new_size - slot count of the new hash table
+ * Globals: hash table updated
+ */
+static void _job_hash_grow(int new_size)
+{
+	if (new_size <= hash_table_size)
+		return;
+	if (job_hash_old)	/* finish any earlier resize first */
+		_job_hash_move(hash_table_size_old);
+
+	debug("job hash table resized from %d to %d slots, %d jobs",
+	      hash_table_size, new_size, job_count);
+	job_hash_old = job_hash;
+	hash_table_size_old = hash_table_size;
+	hash_move_inx = 0;
+	hash_table_size = new_size;
+	job_hash = (struct job_record **)
+		xmalloc(hash_table_size * sizeof(struct job_record *));
+	slurmctld_diag_stats.job_hash_resizes++;
+}
+
+/* _job_hash_move - move the records of up to slot_cnt slots of the old job
+ *	hash table into the current one, freeing the old table when done
+ * Globals: hash table updated
+ */
+static void _job_hash_move(int slot_cnt)
+{
+	struct job_record *job_ptr;
+	int inx;
+
+	while (job_hash_old && (slot_cnt-- > 0)) {
+		while ((job_ptr = job_hash_old[hash_move_inx])) {
+			job_hash_old[hash_move_inx] = job_ptr->job_next;
+			inx = JOB_HASH_INX(job_ptr->job_id);
+			job_ptr->job_next = job_hash[inx];
+			job_hash[inx] = job_ptr;
+		}
+		if (++hash_move_inx >= hash_table_size_old) {
+			xfree(job_hash_old);
+			hash_table_size_old = 0;
+			hash_move_inx = 0;
+		}
+	}
+}
+
+/* _job_hash_pptr - return a pointer to the hash table link which references
+ *	the given job record, NULL if not found
+ */
+static struct job_record **_job_hash_pptr(struct job_record *job_ptr)
+{
+	struct job_record **job_pptr;
+	int inx;
+
+	job_pptr = &job_hash[JOB_HASH_INX(job_ptr->job_id)];
+	while (*job_pptr) {
+		if (*job_pptr == job_ptr)
+			return job_pptr;
+		job_pptr = &(*job_pptr)->job_next;
+	}
+
+	if (job_hash_old) {
+		inx = JOB_HASH_OLD_INX(job_ptr->job_id);
+		if (inx < hash_move_inx)
+			return NULL;
+		job_pptr = &job_hash_old[inx];
+		while (*job_pptr) {
+			if (*job_pptr == job_ptr)
+				return job_pptr;
+			job_pptr = &(*job_pptr)->job_next;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * job_hash_stats - report job hash table statistics
+ * OUT table_size - count of slots in the job hash table
+ * OUT job_cnt - count of jobs in the job hash table
+ * OUT max_chain - length of the longest chain of jobs in any one slot
+ * NOTE: READ lock_slurmctld job before entry
+ */
+extern void job_hash_stats(uint32_t *table_size, uint32_t *job_cnt,
+			   uint32_t *max_chain)
+{
+	struct job_record *job_ptr;
+	uint32_t chain;
+	int inx;
+
+	*table_size = hash_table_size;
+	*job_cnt = 0;
+	*max_chain = 0;
+	for (inx = 0; inx < hash_table_size; inx++) {
+		chain = 0;
+		for (job_ptr = job_hash[inx]; job_ptr;
+		     job_ptr = job_ptr->job_next)
+			chain++;
+		*job_cnt += chain;
+		*max_chain = MAX(*max_chain, chain);
+	}
+	for (inx = hash_move_inx; job_hash_old && (inx < hash_table_size_old);
+	     inx++) {
+		chain = 0;
+		for (job_ptr = job_hash_old[inx]; job_ptr;
+		     job_ptr = job_ptr->job_next)
+			chain++;
+		*job_cnt += chain;
+		*max_chain = MAX(*max_chain, chain);
+	}
+}
+
 /*
  * find_job_record - return a pointer to the job record with the given job_id
  * IN job_id - requested job's id
@@ -1906,6 +2050,7 @@ void _add_job_hash(struct job_record *job_ptr)
 struct job_record *find_job_record(uint32_t job_id)
 {
 	struct job_record *job_ptr;
+	int inx;
 
 	job_ptr = job_hash[JOB_HASH_INX(job_id)];
 	while (job_ptr) {
@@ -1914,6 +2059,19 @@ struct job_record *find_job_record(uint32_t job_id)
 		job_ptr = job_ptr->job_next;
 	}
 
+	/* Not yet moved out of the old table during a resize */
+	if (job_hash_old) {
+		inx = JOB_HASH_OLD_INX(job_id);
+		if (inx < hash_move_inx)
+			return NULL;
+		job_ptr = job_hash_old[inx];
+		while (job_ptr) {
+			if (job_ptr->job_id == job_id)
+				return job_ptr;
+			job_ptr = job_ptr->job_next;
+		}
+	}
+
 	return NULL;
 }
 
@@ -1948,6 +2106,7 @@ static void _rebuild_part_name_list(struct job_record  *job_ptr)
 	}
 	list_iterator_destroy(part_iterator);
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 }
 
 /*
@@ -2014,6 +2173,7 @@ extern int kill_job_by_part_name(char *part_name)
 		}
 		if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			job_count++;
+			job_ptr->last_update = now;
 			info("Killing job_id %u on defunct partition %s",
 			     job_ptr->job_id, part_name);
 			job_ptr->job_state = JOB_NODE_FAIL | JOB_COMPLETING;
@@ -2033,6 +2193,7 @@ extern int kill_job_by_part_name(char *part_name)
 						 false);
 		} else if (pending) {
 			job_count++;
+			job_ptr->last_update = now;
 			info("Killing job_id %u on defunct partition %s",
 			     job_ptr->job_id, part_name);
 			job_ptr->job_state	= JOB_CANCELLED;
@@ -2093,6 +2254,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 		}
 		if (IS_JOB_COMPLETING(job_ptr)) {
 			job_count++;
+			job_ptr->last_update = now;
 			while ((i = bit_ffs(job_ptr->node_bitmap_cg)) >= 0) {
 				bit_clear(job_ptr->node_bitmap_cg, i);
 				job_update_cpu_cnt(job_ptr, i);
@@ -2118,6 +2280,7 @@ extern int kill_job_by_front_end_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			job_count++;
+			job_ptr->last_update = now;
 			if (job_ptr->batch_flag && job_ptr->details &&
 				   (job_ptr->details->requeue > 0)) {
 				char requeue_msg[128];
@@ -2315,6 +2478,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			if (!bit_test(job_ptr->node_bitmap_cg, bit_position))
 				continue;
 			job_count++;
+			job_ptr->last_update = now;
 			bit_clear(job_ptr->node_bitmap_cg, bit_position);
 			job_update_cpu_cnt(job_ptr, bit_position);
 			if (job_ptr->node_cnt)
@@ -2337,6 +2501,7 @@ extern int kill_running_job_by_node_name(char *node_name)
 			}
 		} else if (IS_JOB_RUNNING(job_ptr) || suspended) {
 			job_count++;
+			job_ptr->last_update = now;
 			if ((job_ptr->details) &&
 			    (job_ptr->kill_on_node_fail == 0) &&
 			    (job_ptr->node_cnt > 1)) {
@@ -2665,7 +2830,7 @@ void dump_job_desc(job_desc_msg_t * job_specs)
  *	this should be called after creating node information, but
  *	before creating any job entries. Pre-existing job entries are
  *	left unchanged.
- *	NOTE: The job hash table size does not change after initial creation.
+ *	NOTE: The job hash table is created or resized by rehash_jobs().
  * RET 0 if no error, otherwise an error code
  * global: last_job_update - time of last job table update
  *	job_list - pointer to global job list
@@ -2682,22 +2847,19 @@ int init_job_conf(void)
 }
 
 /*
- * rehash_jobs - Create or rebuild the job hash table.
+ * rehash_jobs - Create the job hash table or grow it to match MaxJobCount.
+ *	Existing records are moved into a grown table incrementally.
  * NOTE: run lock_slurmctld before entry: Read config, write job
  */
 extern void rehash_jobs(void)
 {
 	if (job_hash == NULL) {
-		hash_table_size = slurmctld_conf.max_job_cnt;
+		hash_table_size = MAX(slurmctld_conf.max_job_cnt, 1);
 		job_hash = (struct job_record **)
 			xmalloc(hash_table_size * sizeof(struct job_record *));
 	} else if (hash_table_size < (slurmctld_conf.max_job_cnt / 2)) {
-		/* If the MaxJobCount grows by too much, the hash table will
-		 * be ineffective without rebuilding. We don't presently bother
-		 * to rebuild the hash table, but cut MaxJobCount back as
-		 * needed. */
-		error ("MaxJobCount reset too high, restart slurmctld");
-		slurmctld_conf.max_job_cnt = hash_table_size;
+		/* The table would be ineffective at this MaxJobCount */
+		_job_hash_grow(slurmctld_conf.max_job_cnt);
 	}
 }
 
@@ -2731,6 +2893,7 @@ struct job_record *_job_rec_copy(struct job_record *job_ptr)
 	job_ptr_new->job_id   = save_job_id;
 	job_ptr_new->job_next = save_job_next;
 	job_ptr_new->details  = save_details;
+	job_ptr_new->pack_cache = NULL;
 	job_ptr_new->account = xstrdup(job_ptr->account);
 	job_ptr_new->alias_list = xstrdup(job_ptr->alias_list);
 	job_ptr_new->alloc_node = xstrdup(job_ptr->alloc_node);
@@ -2765,7 +2928,9 @@ struct job_record *_job_rec_copy(struct job_record *job_ptr)
 		job_ptr_new->node_bitmap = bit_copy(job_ptr->node_bitmap);
 	if (job_ptr->node_bitmap_cg)
 		job_ptr_new->node_bitmap_cg = bit_copy(job_ptr->node_bitmap_cg);
+	job_ptr_new->node_bitmap_cg_cache = NULL;
 	job_ptr_new->nodes_completing = xstrdup(job_ptr->nodes_completing);
+	job_ptr_new->nodes_cg_cache = NULL;
 	job_ptr_new->partition = xstrdup(job_ptr->partition);
 	job_ptr_new->part_ptr_list = part_list_copy(job_ptr->part_ptr_list);
 	if (job_ptr->prio_factors) {
@@ -3054,6 +3219,7 @@ extern int job_allocate(job_desc_msg_t * job_specs, int immediate,
 	}
 	if (!test_only) {
 		last_job_update = now;
+		job_ptr->last_update = now;
 		slurm_sched_schedule();	/* work for external scheduler */
 	}
 
@@ -3153,6 +3319,7 @@ extern int job_fail(uint32_t job_id)
 		} else
 			job_ptr->end_time       = now;
 		last_job_update                 = now;
+		job_ptr->last_update = now;
 		job_ptr->job_state = JOB_FAILED | JOB_COMPLETING;
 		job_ptr->exit_code = 1;
 		job_ptr->state_reason = FAIL_LAUNCH;
@@ -3265,6 +3432,7 @@ extern int job_signal(uint32_t job_id, uint16_t signal, uint16_t flags,
 
 	if (IS_JOB_PENDING(job_ptr) && (signal == SIGKILL)) {
 		last_job_update		= now;
+		job_ptr->last_update = now;
 		job_ptr->job_state	= JOB_CANCELLED;
 		job_ptr->start_time	= now;
 		job_ptr->end_time	= now;
@@ -3280,6 +3448,7 @@ extern int job_signal(uint32_t job_id, uint16_t signal, uint16_t flags,
 		job_term_state = JOB_CANCELLED;
 	if (IS_JOB_SUSPENDED(job_ptr) &&  (signal == SIGKILL)) {
 		last_job_update         = now;
+		job_ptr->last_update = now;
 		job_ptr->end_time       = job_ptr->suspend_time;
 		job_ptr->tot_sus_time  += difftime(now, job_ptr->suspend_time);
 		job_ptr->job_state      = job_term_state | JOB_COMPLETING;
@@ -3298,6 +3467,7 @@ extern int job_signal(uint32_t job_id, uint16_t signal, uint16_t flags,
 			job_ptr->time_last_active	= now;
 			job_ptr->end_time		= now;
 			last_job_update			= now;
+			job_ptr->last_update = now;
 			job_ptr->job_state = job_term_state | JOB_COMPLETING;
 			build_cg_bitmap(job_ptr);
 			job_completion_logger(job_ptr, false);
@@ -3490,6 +3660,7 @@ extern int job_complete(uint32_t job_id, uid_t uid, bool requeue,
 	}
 
 	last_job_update = now;
+	job_ptr->last_update = now;
 	if (job_comp_flag) {	/* job was running */
 		build_cg_bitmap(job_ptr);
 		deallocate_nodes(job_ptr, false, suspended, false);
@@ -5307,6 +5478,7 @@ void job_time_limit(void)
 		if (job_ptr->time_limit != INFINITE) {
 			if (job_ptr->end_time <= over_run) {
 				last_job_update = now;
+				job_ptr->last_update = now;
 				info("Time limit exhausted for JobId=%u",
 				     job_ptr->job_id);
 				_job_timed_out(job_ptr);
@@ -5328,6 +5500,7 @@ void job_time_limit(void)
 
 		if (resv_status != SLURM_SUCCESS) {
 			last_job_update = now;
+			job_ptr->last_update = now;
 			info("Reservation ended for JobId=%u",
 			     job_ptr->job_id);
 			_job_timed_out(job_ptr);
@@ -5346,6 +5519,7 @@ void job_time_limit(void)
 
 		if (job_ptr->state_reason == FAIL_TIMEOUT) {
 			last_job_update = now;
+			job_ptr->last_update = now;
 			_job_timed_out(job_ptr);
 			xfree(job_ptr->state_desc);
 			continue;
@@ -5533,14 +5707,12 @@ static void _list_delete_job(void *job_entry)
 	job_ptr->magic = 0;	/* make sure we don't delete record twice */
 
 	/* Remove the record from the hash table */
-	job_pptr = &job_hash[JOB_HASH_INX(job_ptr->job_id)];
-	while ((job_pptr != NULL) &&
-	       ((job_ptr = *job_pptr) != (struct job_record *) job_entry)) {
-		job_pptr = &job_ptr->job_next;
-	}
+	job_pptr = _job_hash_pptr(job_ptr);
 	if (job_pptr == NULL)
 		fatal("job hash error");
 	*job_pptr = job_ptr->job_next;
+	if (job_hash_old)
+		_job_hash_move(JOB_HASH_MOVE_CNT);
 
 	delete_job_details(job_ptr);
 	xfree(job_ptr->account);
@@ -5562,8 +5734,11 @@ static void _list_delete_job(void *job_entry)
 	xfree(job_ptr->node_addr);
 	FREE_NULL_BITMAP(job_ptr->node_bitmap);
 	FREE_NULL_BITMAP(job_ptr->node_bitmap_cg);
+	FREE_NULL_BITMAP(job_ptr->node_bitmap_cg_cache);
 	xfree(job_ptr->nodes);
+	xfree(job_ptr->nodes_cg_cache);
 	xfree(job_ptr->nodes_completing);
+	xfree(job_ptr->pack_cache);
 	xfree(job_ptr->partition);
 	FREE_NULL_LIST(job_ptr->part_ptr_list);
 	xfree(job_ptr->priority_array);
@@ -5657,6 +5832,10 @@ static int _list_find_job_old(void *job_entry, void *key)
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN last_update - if show_flags includes SHOW_DELTA, pack only jobs changed
+ *	since this time (all jobs if partitions changed) followed by the IDs
+ *	of all jobs otherwise packed
+ * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
  * NOTE: change _unpack_job_desc_msg() in common/slurm_protocol_pack.c
@@ -5664,18 +5843,22 @@ static int _list_find_job_old(void *job_entry, void *key)
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version)
+			  time_t last_update, uint16_t protocol_version)
 {
 	ListIterator job_iterator;
 	struct job_record *job_ptr;
 	uint32_t jobs_packed = 0, tmp_offset;
+	uint32_t *job_ids = NULL, job_id_cnt = 0;
+	bool delta_skip = false;
 	Buf buffer;
-	time_t min_age = 0, now = time(NULL);
+	time_t min_age = 0, now = time(NULL), pack_gen;
 
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
 
 	buffer = init_buf(BUF_SIZE);
+	/* Packed records are invalid after partition or node changes */
+	pack_gen = MAX(last_part_update, slurmctld_conf.last_update);
 
 	/* write message body header : size and time */
 	/* put in a place holder job record count of 0 for now */
@@ -5685,15 +5868,23 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	if (slurmctld_conf.min_job_age > 0)
 		min_age = now  - slurmctld_conf.min_job_age;
 
+	if (show_flags & SHOW_DELTA) {
+		job_ids = xmalloc(sizeof(uint32_t) *
+				  (list_count(job_list) + 1));
+		/* Job visibility depends upon partitions, so send every
+		 * job if they changed since the client's last update */
+		if (last_update > last_part_update)
+			delta_skip = true;
+	}
+
 	/* write individual job records */
-	part_filter_set(uid);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		xassert (job_ptr->magic == JOB_MAGIC);
 
 		if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
 		    (job_ptr->part_ptr) &&
-		    (job_ptr->part_ptr->flags & PART_FLAG_HIDDEN))
+		    !part_is_visible(job_ptr->part_ptr, uid))
 			continue;
 
 		if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
@@ -5709,12 +5900,23 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 		if ((filter_uid != NO_VAL) && (filter_uid != job_ptr->user_id))
 			continue;
 
-		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
+		if (job_ids) {
+			job_ids[job_id_cnt++] = job_ptr->job_id;
+			if (delta_skip &&
+			    (_job_last_update(job_ptr, now) < last_update))
+				continue;	/* client has this record */
+		}
+		_pack_job_cached(job_ptr, show_flags, buffer, protocol_version,
+				 uid, pack_gen, now);
 		jobs_packed++;
 	}
-	part_filter_clear();
 	list_iterator_destroy(job_iterator);
 
+	if (job_ids) {
+		pack32_array(job_ids, job_id_cnt, buffer);
+		xfree(job_ids);
+	}
+
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
 	set_buf_offset(buffer, 0);
@@ -5725,6 +5927,91 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 	buffer_ptr[0] = xfer_buf_data(buffer);
 }
 
+/* Return the time of a job's last update for delta RPCs and the reuse of
+ * packed job records. A job's reason and expected start time are set in
+ * many places by the schedulers and select plugins, often without other
+ * changes, so a change of either since the last check counts as an update
+ * now.
+ * NOTE: READ lock_slurmctld job before entry */
+static time_t _job_last_update(struct job_record *job_ptr, time_t now)
+{
+	time_t last_update;
+
+	slurm_mutex_lock(&job_pack_state_lock);
+	if ((job_ptr->pack_reason != job_ptr->state_reason) ||
+	    (job_ptr->pack_start_time != job_ptr->start_time)) {
+		job_ptr->pack_reason = job_ptr->state_reason;
+		job_ptr->pack_start_time = job_ptr->start_time;
+		job_ptr->last_update = now;
+	}
+	last_update = job_ptr->last_update;
+	slurm_mutex_unlock(&job_pack_state_lock);
+
+	return last_update;
+}
+
+/* Pack a job's record, reusing the bytes packed for a previous request
+ * with the same options if neither the job (see _job_last_update()) nor
+ * partitions or configuration (pack_gen) have changed since. Records updated
+ * in the current second are not kept, as a later change within that second
+ * would leave the time stamps unchanged.
+ * NOTE: READ lock_slurmctld config, job and partition before entry */
+static void _pack_job_cached(struct job_record *job_ptr, uint16_t show_flags,
+			     Buf buffer, uint16_t protocol_version,
+			     uid_t uid, time_t pack_gen, time_t now)
+{
+	time_t begin_time = 0, job_update;
+	uint32_t offset, size;
+
+	if (show_flags & SHOW_DETAIL2) {	/* batch script, owner only */
+		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
+		return;
+	}
+	if (job_ptr->details)
+		begin_time = job_ptr->details->begin_time;
+	job_update = _job_last_update(job_ptr, now);
+	if ((job_update >= now) || (pack_gen >= now) ||
+	    (!job_ptr->start_time && (begin_time > now))) {
+		/* Changed too recently or the packed expected start time
+		 * depends upon the current time */
+		pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
+		return;
+	}
+
+	slurm_mutex_lock(&job_pack_state_lock);
+	if (job_ptr->pack_cache &&
+	    (job_ptr->pack_cache_time    == job_update) &&
+	    (job_ptr->pack_cache_gen     == pack_gen) &&
+	    (job_ptr->pack_cache_flags   == show_flags) &&
+	    (job_ptr->pack_cache_version == protocol_version)) {
+		size = job_ptr->pack_cache_size;
+		if (remaining_buf(buffer) < size) {
+			buffer->size += (size + BUF_SIZE);
+			xrealloc(buffer->head, buffer->size);
+		}
+		memcpy(&buffer->head[buffer->processed], job_ptr->pack_cache,
+		       size);
+		buffer->processed += size;
+		slurm_mutex_unlock(&job_pack_state_lock);
+		return;
+	}
+	slurm_mutex_unlock(&job_pack_state_lock);
+
+	offset = get_buf_offset(buffer);
+	pack_job(job_ptr, show_flags, buffer, protocol_version, uid);
+	size = get_buf_offset(buffer) - offset;
+
+	slurm_mutex_lock(&job_pack_state_lock);
+	xrealloc(job_ptr->pack_cache, size);
+	memcpy(job_ptr->pack_cache, &buffer->head[offset], size);
+	job_ptr->pack_cache_size    = size;
+	job_ptr->pack_cache_time    = job_update;
+	job_ptr->pack_cache_gen     = pack_gen;
+	job_ptr->pack_cache_flags   = show_flags;
+	job_ptr->pack_cache_version = protocol_version;
+	slurm_mutex_unlock(&job_pack_state_lock);
+}
+
 /*
  * pack_one_job - dump information for one jobs in
  *	machine independent form (for network transmission)
@@ -5862,10 +6149,13 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 		if (!IS_JOB_COMPLETING(dump_job_ptr))
 			packstr(dump_job_ptr->nodes, buffer);
 		else {
-			nodelist =
-				bitmap2node_name(dump_job_ptr->node_bitmap_cg);
+			slurm_mutex_lock(&nodes_cg_cache_lock);
+			nodelist = bitmap2node_name_cache(
+					dump_job_ptr->node_bitmap_cg,
+					&dump_job_ptr->node_bitmap_cg_cache,
+					&dump_job_ptr->nodes_cg_cache);
 			packstr(nodelist, buffer);
-			xfree(nodelist);
+			slurm_mutex_unlock(&nodes_cg_cache_lock);
 		}
 
 		if (!IS_JOB_PENDING(dump_job_ptr) && dump_job_ptr->part_ptr)
@@ -5987,10 +6277,13 @@ void pack_job(struct job_record *dump_job_ptr, uint16_t show_flags, Buf buffer,
 		if (!IS_JOB_COMPLETING(dump_job_ptr))
 			packstr(dump_job_ptr->nodes, buffer);
 		else {
-			nodelist =
-				bitmap2node_name(dump_job_ptr->node_bitmap_cg);
+			slurm_mutex_lock(&nodes_cg_cache_lock);
+			nodelist = bitmap2node_name_cache(
+					dump_job_ptr->node_bitmap_cg,
+					&dump_job_ptr->node_bitmap_cg_cache,
+					&dump_job_ptr->nodes_cg_cache);
 			packstr(nodelist, buffer);
-			xfree(nodelist);
+			slurm_mutex_unlock(&nodes_cg_cache_lock);
 		}
 
 		if (!IS_JOB_PENDING(dump_job_ptr) && dump_job_ptr->part_ptr)
@@ -6226,6 +6519,7 @@ void purge_old_job(void)
 			job_ptr->end_time	= now;
 			job_completion_logger(job_ptr, false);
 			last_job_update		= now;
+			job_ptr->last_update = now;
 			srun_allocate_abort(job_ptr);
 		}
 	}
@@ -6383,6 +6677,7 @@ void reset_job_bitmaps(void)
 			error("select_g_select_nodeinfo_set(%u): %m",
 			      job_ptr->job_id);
 		}
+		job_ptr->last_update = now;
 	}
 	list_iterator_destroy(job_iterator);
 
@@ -6759,6 +7054,7 @@ int update_job(job_desc_msg_t * job_specs, uid_t uid)
 	if (detail_ptr)
 		mc_ptr = detail_ptr->mc_ptr;
 	last_job_update = now;
+	job_ptr->last_update = now;
 
 	if (job_specs->account) {
 		if (!IS_JOB_PENDING(job_ptr))
@@ -9058,6 +9354,7 @@ void job_fini (void)
 		job_list = NULL;
 	}
 	xfree(job_hash);
+	xfree(job_hash_old);
 }
 
 /* log the completion of the specified job */
@@ -9409,6 +9706,7 @@ static int _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp)
 			continue;
 
 		node_ptr->sus_job_cnt++;
+		node_ptr->last_update = now;
 		if (node_ptr->run_job_cnt)
 			(node_ptr->run_job_cnt)--;
 		else {
@@ -9442,6 +9740,7 @@ static int _suspend_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		}
 	}
 	last_job_update = last_node_update = now;
+	job_ptr->last_update = now;
 	return rc;
 }
 
@@ -9456,6 +9755,7 @@ static int _resume_job_nodes(struct job_record *job_ptr, bool indf_susp)
 	int i, rc = SLURM_SUCCESS;
 	struct node_record *node_ptr = node_record_table_ptr;
 	uint16_t node_flags;
+	time_t now = time(NULL);
 
 	if ((rc = select_g_job_resume(job_ptr, indf_susp)) != SLURM_SUCCESS)
 		return rc;
@@ -9488,8 +9788,10 @@ static int _resume_job_nodes(struct job_record *job_ptr, bool indf_susp)
 		bit_clear(idle_node_bitmap, i);
 		node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 		node_ptr->node_state = NODE_STATE_ALLOCATED | node_flags;
+		node_ptr->last_update = now;
 	}
-	last_job_update = last_node_update = time(NULL);
+	last_job_update = last_node_update = now;
+	job_ptr->last_update = now;
 	return rc;
 }
 
@@ -9707,6 +10009,7 @@ extern int job_requeue (uid_t uid, uint32_t job_id, slurm_fd_t conn_fd,
 
 	slurm_sched_requeue(job_ptr, "Job requeued by user/admin");
 	last_job_update = now;
+	job_ptr->last_update = now;
 
 	if (IS_JOB_SUSPENDED(job_ptr)) {
 		enum job_states suspend_job_state = job_ptr->job_state;
@@ -9899,6 +10202,8 @@ extern int job_hold_by_qos_id(uint32_t qos_id)
 			}
 			job_ptr->qos_ptr = NULL;
 		}
+		/* The QOS name packed for the job changes */
+		job_ptr->last_update = last_job_update = time(NULL);
 
 		if (IS_JOB_FINISHED(job_ptr))
 			continue;
@@ -9982,6 +10287,7 @@ extern int update_job_account(char *module, struct job_record *job_ptr,
 	job_ptr->assoc_id = assoc_rec.id;
 
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 
 	return SLURM_SUCCESS;
 }
@@ -10046,6 +10352,7 @@ extern int update_job_wckey(char *module, struct job_record *job_ptr,
 	}
 
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 
 	return SLURM_SUCCESS;
 }
@@ -10174,6 +10481,7 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 		info("checkpoint_op %u of %u.%u complete, rc=%d",
 		     ckpt_ptr->op, ckpt_ptr->job_id, ckpt_ptr->step_id, rc);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	} else {		/* operate on all of a job's steps */
 		int update_rc = -2;
 		ListIterator step_iterator;
@@ -10206,8 +10514,10 @@ extern int job_checkpoint(checkpoint_msg_t *ckpt_ptr, uid_t uid,
 			rc = MAX(rc, update_rc);
 			xfree(image_dir);
 		}
-		if (update_rc != -2)	/* some work done */
+		if (update_rc != -2) {	/* some work done */
 			last_job_update = time(NULL);
+			job_ptr->last_update = last_job_update;
+		}
 		list_iterator_destroy (step_iterator);
 	}
 
@@ -10619,6 +10929,7 @@ extern int job_restart(checkpoint_msg_t *ckpt_ptr, uid_t uid, slurm_fd_t conn_fd
 		image_dir = NULL;	/* Nothing left to xfree */
 
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
  unpack_error:
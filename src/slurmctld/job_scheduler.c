@@ -80,11 +80,19 @@
 #define _DEBUG 0
 #define MAX_RETRIES 10
 
+/* Entry in the main scheduler's priority queue. The sequence number
+ * preserves job list order among records of equal priority. */
+typedef struct sched_queue_rec {
+	job_queue_rec_t rec;
+	uint32_t seq;
+} sched_queue_rec_t;
+
 static char **	_build_env(struct job_record *job_ptr);
 static void	_depend_list_del(void *dep_ptr);
 static void	_feature_list_delete(void *x);
 static void	_job_queue_append(List job_queue, struct job_record *job_ptr,
 				  struct part_record *part_ptr);
+static void	_job_queue_build(List job_queue, bool clear_start);
 static void	_job_queue_rec_del(void *x);
 static bool	_job_runnable_test1(struct job_record *job_ptr,
 				    bool clear_start);
@@ -92,11 +100,23 @@ static bool	_job_runnable_test2(struct job_record *job_ptr);
 static void *	_run_epilog(void *arg);
 static void *	_run_prolog(void *arg);
 static bool	_scan_depend(List dependency_list, uint32_t job_id);
+static int	_sched_queue_cmp(sched_queue_rec_t *rec1,
+				 sched_queue_rec_t *rec2);
+static void	_sched_queue_heapify(void);
+static bool	_sched_queue_pop(job_queue_rec_t *job_queue_rec);
+static void	_sched_queue_sift_down(int inx);
 static int	_valid_feature_list(uint32_t job_id, List feature_list);
 static int	_valid_node_feature(char *feature);
 
 static int	save_last_part_update = 0;
 
+/* Binary heap of pending job:partition pairs used by schedule(), highest
+ * priority first. The array is retained between scheduling passes and only
+ * grows, so building the queue does not allocate memory for each job. */
+static sched_queue_rec_t *sched_queue = NULL;
+static int	sched_queue_cnt = 0;
+static int	sched_queue_size = 0;
+
 extern diag_stats_t slurmctld_diag_stats;
 
 /*
@@ -129,12 +149,29 @@ static List _build_user_job_list(uint32_t user_id, char* job_name)
 	return job_queue;
 }
 
+/* Add a job:partition pair to job_queue or, if job_queue is NULL, to the
+ * (not yet heap ordered) sched_queue array */
 static void _job_queue_append(List job_queue, struct job_record *job_ptr,
 			      struct part_record *part_ptr)
 {
 	job_queue_rec_t *job_queue_rec;
 
+	if (job_queue == NULL) {
+		if (sched_queue_cnt >= sched_queue_size) {
+			sched_queue_size = MAX(sched_queue_size * 2, 1024);
+			xrealloc(sched_queue, sizeof(sched_queue_rec_t) *
+					      sched_queue_size);
+		}
+		sched_queue[sched_queue_cnt].rec.job_id   = job_ptr->job_id;
+		sched_queue[sched_queue_cnt].rec.job_ptr  = job_ptr;
+		sched_queue[sched_queue_cnt].rec.part_ptr = part_ptr;
+		sched_queue[sched_queue_cnt].seq = sched_queue_cnt;
+		sched_queue_cnt++;
+		return;
+	}
+
 	job_queue_rec = xmalloc(sizeof(job_queue_rec_t));
+	job_queue_rec->job_id   = job_ptr->job_id;
 	job_queue_rec->job_ptr  = job_ptr;
 	job_queue_rec->part_ptr = part_ptr;
 	list_append(job_queue, job_queue_rec);
@@ -213,11 +250,21 @@ static bool _job_runnable_test2(struct job_record *job_ptr)
 extern List build_job_queue(bool clear_start)
 {
 	List job_queue;
+
+	job_queue = list_create(_job_queue_rec_del);
+	_job_queue_build(job_queue, clear_start);
+
+	return job_queue;
+}
+
+/* Add every runnable job:partition pair to job_queue or, if job_queue is
+ * NULL, to the sched_queue array */
+static void _job_queue_build(List job_queue, bool clear_start)
+{
 	ListIterator job_iterator, part_iterator;
 	struct job_record *job_ptr = NULL;
 	struct part_record *part_ptr;
 
-	job_queue = list_create(_job_queue_rec_del);
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = (struct job_record *) list_next(job_iterator))) {
 		if (!_job_runnable_test1(job_ptr, clear_start))
@@ -256,8 +303,64 @@ extern List build_job_queue(bool clear_start)
 		}
 	}
 	list_iterator_destroy(job_iterator);
+}
 
-	return job_queue;
+/* Order sched_queue records by sort_job_queue2(), then by job list order */
+static int _sched_queue_cmp(sched_queue_rec_t *rec1, sched_queue_rec_t *rec2)
+{
+	int rc = sort_job_queue2(&rec1->rec, &rec2->rec);
+
+	if (rc)
+		return rc;
+	if (rec1->seq < rec2->seq)
+		return -1;
+	if (rec1->seq > rec2->seq)
+		return 1;
+	return 0;
+}
+
+/* Restore heap order for the sched_queue subtree rooted at inx */
+static void _sched_queue_sift_down(int inx)
+{
+	sched_queue_rec_t tmp_rec;
+	int child;
+
+	while ((child = (inx * 2) + 1) < sched_queue_cnt) {
+		if (((child + 1) < sched_queue_cnt) &&
+		    (_sched_queue_cmp(&sched_queue[child + 1],
+				      &sched_queue[child]) < 0))
+			child++;
+		if (_sched_queue_cmp(&sched_queue[inx],
+				     &sched_queue[child]) <= 0)
+			break;
+		tmp_rec = sched_queue[inx];
+		sched_queue[inx] = sched_queue[child];
+		sched_queue[child] = tmp_rec;
+		inx = child;
+	}
+}
+
+/* Put the sched_queue array into heap order, O(n) */
+static void _sched_queue_heapify(void)
+{
+	int inx;
+
+	for (inx = (sched_queue_cnt / 2) - 1; inx >= 0; inx--)
+		_sched_queue_sift_down(inx);
+}
+
+/* Remove the highest priority record from sched_queue, O(log n)
+ * OUT job_queue_rec - the record removed
+ * RET false if the queue is empty */
+static bool _sched_queue_pop(job_queue_rec_t *job_queue_rec)
+{
+	if (sched_queue_cnt == 0)
+		return false;
+
+	*job_queue_rec = sched_queue[0].rec;
+	sched_queue[0] = sched_queue[--sched_queue_cnt];
+	_sched_queue_sift_down(0);
+	return true;
 }
 
 /*
@@ -548,6 +651,7 @@ next_part:		part_ptr = (struct part_record *)
 			info("sched: JobId=%u has invalid account",
 			     job_ptr->job_id);
 			last_job_update = now;
+			job_ptr->last_update = now;
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -579,6 +683,7 @@ next_part:		part_ptr = (struct part_record *)
 		job_ptr->details->exc_node_bitmap = orig_exc_bitmap;
 		if (error_code == SLURM_SUCCESS) {
 			last_job_update = now;
+			job_ptr->last_update = now;
 			info("sched: Allocate JobId=%u NodeList=%s #CPUs=%u",
 			     job_ptr->job_id, job_ptr->nodes,
 			     job_ptr->total_cpus);
@@ -620,16 +725,16 @@ send_reply:
  * RET count of jobs scheduled
  * Note: We re-build the queue every time. Jobs can not only be added
  *	or removed from the queue, but have their priority or partition
- *	changed with the update_job RPC. In general nodes will be in priority
- *	order (by submit time), so the sorting should be pretty fast.
+ *	changed with the update_job RPC. The queue is a binary heap held in
+ *	a reused array, built in linear time, so scheduling can begin without
+ *	fully sorting it and each job removed costs O(log n).
  */
 extern int schedule(uint32_t job_limit)
 {
 	ListIterator job_iterator = NULL, part_iterator = NULL;
-	List job_queue = NULL;
 	int error_code, failed_part_cnt = 0, job_cnt = 0, i;
 	uint32_t job_depth = 0;
-	job_queue_rec_t *job_queue_rec;
+	job_queue_rec_t job_queue_rec;
 	struct job_record *job_ptr = NULL;
 	struct part_record *part_ptr, **failed_parts = NULL;
 	bitstr_t *save_avail_node_bitmap;
@@ -744,8 +849,8 @@ extern int schedule(uint32_t job_limit)
 	 * If we are doing FIFO scheduling, use the job records right off the
 	 * job list.
 	 *
-	 * If a job is submitted to multiple partitions then build_job_queue()
-	 * will return a separate record for each job:partition pair.
+	 * If a job is submitted to multiple partitions then _job_queue_build()
+	 * will add a separate record for each job:partition pair.
 	 *
 	 * In both cases, we test each partition associated with the job.
 	 */
@@ -753,8 +858,10 @@ extern int schedule(uint32_t job_limit)
 		slurmctld_diag_stats.schedule_queue_len = list_count(job_list);
 		job_iterator = list_iterator_create(job_list);
 	} else {
-		job_queue = build_job_queue(false);
-		slurmctld_diag_stats.schedule_queue_len = list_count(job_queue);
+		sched_queue_cnt = 0;
+		_job_queue_build(NULL, false);
+		_sched_queue_heapify();
+		slurmctld_diag_stats.schedule_queue_len = sched_queue_cnt;
 	}
 	while (1) {
 		if (fifo_sched) {
@@ -786,13 +893,10 @@ next_part:			part_ptr = (struct part_record *)
 					continue;
 			}
 		} else {
-			job_queue_rec = list_pop_bottom(job_queue,
-							sort_job_queue2);
-			if (!job_queue_rec)
+			if (!_sched_queue_pop(&job_queue_rec))
 				break;
-			job_ptr  = job_queue_rec->job_ptr;
-			part_ptr = job_queue_rec->part_ptr;
-			xfree(job_queue_rec);
+			job_ptr  = job_queue_rec.job_ptr;
+			part_ptr = job_queue_rec.part_ptr;
 			if (!IS_JOB_PENDING(job_ptr))
 				continue;  /* started in other partition */
 			job_ptr->part_ptr = part_ptr;
@@ -913,6 +1017,7 @@ next_part:			part_ptr = (struct part_record *)
 			info("sched: JobId=%u has invalid account",
 			     job_ptr->job_id);
 			last_job_update = time(NULL);
+			job_ptr->last_update = last_job_update;
 			job_ptr->state_reason = FAIL_ACCOUNT;
 			xfree(job_ptr->state_desc);
 			continue;
@@ -976,6 +1081,7 @@ next_part:			part_ptr = (struct part_record *)
 			/* job initiated */
 			debug3("sched: JobId=%u initiated", job_ptr->job_id);
 			last_job_update = now;
+			job_ptr->last_update = now;
 #ifdef HAVE_BG
 			select_g_select_jobinfo_get(job_ptr->select_jobinfo,
 						    SELECT_JOBDATA_IONODES,
@@ -1014,6 +1120,7 @@ next_part:			part_ptr = (struct part_record *)
 			     job_ptr->job_id, slurm_strerror(error_code));
 			if (!wiki_sched) {
 				last_job_update = now;
+				job_ptr->last_update = now;
 				job_ptr->job_state = JOB_FAILED;
 				job_ptr->exit_code = 1;
 				job_ptr->state_reason = FAIL_BAD_CONSTRAINTS;
@@ -1035,7 +1142,7 @@ next_part:			part_ptr = (struct part_record *)
 		if (part_iterator)
 			list_iterator_destroy(part_iterator);
 	} else {
-		FREE_NULL_LIST(job_queue);
+		sched_queue_cnt = 0;	/* records now stale */
 	}
 	unlock_slurmctld(job_write_lock);
 	END_TIMER2("schedule");
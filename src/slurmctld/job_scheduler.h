@@ -45,6 +45,7 @@
 #include "src/slurmctld/slurmctld.h"
 
 typedef struct job_queue_rec {
+	uint32_t job_id;	/* to revalidate job_ptr after yielding locks */
 	struct job_record *job_ptr;
 	struct part_record *part_ptr;
 } job_queue_rec_t;
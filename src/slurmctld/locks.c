@@ -52,8 +52,15 @@
 #include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 
-static pthread_mutex_t locks_mutex = PTHREAD_MUTEX_INITIALIZER;
-static pthread_cond_t locks_cond = PTHREAD_COND_INITIALIZER;
+/* Each entity has its own mutex and condition variable so that activity on
+ * one data structure (e.g. a job write lock) neither contends on the mutex
+ * nor wakes up threads waiting to lock an unrelated data structure. */
+static pthread_mutex_t locks_mutex[ENTITY_COUNT] = {
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER,
+	PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER };
+static pthread_cond_t locks_cond[ENTITY_COUNT] = {
+	PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER };
 static pthread_mutex_t state_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 static slurmctld_lock_flags_t slurmctld_locks;
@@ -190,7 +197,7 @@ static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
 {
 	bool success = true;
 
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&locks_mutex[datatype]);
 	while (1) {
 		if ((slurmctld_locks.entity[write_wait_lock(datatype)] == 0) &&
 		    (slurmctld_locks.entity[write_lock(datatype)] == 0)) {
@@ -200,22 +207,25 @@ static bool _wr_rdlock(lock_datatype_t datatype, bool wait_lock)
 			success = false;
 			break;
 		} else {	/* wait for state change and retry */
-			pthread_cond_wait(&locks_cond, &locks_mutex);
+			pthread_cond_wait(&locks_cond[datatype],
+					  &locks_mutex[datatype]);
 			if (kill_thread)
 				pthread_exit(NULL);
 		}
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurm_mutex_unlock(&locks_mutex[datatype]);
 	return success;
 }
 
 /* _wr_rdunlock - Issue a read unlock on the specified data type */
 static void _wr_rdunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&locks_mutex[datatype]);
 	slurmctld_locks.entity[read_lock(datatype)]--;
-	pthread_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	/* Only writers wait for readers, and only for the last one */
+	if (slurmctld_locks.entity[read_lock(datatype)] == 0)
+		pthread_cond_broadcast(&locks_cond[datatype]);
+	slurm_mutex_unlock(&locks_mutex[datatype]);
 }
 
 /* _wr_wrlock - Issue a write lock on the specified data type */
@@ -223,7 +233,7 @@ static bool _wr_wrlock(lock_datatype_t datatype, bool wait_lock)
 {
 	bool success = true;
 
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&locks_mutex[datatype]);
 	slurmctld_locks.entity[write_wait_lock(datatype)]++;
 
 	while (1) {
@@ -234,41 +244,57 @@ static bool _wr_wrlock(lock_datatype_t datatype, bool wait_lock)
 			break;
 		} else if (!wait_lock) {
 			slurmctld_locks.entity[write_wait_lock(datatype)]--;
+			/* readers may be waiting on write_wait_lock */
+			pthread_cond_broadcast(&locks_cond[datatype]);
 			success = false;
 			break;
 		} else {	/* wait for state change and retry */
-			pthread_cond_wait(&locks_cond, &locks_mutex);
+			pthread_cond_wait(&locks_cond[datatype],
+					  &locks_mutex[datatype]);
 			if (kill_thread)
 				pthread_exit(NULL);
 		}
 	}
-	slurm_mutex_unlock(&locks_mutex);
+	slurm_mutex_unlock(&locks_mutex[datatype]);
 	return success;
 }
 
 /* _wr_wrunlock - Issue a write unlock on the specified data type */
 static void _wr_wrunlock(lock_datatype_t datatype)
 {
-	slurm_mutex_lock(&locks_mutex);
+	slurm_mutex_lock(&locks_mutex[datatype]);
 	slurmctld_locks.entity[write_lock(datatype)]--;
-	pthread_cond_broadcast(&locks_cond);
-	slurm_mutex_unlock(&locks_mutex);
+	pthread_cond_broadcast(&locks_cond[datatype]);
+	slurm_mutex_unlock(&locks_mutex[datatype]);
 }
 
 /* get_lock_values - Get the current value of all locks
  * OUT lock_flags - a copy of the current lock values */
 void get_lock_values(slurmctld_lock_flags_t * lock_flags)
 {
+	int i;
+
 	xassert(lock_flags);
-	memcpy((void *) lock_flags, (void *) &slurmctld_locks,
-	       sizeof(slurmctld_locks));
+	for (i = 0; i < ENTITY_COUNT; i++) {
+		slurm_mutex_lock(&locks_mutex[i]);
+		lock_flags->entity[read_lock(i)] =
+			slurmctld_locks.entity[read_lock(i)];
+		lock_flags->entity[write_lock(i)] =
+			slurmctld_locks.entity[write_lock(i)];
+		lock_flags->entity[write_wait_lock(i)] =
+			slurmctld_locks.entity[write_wait_lock(i)];
+		slurm_mutex_unlock(&locks_mutex[i]);
+	}
 }
 
 /* kill_locked_threads - Kill all threads waiting on semaphores */
 extern void kill_locked_threads(void)
 {
+	int i;
+
 	kill_thread = 1;
-	pthread_cond_broadcast(&locks_cond);
+	for (i = 0; i < ENTITY_COUNT; i++)
+		pthread_cond_broadcast(&locks_cond[i]);
 }
 
 /* un/lock semaphore used for saving state of slurmctld */
@@ -110,10 +110,10 @@ static front_end_record_t * _front_end_reg(
 				slurm_node_registration_status_msg_t *reg_msg);
 static void 	_make_node_down(struct node_record *node_ptr,
 				time_t event_time);
-static bool	_node_is_hidden(struct node_record *node_ptr);
+static bool	_node_is_hidden(struct node_record *node_ptr, uid_t uid);
 static int	_open_node_state_file(char **state_file);
-static void 	_pack_node (struct node_record *dump_node_ptr, Buf buffer,
-			    uint16_t protocol_version);
+static void 	_pack_node (struct node_record *dump_node_ptr, bool hidden,
+			    Buf buffer, uint16_t protocol_version);
 static void	_sync_bitmaps(struct node_record *node_ptr, int job_count);
 static void	_update_config_ptr(bitstr_t *bitmap,
 				struct config_record *config_ptr);
@@ -639,13 +639,13 @@ int list_compare_config (void *config_entry1, void *config_entry2)
 }
 
 
-static bool _node_is_hidden(struct node_record *node_ptr)
+static bool _node_is_hidden(struct node_record *node_ptr, uid_t uid)
 {
 	int i;
 	bool shown = false;
 
 	for (i=0; i<node_ptr->part_cnt; i++) {
-		if (!(node_ptr->part_pptr[i]->flags & PART_FLAG_HIDDEN)) {
+		if (part_is_visible(node_ptr->part_pptr[i], uid)) {
 			shown = true;
 			break;
 		}
@@ -663,6 +663,9 @@ static bool _node_is_hidden(struct node_record *node_ptr)
  * OUT buffer_size - set to size of the buffer in bytes
  * IN show_flags - node filtering options
  * IN uid - uid of user making request (for partition filtering)
+ * IN last_update - if show_flags includes SHOW_DELTA, pack only nodes changed
+ *	since this time (all nodes if partitions changed) followed by the
+ *	node count and each packed node's index
  * IN protocol_version - slurm protocol version of client
  * global: node_record_table_ptr - pointer to global node table
  * NOTE: the caller must xfree the buffer at *buffer_ptr
@@ -670,11 +673,13 @@ static bool _node_is_hidden(struct node_record *node_ptr)
  * NOTE: READ lock_slurmctld config before entry
  */
 extern void pack_all_node (char **buffer_ptr, int *buffer_size,
-			   uint16_t show_flags, uid_t uid,
+			   uint16_t show_flags, uid_t uid, time_t last_update,
 			   uint16_t protocol_version)
 {
 	int inx;
 	uint32_t nodes_packed, tmp_offset, node_scaling;
+	uint32_t *node_inx = NULL;
+	bool delta_skip = false;
 	Buf buffer;
 	time_t now = time(NULL);
 	struct node_record *node_ptr = node_record_table_ptr;
@@ -695,8 +700,16 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 
 		pack_time(now, buffer);
 
+		if (show_flags & SHOW_DELTA) {
+			node_inx = xmalloc(sizeof(uint32_t) *
+					   (node_record_count + 1));
+			/* Hidden nodes depend upon partitions, so send every
+			 * node if they changed since the client's last update */
+			if (last_update > last_part_update)
+				delta_skip = true;
+		}
+
 		/* write node records */
-		part_filter_set(uid);
 		for (inx = 0; inx < node_record_count; inx++, node_ptr++) {
 			xassert (node_ptr->magic == NODE_MAGIC);
 			xassert (node_ptr->config_ptr->magic ==
@@ -708,7 +721,7 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 			 * with it. */
 			hidden = false;
 			if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
-			    (_node_is_hidden(node_ptr)))
+			    (_node_is_hidden(node_ptr, uid)))
 				hidden = true;
 			else if (IS_NODE_FUTURE(node_ptr) &&
 				 !IS_NODE_MAINT(node_ptr)) /* reboot req sent */
@@ -720,16 +733,21 @@ extern void pack_all_node (char **buffer_ptr, int *buffer_size,
 				 (node_ptr->name[0] == '\0'))
 				hidden = true;
 
-			if (hidden) {
-				char *orig_name = node_ptr->name;
-				node_ptr->name = NULL;
-				_pack_node(node_ptr, buffer, protocol_version);
-				node_ptr->name = orig_name;
-			} else
-				_pack_node(node_ptr, buffer, protocol_version);
+			if (node_inx) {
+				if (delta_skip &&
+				    (node_ptr->last_update < last_update))
+					continue; /* client has this record */
+				node_inx[nodes_packed] = inx;
+			}
+			_pack_node(node_ptr, hidden, buffer, protocol_version);
 			nodes_packed++;
 		}
-		part_filter_clear();
+
+		if (node_inx) {
+			pack32(node_record_count, buffer);
+			pack32_array(node_inx, nodes_packed, buffer);
+			xfree(node_inx);
+		}
 	} else {
 		error("select_g_select_jobinfo_pack: protocol_version "
 		      "%hu not supported", protocol_version);
@@ -785,7 +803,6 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 		pack_time(now, buffer);
 
 		/* write node records */
-		part_filter_set(uid);
 		if (node_name)
 			node_ptr = find_node_record(node_name);
 		else
@@ -793,7 +810,7 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 		if (node_ptr) {
 			hidden = false;
 			if (((show_flags & SHOW_ALL) == 0) && (uid != 0) &&
-			    (_node_is_hidden(node_ptr)))
+			    (_node_is_hidden(node_ptr, uid)))
 				hidden = true;
 			else if (IS_NODE_FUTURE(node_ptr) &&
 				 !IS_NODE_MAINT(node_ptr)) /* reboot req sent */
@@ -806,11 +823,11 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 				hidden = true;
 
 			if (!hidden) {
-				_pack_node(node_ptr, buffer, protocol_version);
+				_pack_node(node_ptr, false, buffer,
+					   protocol_version);
 				nodes_packed++;
 			}
 		}
-		part_filter_clear();
 	} else {
 		error("select_g_select_jobinfo_pack: protocol_version "
 		      "%hu not supported", protocol_version);
@@ -829,17 +846,21 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
  * _pack_node - dump all configuration information about a specific node in
  *	machine independent form (for network transmission)
  * IN dump_node_ptr - pointer to node for which information is requested
+ * IN hidden - if set, pack the node with a NULL name so the client skips it
  * IN/OUT buffer - buffer where data is placed, pointers automatically updated
  * IN protocol_version - slurm protocol version of client
  * NOTE: if you make any changes here be sure to make the corresponding
  *	changes to load_node_config in api/node_info.c
  * NOTE: READ lock_slurmctld config before entry
  */
-static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
-			uint16_t protocol_version)
+static void _pack_node (struct node_record *dump_node_ptr, bool hidden,
+			Buf buffer, uint16_t protocol_version)
 {
 	if (protocol_version >= SLURM_2_5_PROTOCOL_VERSION) {
-		packstr (dump_node_ptr->name, buffer);
+		if (hidden)
+			packnull(buffer);
+		else
+			packstr(dump_node_ptr->name, buffer);
 		packstr (dump_node_ptr->node_hostname, buffer);
 		packstr (dump_node_ptr->comm_name, buffer);
 		pack16  (dump_node_ptr->node_state, buffer);
@@ -891,7 +912,10 @@ static void _pack_node (struct node_record *dump_node_ptr, Buf buffer,
 		acct_gather_energy_pack(dump_node_ptr->energy, buffer,
 					protocol_version);
 	} else if (protocol_version >= SLURM_2_4_PROTOCOL_VERSION) {
-		packstr (dump_node_ptr->name, buffer);
+		if (hidden)
+			packnull(buffer);
+		else
+			packstr(dump_node_ptr->name, buffer);
 		packstr (dump_node_ptr->node_hostname, buffer);
 		packstr (dump_node_ptr->comm_name, buffer);
 		pack16  (dump_node_ptr->node_state, buffer);
@@ -1056,6 +1080,7 @@ int update_node ( update_node_msg_t * update_node_msg )
 			free (this_node_name);
 			break;
 		}
+		node_ptr->last_update = now;
 
 		if (hostaddr_list) {
 			char *this_addr = hostlist_shift(hostaddr_list);
@@ -1663,6 +1688,7 @@ extern int drain_nodes ( char *nodes, char *reason, uint32_t reason_uid )
 		}
 
 		node_ptr->node_state |= NODE_STATE_DRAIN;
+		node_ptr->last_update = now;
 		bit_clear (avail_node_bitmap, node_inx);
 		info ("drain_nodes: node %s state set to DRAIN",
 			this_node_name);
@@ -1919,6 +1945,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 		node_ptr->node_state &= (~NODE_STATE_NO_RESPOND);
 		node_ptr->node_state &= (~NODE_STATE_POWER_UP);
 		last_node_update = time (NULL);
+		node_ptr->last_update = last_node_update;
 	}
 	node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 	if (error_code) {
@@ -1928,12 +1955,14 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 		}
 		set_node_down(reg_msg->node_name, reason_down);
 		last_node_update = time (NULL);
+		node_ptr->last_update = last_node_update;
 	} else if (reg_msg->status == ESLURMD_PROLOG_FAILED) {
 		if (!IS_NODE_DRAIN(node_ptr) && !IS_NODE_FAIL(node_ptr)) {
 			error("Prolog failure on node %s, setting state DOWN",
 			      reg_msg->node_name);
 			set_node_down(reg_msg->node_name, "Prolog failed");
 			last_node_update = time (NULL);
+			node_ptr->last_update = last_node_update;
 		}
 	} else {
 		if (IS_NODE_UNKNOWN(node_ptr) || IS_NODE_FUTURE(node_ptr)) {
@@ -1953,6 +1982,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 				node_ptr->last_idle = now;
 			}
 			last_node_update = now;
+			node_ptr->last_update = now;
 			if (!IS_NODE_DRAIN(node_ptr)
 			    && !IS_NODE_FAIL(node_ptr)) {
 				/* reason information is handled in
@@ -1979,6 +2009,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 			     reg_msg->node_name);
 			trigger_node_up(node_ptr);
 			last_node_update = now;
+			node_ptr->last_update = now;
 			if (!IS_NODE_DRAIN(node_ptr)
 			    && !IS_NODE_FAIL(node_ptr)) {
 				/* reason information is handled in
@@ -2002,16 +2033,19 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 			_make_node_down(node_ptr, now);
 			kill_running_job_by_node_name(reg_msg->node_name);
 			last_node_update = now;
+			node_ptr->last_update = now;
 			reg_msg->job_count = 0;
 		} else if (IS_NODE_ALLOCATED(node_ptr) &&
 			   (reg_msg->job_count == 0)) {	/* job vanished */
 			node_ptr->node_state = NODE_STATE_IDLE | node_flags;
 			node_ptr->last_idle = now;
 			last_node_update = now;
+			node_ptr->last_update = now;
 		} else if (IS_NODE_COMPLETING(node_ptr) &&
 			   (reg_msg->job_count == 0)) {	/* job already done */
 			node_ptr->node_state &= (~NODE_STATE_COMPLETING);
 			last_node_update = now;
+			node_ptr->last_update = now;
 			bit_clear(cg_node_bitmap, node_inx);
 		} else if (IS_NODE_IDLE(node_ptr) &&
 			   (reg_msg->job_count != 0)) {
@@ -2032,6 +2066,7 @@ extern int validate_node_specs(slurm_node_registration_status_msg_t *reg_msg)
 				bit_set(cg_node_bitmap, node_inx);
 			}
 			last_node_update = now;
+			node_ptr->last_update = now;
 		}
 
 		select_g_update_node_config(node_inx);
@@ -2255,6 +2290,7 @@ extern int validate_nodes_via_front_end(
 			}
 			set_node_down(node_ptr->name, reason_down);
 			last_node_update = now;
+			node_ptr->last_update = now;
 		}
 		xfree(reason_down);
 		gres_plugin_node_state_log(node_ptr->gres_list, node_ptr->name);
@@ -2267,6 +2303,7 @@ extern int validate_nodes_via_front_end(
 
 		if (IS_NODE_NO_RESPOND(node_ptr)) {
 			update_node_state = true;
+			node_ptr->last_update = now;
 #ifndef HAVE_CRAY
 			/* This is handled by the select/cray plugin */
 			node_ptr->node_state &= (~NODE_STATE_NO_RESPOND);
@@ -2284,6 +2321,7 @@ extern int validate_nodes_via_front_end(
 			node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 			if (IS_NODE_UNKNOWN(node_ptr)) {
 				update_node_state = true;
+				node_ptr->last_update = now;
 				if (node_ptr->run_job_cnt) {
 					node_ptr->node_state =
 						NODE_STATE_ALLOCATED |
@@ -2310,6 +2348,7 @@ extern int validate_nodes_via_front_end(
 				     (strncmp(node_ptr->reason,
 					      "Not responding", 14) == 0)))) {
 				update_node_state = true;
+				node_ptr->last_update = now;
 				if (node_ptr->run_job_cnt) {
 					node_ptr->node_state =
 						NODE_STATE_ALLOCATED |
@@ -2334,6 +2373,7 @@ extern int validate_nodes_via_front_end(
 				   (node_ptr->run_job_cnt == 0)) {
 				/* job vanished */
 				update_node_state = true;
+				node_ptr->last_update = now;
 				node_ptr->node_state = NODE_STATE_IDLE |
 					node_flags;
 				node_ptr->last_idle = now;
@@ -2341,12 +2381,14 @@ extern int validate_nodes_via_front_end(
 				   (node_ptr->comp_job_cnt == 0)) {
 				/* job already done */
 				update_node_state = true;
+				node_ptr->last_update = now;
 				node_ptr->node_state &=
 					(~NODE_STATE_COMPLETING);
 				bit_clear(cg_node_bitmap, i);
 			} else if (IS_NODE_IDLE(node_ptr) &&
 				   (node_ptr->run_job_cnt != 0)) {
 				update_node_state = true;
+				node_ptr->last_update = now;
 				node_ptr->node_state = NODE_STATE_ALLOCATED |
 						       node_flags;
 				error("Invalid state for node %s, was IDLE "
@@ -2454,6 +2496,7 @@ static void _node_did_resp(struct node_record *node_ptr)
 		if (!is_node_in_maint_reservation(node_inx))
 			node_ptr->node_state &= (~NODE_STATE_MAINT);
 		last_node_update = now;
+		node_ptr->last_update = now;
 	}
 	node_flags = node_ptr->node_state & NODE_STATE_FLAGS;
 	if (IS_NODE_UNKNOWN(node_ptr)) {
@@ -2464,6 +2507,7 @@ static void _node_did_resp(struct node_record *node_ptr)
 		} else
 			node_ptr->node_state = NODE_STATE_IDLE | node_flags;
 		last_node_update = now;
+		node_ptr->last_update = now;
 		if (!IS_NODE_DRAIN(node_ptr) && !IS_NODE_FAIL(node_ptr)) {
 			clusteracct_storage_g_node_up(acct_db_conn,
 						      node_ptr, now);
@@ -2479,6 +2523,7 @@ static void _node_did_resp(struct node_record *node_ptr)
 		     node_ptr->name);
 		trigger_node_up(node_ptr);
 		last_node_update = now;
+		node_ptr->last_update = now;
 		if (!IS_NODE_DRAIN(node_ptr) && !IS_NODE_FAIL(node_ptr)) {
 			/* reason information is handled in
 			   clusteracct_storage_g_node_up()
@@ -2564,6 +2609,7 @@ void node_not_resp (char *name, time_t msg_time)
 	last_front_end_update = time(NULL);
 #else
 	last_node_update = time(NULL);
+	node_ptr->last_update = last_node_update;
 	bit_clear (avail_node_bitmap, (node_ptr - node_record_table_ptr));
 #endif
 	return;
@@ -2784,6 +2830,7 @@ extern void make_node_alloc(struct node_record *node_ptr,
 	node_ptr->reason_uid = NO_VAL;
 
 	last_node_update = time (NULL);
+	node_ptr->last_update = last_node_update;
 }
 
 /* make_node_comp - flag specified node as completing a job
@@ -2853,6 +2900,7 @@ extern void make_node_comp(struct node_record *node_ptr,
 		node_ptr->last_idle = now;
 	}
 	last_node_update = now;
+	node_ptr->last_update = now;
 }
 
 /* _make_node_down - flag specified node as down */
@@ -2873,6 +2921,7 @@ static void _make_node_down(struct node_record *node_ptr, time_t event_time)
 	select_g_update_node_state(node_ptr);
 	trigger_node_down(node_ptr);
 	last_node_update = time (NULL);
+	node_ptr->last_update = last_node_update;
 	clusteracct_storage_g_node_down(acct_db_conn,
 					node_ptr, event_time, NULL,
 					node_ptr->reason_uid);
@@ -2902,6 +2951,7 @@ void make_node_idle(struct node_record *node_ptr,
 	if (node_bitmap && (bit_test(node_bitmap, inx))) {
 		/* Not a replay */
 		last_job_update = now;
+		job_ptr->last_update = now;
 		bit_clear(node_bitmap, inx);
 
 		job_update_cpu_cnt(job_ptr, inx);
@@ -2994,6 +3044,7 @@ void make_node_idle(struct node_record *node_ptr,
 		node_ptr->last_idle = now;
 	}
 	last_node_update = now;
+	node_ptr->last_update = now;
 }
 
 extern int send_nodes_to_accounting(time_t event_time)
@@ -3096,6 +3147,7 @@ extern void reset_node_load(char *node_name, uint32_t cpu_load)
 	if (node_ptr) {
 		node_ptr->cpu_load = cpu_load;
 		last_node_update = time(NULL);
+		node_ptr->last_update = last_node_update;
 	} else
 		error("is_node_resp unable to find node %s", node_name);
 #endif
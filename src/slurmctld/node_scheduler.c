@@ -1005,9 +1005,9 @@ _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 					return ESLURM_NODES_BUSY;
 				}
 #ifndef HAVE_BG
-				if (bit_overlap(job_ptr->details->
-						req_node_bitmap,
-						cg_node_bitmap)) {
+				if (bit_overlap_any(job_ptr->details->
+						    req_node_bitmap,
+						    cg_node_bitmap)) {
 					return ESLURM_NODES_BUSY;
 				}
 #endif
@@ -1020,8 +1020,8 @@ _pick_best_nodes(struct node_set *node_set_ptr, int node_set_size,
 				/* Note: IDLE nodes are not COMPLETING */
 			}
 #ifndef HAVE_BG
-		} else if (bit_overlap(job_ptr->details->req_node_bitmap,
-				       cg_node_bitmap)) {
+		} else if (bit_overlap_any(job_ptr->details->req_node_bitmap,
+					   cg_node_bitmap)) {
 			return ESLURM_NODES_BUSY;
 #endif
 		}
@@ -1443,6 +1443,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 	fail_reason = job_limits_check(&job_ptr);
 	if (fail_reason != WAIT_NO_REASON) {
 		last_job_update = now;
+		job_ptr->last_update = now;
 		xfree(job_ptr->state_desc);
 		job_ptr->state_reason = fail_reason;
 		return ESLURM_REQUESTED_PART_CONFIG_UNAVAILABLE;
@@ -1543,6 +1544,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_PART_NODE_LIMIT;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_ptr->last_update = now;
 		} else if (error_code == ESLURM_NODE_NOT_AVAIL) {
 			/* Required nodes are down or drained */
 			debug3("JobId=%u required nodes not avail",
@@ -1550,6 +1552,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 			job_ptr->state_reason = WAIT_NODE_NOT_AVAIL;
 			xfree(job_ptr->state_desc);
 			last_job_update = now;
+			job_ptr->last_update = now;
 		} else if (error_code == ESLURM_RESERVATION_NOT_USABLE) {
 			job_ptr->state_reason = WAIT_RESERVATION;
 			xfree(job_ptr->state_desc);
@@ -1627,7 +1630,7 @@ extern int select_nodes(struct job_record *job_ptr, bool test_only,
 
 	job_ptr->job_state = JOB_RUNNING;
 	if (configuring
-	    || bit_overlap(job_ptr->node_bitmap, power_node_bitmap))
+	    || bit_overlap_any(job_ptr->node_bitmap, power_node_bitmap))
 		job_ptr->job_state |= JOB_CONFIGURING;
 	if (select_g_select_nodeinfo_set(job_ptr) != SLURM_SUCCESS) {
 		error("select_g_select_nodeinfo_set(%u): %m", job_ptr->job_id);
@@ -1811,7 +1814,7 @@ static bool _valid_feature_counts(struct job_details *detail_ptr,
 	struct feature_record *job_feat_ptr;
 	struct features_record *feat_ptr;
 	int have_count = false, last_op = FEATURE_OP_AND;
-	bitstr_t *feature_bitmap, *tmp_bitmap;
+	bitstr_t *feature_bitmap;
 	bool rc = true;
 
 	xassert(detail_ptr);
@@ -1863,13 +1866,11 @@ static bool _valid_feature_counts(struct job_details *detail_ptr,
 				rc = false;
 				break;
 			}
-			tmp_bitmap = bit_copy(feature_bitmap);
-			bit_and(tmp_bitmap, feat_ptr->node_bitmap);
-			if (bit_set_count(tmp_bitmap) < job_feat_ptr->count)
+			if (bit_overlap(feature_bitmap, feat_ptr->node_bitmap) <
+			    job_feat_ptr->count) {
 				rc = false;
-			FREE_NULL_BITMAP(tmp_bitmap);
-			if (!rc)
 				break;
+			}
 		}
 		list_iterator_destroy(job_feat_iter);
 		FREE_NULL_BITMAP(feature_bitmap);
@@ -2480,6 +2481,7 @@ extern void re_kill_job(struct job_record *job_ptr)
 				if ((job_ptr->node_cnt > 0) &&
 				    ((--job_ptr->node_cnt) == 0)) {
 					last_node_update = time(NULL);
+					node_ptr->last_update = last_node_update;
 					job_ptr->job_state &= (~JOB_COMPLETING);
 					delete_step_records(job_ptr);
 					slurm_sched_schedule();
@@ -2511,6 +2513,7 @@ extern void re_kill_job(struct job_record *job_ptr)
 				delete_step_records(job_ptr);
 				slurm_sched_schedule();
 				last_node_update = time(NULL);
+				node_ptr->last_update = last_node_update;
 			}
 		} else if (!IS_NODE_NO_RESPOND(node_ptr)) {
 			(void)hostlist_push_host(kill_hostlist, node_ptr->name);
@@ -840,40 +840,23 @@ int list_find_part(void *part_entry, void *key)
 	return 0;
 }
 
-/* part_filter_set - Set the partition's hidden flag based upon a user's
- * group access. This must be followed by a call to part_filter_clear() */
-extern void part_filter_set(uid_t uid)
+/* part_is_visible - Determine if a partition is visible to a user, either
+ *	not being hidden or the user being denied access by group membership.
+ *	The partition record is not modified so a READ lock on partitions is
+ *	sufficient, which lets concurrent info RPCs proceed in parallel.
+ * IN part_ptr - pointer to a partition
+ * IN uid - user ID of the user requesting information
+ * RET true if the partition should be shown to the user */
+extern bool part_is_visible(struct part_record *part_ptr, uid_t uid)
 {
-	struct part_record *part_ptr;
-	ListIterator part_iterator;
-
-	part_iterator = list_iterator_create(part_list);
-	while ((part_ptr = (struct part_record *) list_next(part_iterator))) {
-		if (part_ptr->flags & PART_FLAG_HIDDEN)
-			continue;
-		if (validate_group (part_ptr, uid) == 0) {
-			part_ptr->flags |= PART_FLAG_HIDDEN;
-			part_ptr->flags |= PART_FLAG_HIDDEN_CLR;
-		}
-	}
-	list_iterator_destroy(part_iterator);
-}
+	xassert(part_ptr);
 
-/* part_filter_clear - Clear the partition's hidden flag based upon a user's
- * group access. This must follow a call to part_filter_set() */
-extern void part_filter_clear(void)
-{
-	struct part_record *part_ptr;
-	ListIterator part_iterator;
+	if (part_ptr->flags & PART_FLAG_HIDDEN)
+		return false;
+	if (validate_group(part_ptr, uid) == 0)
+		return false;
 
-	part_iterator = list_iterator_create(part_list);
-	while ((part_ptr = (struct part_record *) list_next(part_iterator))) {
-		if (part_ptr->flags & PART_FLAG_HIDDEN_CLR) {
-			part_ptr->flags &= (~PART_FLAG_HIDDEN);
-			part_ptr->flags &= (~PART_FLAG_HIDDEN_CLR);
-		}
-	}
-	list_iterator_destroy(part_iterator);
+	return true;
 }
 
 /*
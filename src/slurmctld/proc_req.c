@@ -638,6 +638,7 @@ void _fill_ctld_conf(slurm_ctl_conf_t * conf_ptr)
 	conf_ptr->slurmd_port         = conf->slurmd_port;
 	conf_ptr->slurmd_spooldir     = xstrdup(conf->slurmd_spooldir);
 	conf_ptr->slurmd_timeout      = conf->slurmd_timeout;
+	conf_ptr->slurmstepd_pool_size = conf->slurmstepd_pool_size;
 	conf_ptr->slurmd_user_id      = conf->slurmd_user_id;
 	conf_ptr->slurmd_user_name    = xstrdup(conf->slurmd_user_name);
 	conf_ptr->slurm_conf          = xstrdup(conf->slurm_conf);
@@ -972,9 +973,9 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 	slurm_msg_t response_msg;
 	job_info_request_msg_t *job_info_request_msg =
 		(job_info_request_msg_t *) msg->data;
-	/* Locks: Read config job, write node (for hiding) */
+	/* Locks: Read config, job, partition (for hiding) */
 	slurmctld_lock_t job_read_lock = {
-		READ_LOCK, READ_LOCK, NO_LOCK, WRITE_LOCK };
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
 
 	START_TIMER;
@@ -985,30 +986,32 @@ static void _slurm_rpc_dump_jobs(slurm_msg_t * msg)
 		unlock_slurmctld(job_read_lock);
 		debug3("_slurm_rpc_dump_jobs, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
-	} else {
-		pack_all_jobs(&dump, &dump_size,
-			      job_info_request_msg->show_flags,
-			      g_slurm_auth_get_uid(msg->auth_cred, NULL),
-			      NO_VAL, msg->protocol_version);
-		unlock_slurmctld(job_read_lock);
-		END_TIMER2("_slurm_rpc_dump_jobs");
+		return;
+	}
+	pack_all_jobs(&dump, &dump_size, job_info_request_msg->show_flags,
+		      uid, NO_VAL, job_info_request_msg->last_update,
+		      msg->protocol_version);
+	unlock_slurmctld(job_read_lock);
+	END_TIMER2("_slurm_rpc_dump_jobs");
 #if 0
-		info("_slurm_rpc_dump_jobs, size=%d %s", dump_size, TIME_STR);
+	info("_slurm_rpc_dump_jobs, size=%d %s", dump_size, TIME_STR);
 #endif
 
-		/* init response_msg structure */
-		slurm_msg_t_init(&response_msg);
-		response_msg.flags = msg->flags;
-		response_msg.protocol_version = msg->protocol_version;
-		response_msg.address = msg->address;
+	/* init response_msg structure */
+	slurm_msg_t_init(&response_msg);
+	response_msg.flags = msg->flags;
+	response_msg.protocol_version = msg->protocol_version;
+	response_msg.address = msg->address;
+	if (job_info_request_msg->show_flags & SHOW_DELTA)
+		response_msg.msg_type = RESPONSE_JOB_INFO_DELTA;
+	else
 		response_msg.msg_type = RESPONSE_JOB_INFO;
-		response_msg.data = dump;
-		response_msg.data_size = dump_size;
+	response_msg.data = dump;
+	response_msg.data_size = dump_size;
 
-		/* send message */
-		slurm_send_node_msg(msg->conn_fd, &response_msg);
-		xfree(dump);
-	}
+	/* send message */
+	slurm_send_node_msg(msg->conn_fd, &response_msg);
+	xfree(dump);
 }
 
 /* _slurm_rpc_dump_jobs - process RPC for job state information */
@@ -1020,18 +1023,19 @@ static void _slurm_rpc_dump_jobs_user(slurm_msg_t * msg)
 	slurm_msg_t response_msg;
 	job_user_id_msg_t *job_info_request_msg =
 		(job_user_id_msg_t *) msg->data;
-	/* Locks: Read config job, write node (for hiding) */
+	/* Locks: Read config, job, partition (for hiding) */
 	slurmctld_lock_t job_read_lock = {
-		READ_LOCK, READ_LOCK, NO_LOCK, WRITE_LOCK };
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
 
 	START_TIMER;
 	debug3("Processing RPC: REQUEST_JOB_USER_INFO from uid=%d", uid);
 	lock_slurmctld(job_read_lock);
 	pack_all_jobs(&dump, &dump_size,
-		      job_info_request_msg->show_flags,
+		      job_info_request_msg->show_flags & (~SHOW_DELTA),
 		      g_slurm_auth_get_uid(msg->auth_cred, NULL),
-		      job_info_request_msg->user_id, msg->protocol_version);
+		      job_info_request_msg->user_id, (time_t) 0,
+		      msg->protocol_version);
 	unlock_slurmctld(job_read_lock);
 	END_TIMER2("_slurm_rpc_dump_job_user");
 #if 0
@@ -1060,9 +1064,9 @@ static void _slurm_rpc_dump_job_single(slurm_msg_t * msg)
 	int dump_size, rc;
 	slurm_msg_t response_msg;
 	job_id_msg_t *job_id_msg = (job_id_msg_t *) msg->data;
-	/* Locks: Read config job, write node (for hiding) */
+	/* Locks: Read config, job, partition (for hiding) */
 	slurmctld_lock_t job_read_lock = {
-		READ_LOCK, READ_LOCK, NO_LOCK, WRITE_LOCK };
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
 
 	START_TIMER;
@@ -1240,35 +1244,57 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 	slurm_msg_t response_msg;
 	node_info_request_msg_t *node_req_msg =
 		(node_info_request_msg_t *) msg->data;
+	/* Locks: Read config, node */
+	slurmctld_lock_t node_read_lock = {
+		READ_LOCK, NO_LOCK, READ_LOCK, NO_LOCK };
 	/* Locks: Read config, write node (reset allocated CPU count in some
 	 * select plugins) */
 	slurmctld_lock_t node_write_lock = {
 		READ_LOCK, NO_LOCK, WRITE_LOCK, NO_LOCK };
+	/* Time the select plugin's per-node counts were last set,
+	 * protected by the node lock */
+	static time_t last_set_all = 0;
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
 
 	START_TIMER;
 	debug3("Processing RPC: REQUEST_NODE_INFO from uid=%d", uid);
-	lock_slurmctld(node_write_lock);
+	lock_slurmctld(node_read_lock);
 
 	if ((slurmctld_conf.private_data & PRIVATE_DATA_NODES) &&
 	    (!validate_operator(uid))) {
-		unlock_slurmctld(node_write_lock);
+		unlock_slurmctld(node_read_lock);
 		error("Security violation, REQUEST_NODE_INFO RPC from uid=%d",
 		      uid);
 		slurm_send_rc_msg(msg, ESLURM_ACCESS_DENIED);
 		return;
 	}
 
-	select_g_select_nodeinfo_set_all();
-
 	if ((node_req_msg->last_update - 1) >= last_node_update) {
-		unlock_slurmctld(node_write_lock);
+		unlock_slurmctld(node_read_lock);
 		debug3("_slurm_rpc_dump_nodes, no change");
 		slurm_send_rc_msg(msg, SLURM_NO_CHANGE_IN_DATA);
 	} else {
+		/* Refreshing the select plugin's per-node allocation counts
+		 * needs the node write lock, so only take it if node state
+		 * may have changed since they were last set (in the same
+		 * second counts as changed). Requests finding the counts
+		 * current pack under the read lock alone and run
+		 * concurrently; a refresh still waits for all node readers
+		 * and blocks them while it runs. */
+		if (last_node_update >= last_set_all) {
+			unlock_slurmctld(node_read_lock);
+			lock_slurmctld(node_write_lock);
+			if (last_node_update >= last_set_all) {
+				select_g_select_nodeinfo_set_all();
+				last_set_all = time(NULL);
+			}
+			unlock_slurmctld(node_write_lock);
+			lock_slurmctld(node_read_lock);
+		}
 		pack_all_node(&dump, &dump_size, node_req_msg->show_flags,
-			      uid, msg->protocol_version);
-		unlock_slurmctld(node_write_lock);
+			      uid, node_req_msg->last_update,
+			      msg->protocol_version);
+		unlock_slurmctld(node_read_lock);
 		END_TIMER2("_slurm_rpc_dump_nodes");
 #if 0
 		info("_slurm_rpc_dump_nodes, size=%d %s", dump_size, TIME_STR);
@@ -1279,7 +1305,10 @@ static void _slurm_rpc_dump_nodes(slurm_msg_t * msg)
 		response_msg.flags = msg->flags;
 		response_msg.protocol_version = msg->protocol_version;
 		response_msg.address = msg->address;
-		response_msg.msg_type = RESPONSE_NODE_INFO;
+		if (node_req_msg->show_flags & SHOW_DELTA)
+			response_msg.msg_type = RESPONSE_NODE_INFO_DELTA;
+		else
+			response_msg.msg_type = RESPONSE_NODE_INFO;
 		response_msg.data = dump;
 		response_msg.data_size = dump_size;
 
@@ -1868,9 +1897,9 @@ static void _slurm_rpc_job_step_get_info(slurm_msg_t * msg)
 	int error_code = SLURM_SUCCESS;
 	job_step_info_request_msg_t *request =
 		(job_step_info_request_msg_t *) msg->data;
-	/* Locks: Read config, job, write partition (for filtering) */
+	/* Locks: Read config, job, partition (for filtering) */
 	slurmctld_lock_t job_read_lock = {
-		READ_LOCK, READ_LOCK, NO_LOCK, WRITE_LOCK };
+		READ_LOCK, READ_LOCK, NO_LOCK, READ_LOCK };
 	uid_t uid = g_slurm_auth_get_uid(msg->auth_cred, NULL);
 
 	START_TIMER;
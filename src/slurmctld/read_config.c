@@ -327,6 +327,7 @@ static int _build_bitmaps(void)
 
 		if (node_ptr->name[0] == '\0')
 			continue;	/* defunct */
+		node_ptr->last_update = last_node_update;
 		drain_flag = IS_NODE_DRAIN(node_ptr) |
 			     IS_NODE_FAIL(node_ptr);
 		job_cnt = node_ptr->run_job_cnt + node_ptr->comp_job_cnt;
@@ -4171,6 +4171,7 @@ static void _set_nodes_maint(slurmctld_resv_t *resv_ptr, time_t now)
 			continue;
 
 		node_ptr = node_record_table_ptr + i;
+		node_ptr->last_update = now;
 		if (resv_ptr->maint_set_node)
 			node_ptr->node_state |= NODE_STATE_MAINT;
 		else
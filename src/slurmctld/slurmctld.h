@@ -206,6 +206,10 @@ typedef struct diag_stats {
 	uint32_t bf_queue_len_sum;
 	time_t   bf_when_last_cycle;
 	uint32_t bf_active;
+	uint32_t bf_resumes;
+	uint32_t bf_restarts;
+
+	uint32_t job_hash_resizes;
 } diag_stats_t;
 
 extern diag_stats_t slurmctld_diag_stats;
@@ -530,6 +534,20 @@ struct job_record {
 	uint16_t job_state;	        /* state of the job */
 	uint16_t kill_on_node_fail;	/* 1 if job should be killed on
 					 * node failure */
+	time_t last_update;		/* time of last update to this job,
+					 * for delta RPCs, no need to
+					 * save/restore */
+	uint16_t pack_reason;		/* state_reason and start_time as */
+	time_t pack_start_time;		/* of last job info RPC, see
+					 * last_update */
+	char *pack_cache;		/* job record packed for job info
+					 * RPCs, reused while unchanged */
+	uint16_t pack_cache_flags;	/* show_flags of pack_cache */
+	time_t pack_cache_gen;		/* partition and config update
+					 * time of pack_cache */
+	uint32_t pack_cache_size;	/* bytes in pack_cache */
+	time_t pack_cache_time;		/* last_update of pack_cache */
+	uint16_t pack_cache_version;	/* protocol_version of pack_cache */
 	char *licenses;			/* licenses required by the job */
 	List license_list;		/* structure with license info */
 	uint16_t limit_set_max_cpus;	/* if max_cpus was set from
@@ -557,11 +575,15 @@ struct job_record {
 					 * job */
 	bitstr_t *node_bitmap;		/* bitmap of nodes allocated to job */
 	bitstr_t *node_bitmap_cg;	/* bitmap of nodes completing job */
+	bitstr_t *node_bitmap_cg_cache;	/* node_bitmap_cg when nodes_cg_cache
+					 * was built, no need to save/restore */
 	uint32_t node_cnt;		/* count of nodes currently
 					 * allocated to job */
 	char *nodes_completing;		/* nodes still in completing state
 					 * for this job, used to insure
 					 * epilog is not re-run for job */
+	char *nodes_cg_cache;		/* node list of node_bitmap_cg as last
+					 * packed, no need to save/restore */
 	uint16_t other_port;		/* port for client communications */
 	char *partition;		/* name of job partition(s) */
 	List part_ptr_list;		/* list of pointers to partition recs */
@@ -1066,6 +1088,16 @@ extern void job_fini (void);
  */
 extern int job_fail(uint32_t job_id);
 
+/*
+ * job_hash_stats - report job hash table statistics
+ * OUT table_size - count of slots in the job hash table
+ * OUT job_cnt - count of jobs in the job hash table
+ * OUT max_chain - length of the longest chain of jobs in any one slot
+ * NOTE: READ lock_slurmctld job before entry
+ */
+extern void job_hash_stats(uint32_t *table_size, uint32_t *job_cnt,
+			   uint32_t *max_chain);
+
 /*
  * determine if job is ready to execute per the node select plugin
  * IN job_id - job to test
@@ -1436,6 +1468,9 @@ extern void node_no_resp_msg(void);
  * IN show_flags - job filtering options
  * IN uid - uid of user making request (for partition filtering)
  * IN filter_uid - pack only jobs belonging to this user if not NO_VAL
+ * IN last_update - if show_flags includes SHOW_DELTA, pack only jobs changed
+ *	since this time (all jobs if partitions changed) followed by the IDs
+ *	of all jobs otherwise packed
  * IN protocol_version - slurm protocol version of client
  * global: job_list - global list of job records
  * NOTE: the buffer at *buffer_ptr must be xfreed by the caller
@@ -1444,7 +1479,7 @@ extern void node_no_resp_msg(void);
  */
 extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
 			  uint16_t show_flags, uid_t uid, uint32_t filter_uid,
-			  uint16_t protocol_version);
+			  time_t last_update, uint16_t protocol_version);
 
 /*
  * pack_all_node - dump all configuration and node information for all nodes
@@ -1453,6 +1488,9 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  * OUT buffer_size - set to size of the buffer in bytes
  * IN show_flags - node filtering options
  * IN uid - uid of user making request (for partition filtering)
+ * IN last_update - if show_flags includes SHOW_DELTA, pack only nodes changed
+ *	since this time (all nodes if partitions changed) followed by the
+ *	node count and each packed node's index
  * IN protocol_version - slurm protocol version of client
  * global: node_record_table_ptr - pointer to global node table
  * NOTE: the caller must xfree the buffer at *buffer_ptr
@@ -1460,7 +1498,7 @@ extern void pack_all_jobs(char **buffer_ptr, int *buffer_size,
  * NOTE: READ lock_slurmctld config before entry
  */
 extern void pack_all_node (char **buffer_ptr, int *buffer_size,
-			   uint16_t show_flags, uid_t uid,
+			   uint16_t show_flags, uid_t uid, time_t last_update,
 			   uint16_t protocol_version);
 
 /* Pack all scheduling statistics */
@@ -1560,17 +1598,17 @@ extern void pack_one_node (char **buffer_ptr, int *buffer_size,
 			   uint16_t show_flags, uid_t uid, char *node_name,
 			   uint16_t protocol_version);
 
-/* part_filter_clear - Clear the partition's hidden flag based upon a user's
- * group access. This must follow a call to part_filter_set() */
-extern void part_filter_clear(void);
-
-/* part_filter_set - Set the partition's hidden flag based upon a user's
- * group access. This must be followed by a call to part_filter_clear() */
-extern void part_filter_set(uid_t uid);
-
 /* part_fini - free all memory associated with partition records */
 extern void part_fini (void);
 
+/* part_is_visible - Determine if a partition is visible to a user, either
+ *	not being hidden or the user being denied access by group membership.
+ *	Requires only a READ lock on partitions.
+ * IN part_ptr - pointer to a partition
+ * IN uid - user ID of the user requesting information
+ * RET true if the partition should be shown to the user */
+extern bool part_is_visible(struct part_record *part_ptr, uid_t uid);
+
 /*
  * Create a copy of a job's part_list *partition list
  * IN part_list_src - a job's part_list
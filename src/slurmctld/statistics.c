@@ -43,6 +43,7 @@
 #include <stdio.h>
 
 #include "src/slurmctld/agent.h"
+#include "src/slurmctld/locks.h"
 #include "src/slurmctld/slurmctld.h"
 #include "src/common/pack.h"
 #include "src/common/xstring.h"
@@ -59,7 +60,11 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 	Buf buffer;
 	int parts_packed;
 	int agent_queue_size;
+	uint32_t hash_size, hash_cnt, hash_max_chain;
 	time_t now = time(NULL);
+	/* Locks: Read job */
+	slurmctld_lock_t job_read_lock = {
+		NO_LOCK, READ_LOCK, NO_LOCK, NO_LOCK };
 
 	buffer_ptr[0] = NULL;
 	*buffer_size = 0;
@@ -118,6 +123,20 @@ extern void pack_all_stat(int resp, char **buffer_ptr, int *buffer_size,
 			pack32(slurmctld_diag_stats.bf_depth_try_sum, buffer);
 			pack32(slurmctld_diag_stats.bf_queue_len_sum, buffer);
 			pack32(slurmctld_diag_stats.bf_active,	 buffer);
+
+			if (protocol_version >= SLURM_2_6_PROTOCOL_VERSION) {
+				lock_slurmctld(job_read_lock);
+				job_hash_stats(&hash_size, &hash_cnt,
+					       &hash_max_chain);
+				unlock_slurmctld(job_read_lock);
+				pack32(hash_size, buffer);
+				pack32(hash_cnt, buffer);
+				pack32(hash_max_chain, buffer);
+				pack32(slurmctld_diag_stats.job_hash_resizes,
+				       buffer);
+				pack32(slurmctld_diag_stats.bf_resumes, buffer);
+				pack32(slurmctld_diag_stats.bf_restarts, buffer);
+			}
 		}
 	}
 
@@ -142,8 +161,10 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.jobs_failed = 0;
 
 	/* Just resetting this value when reset requested explicitly */
-	if (level)
+	if (level) {
 		slurmctld_diag_stats.backfilled_jobs = 0;
+		slurmctld_diag_stats.job_hash_resizes = 0;
+	}
 
 	slurmctld_diag_stats.last_backfilled_jobs = 0;
 	slurmctld_diag_stats.bf_cycle_counter = 0;
@@ -157,4 +178,6 @@ extern void reset_stats(int level)
 	slurmctld_diag_stats.bf_last_depth = 0;
 	slurmctld_diag_stats.bf_last_depth_try = 0;
 	slurmctld_diag_stats.bf_active = 0;
+	slurmctld_diag_stats.bf_resumes = 0;
+	slurmctld_diag_stats.bf_restarts = 0;
 }
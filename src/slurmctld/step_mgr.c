@@ -174,6 +174,7 @@ static struct step_record * _create_step_record(struct job_record *job_ptr)
 	step_ptr = (struct step_record *) xmalloc(sizeof(struct step_record));
 
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 	step_ptr->job_ptr    = job_ptr;
 	step_ptr->exit_code  = NO_VAL;
 	step_ptr->time_limit = INFINITE;
@@ -219,6 +220,7 @@ extern void delete_step_records (struct job_record *job_ptr)
 	step_iterator = list_iterator_create (job_ptr->step_list);
 
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		list_remove (step_iterator);
 		_free_step_rec(step_ptr);
@@ -281,6 +283,7 @@ delete_step_record (struct job_record *job_ptr, uint32_t step_id)
 
 	step_iterator = list_iterator_create (job_ptr->step_list);
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 	while ((step_ptr = (struct step_record *) list_next (step_iterator))) {
 		if (step_ptr->step_id == step_id) {
 			list_remove (step_iterator);
@@ -601,6 +604,7 @@ int job_step_complete(uint32_t job_id, uint32_t step_id, uid_t uid,
 				 job_id, step_id);
 
 	last_job_update = time(NULL);
+	job_ptr->last_update = last_job_update;
 	error_code = delete_step_record(job_ptr, step_id);
 	if (error_code == ENOENT) {
 		info("job_step_complete step %u.%u not found", job_id,
@@ -2460,8 +2464,6 @@ extern int pack_ctld_job_step_info_response_msg(
 	pack_time(now, buffer);
 	pack32(steps_packed, buffer);	/* steps_packed placeholder */
 
-	part_filter_set(uid);
-
 	job_iterator = list_iterator_create(job_list);
 	while ((job_ptr = list_next(job_iterator))) {
 		if ((job_id != NO_VAL) && (job_id != job_ptr->job_id) &&
@@ -2470,7 +2472,7 @@ extern int pack_ctld_job_step_info_response_msg(
 
 		if (((show_flags & SHOW_ALL) == 0) &&
 		    (job_ptr->part_ptr) &&
-		    (job_ptr->part_ptr->flags & PART_FLAG_HIDDEN))
+		    !part_is_visible(job_ptr->part_ptr, uid))
 			continue;
 
 		if ((slurmctld_conf.private_data & PRIVATE_DATA_JOBS) &&
@@ -2497,8 +2499,6 @@ extern int pack_ctld_job_step_info_response_msg(
 	if (list_count(job_list) && !valid_job && !steps_packed)
 		error_code = ESLURM_INVALID_JOB_ID;
 
-	part_filter_clear();
-
 	/* put the real record count in the message body header */
 	tmp_offset = get_buf_offset(buffer);
 	set_buf_offset(buffer, 0);
@@ -2610,6 +2610,7 @@ extern int job_step_checkpoint(checkpoint_msg_t *ckpt_ptr,
 				   &resp_data.error_code,
 				   &resp_data.error_msg);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
     reply:
@@ -2676,6 +2677,7 @@ extern int job_step_checkpoint_comp(checkpoint_comp_msg_t *ckpt_ptr,
 		rc = checkpoint_comp((void *)step_ptr, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
     reply:
@@ -2735,6 +2737,7 @@ extern int job_step_checkpoint_task_comp(checkpoint_task_comp_msg_t *ckpt_ptr,
 			ckpt_ptr->task_id, ckpt_ptr->begin_time,
 			ckpt_ptr->error_code, ckpt_ptr->error_msg);
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
 	}
 
     reply:
@@ -3411,6 +3414,7 @@ extern void step_checkpoint(void)
 				       (uint16_t)NO_VAL);
 			job_ptr->ckpt_time = now;
 			last_job_update = now;
+			job_ptr->last_update = now;
 			continue; /* ignore periodic step ckpt */
 		}
 		step_iterator = list_iterator_create (job_ptr->step_list);
@@ -3437,6 +3441,7 @@ extern void step_checkpoint(void)
 
 			step_ptr->ckpt_time = now;
 			last_job_update = now;
+			job_ptr->last_update = now;
 			image_dir = xstrdup(step_ptr->ckpt_dir);
 			xstrfmtcat(image_dir, "/%u.%u", job_ptr->job_id,
 				   step_ptr->step_id);
@@ -3623,8 +3628,10 @@ extern int update_step(step_update_request_msg_t *req, uid_t uid)
 		} else
 			return ESLURM_INVALID_JOB_ID;
 	}
-	if (mod_cnt)
+	if (mod_cnt) {
 		last_job_update = time(NULL);
+		job_ptr->last_update = last_job_update;
+	}
 
 	return SLURM_SUCCESS;
 }
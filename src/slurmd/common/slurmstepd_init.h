@@ -51,7 +51,8 @@
 typedef enum slurmd_step_tupe {
 	LAUNCH_BATCH_JOB = 0,
 	LAUNCH_TASKS,
-	DEFUNCT_SPAWN_TASKS /* DEFUNCT */
+	DEFUNCT_SPAWN_TASKS, /* DEFUNCT */
+	STEPD_POOL_INIT	/* pre-started, launch request follows later */
 } slurmd_step_type_t;
 
 /*
@@ -84,6 +84,7 @@
 
 #include "src/slurmd/slurmd/get_mach_stat.h"
 #include "src/slurmd/slurmd/slurmd.h"
+#include "src/slurmd/slurmd/req.h"
 #include "src/slurmd/slurmd/reverse_tree_math.h"
 #include "src/slurmd/slurmd/xcpu.h"
 
@@ -217,6 +218,25 @@ static pthread_mutex_t job_limits_mutex = PTHREAD_MUTEX_INITIALIZER;
 static List job_limits_list = NULL;
 static bool job_limits_loaded = false;
 
+/*
+ * Pool of slurmstepd processes started ahead of need, SlurmstepdPoolSize
+ * of them.  Each has read the slurmd configuration and loaded its plugins,
+ * and waits on its stdin pipe for the rest of the launch data.
+ */
+typedef struct stepd_pool_entry {
+	int to_stepd;		/* write end of the slurmstepd's stdin */
+	int to_slurmd;		/* read end of the slurmstepd's stdout */
+} stepd_pool_entry_t;
+
+static pthread_mutex_t stepd_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t stepd_pool_fill_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  stepd_pool_cond = PTHREAD_COND_INITIALIZER;
+static stepd_pool_entry_t *stepd_pool = NULL;
+static int stepd_pool_cnt = 0;		/* waiting entries in stepd_pool */
+static bool stepd_pool_agent = false;	/* _stepd_pool_agent() started */
+static bool stepd_pool_fill_req = false;/* agent to refill the pool */
+static bool stepd_pool_fini_req = false;/* agent to exit */
+
 #define FINI_JOB_CNT 32
 static pthread_mutex_t fini_mutex = PTHREAD_MUTEX_INITIALIZER;
 static uint32_t fini_job_id[FINI_JOB_CNT];
@@ -261,6 +281,7 @@ slurmd_req(slurm_msg_t *msg)
 		_rpc_batch_job(msg, true);
 		last_slurmctld_msg = time(NULL);
 		slurm_free_job_launch_msg(msg->data);
+		stepd_pool_fill();
 		break;
 	case REQUEST_LAUNCH_TASKS:
 		debug2("Processing RPC: REQUEST_LAUNCH_TASKS");
@@ -268,6 +289,7 @@ slurmd_req(slurm_msg_t *msg)
 		_rpc_launch_tasks(msg);
 		slurm_free_launch_tasks_request_msg(msg->data);
 		slurm_mutex_unlock(&launch_mutex);
+		stepd_pool_fill();
 		break;
 	case REQUEST_SIGNAL_TASKS:
 		debug2("Processing RPC: REQUEST_SIGNAL_TASKS");
@@ -441,10 +463,15 @@ static int _send_slurmd_conf_lite (int fd, slurmd_conf_t *cf)
 	return (-1);
 }
 
+/*
+ * Send a slurmstepd the data for launching a job or job step.  A
+ * pre-started slurmstepd already has the slurmd configuration, so
+ * send_conf is false for one.
+ */
 static int
 _send_slurmstepd_init(int fd, slurmd_step_type_t type, void *req,
 		      slurm_addr_t *cli, slurm_addr_t *self,
-		      hostset_t step_hset)
+		      hostset_t step_hset, bool send_conf)
 {
 	int len = 0;
 	Buf buffer = NULL;
@@ -538,7 +565,7 @@ _send_slurmstepd_init(int fd, slurmd_step_type_t type, void *req,
 	safe_write(fd, &parent_addr, sizeof(slurm_addr_t));
 
 	/* send conf over to slurmstepd */
-	if (_send_slurmd_conf_lite(fd, conf) < 0)
+	if (send_conf && (_send_slurmd_conf_lite(fd, conf) < 0))
 		goto rwfail;
 
 	/* send cli address over to slurmstepd */
@@ -632,87 +659,25 @@ rwfail:
 
 
 /*
- * Fork and exec the slurmstepd, then send the slurmstepd its
- * initialization data.  Then wait for slurmstepd to send an "ok"
- * message before returning.  When the "ok" message is received,
- * the slurmstepd has created and begun listening on its unix
- * domain socket.
- *
- * Note that this code forks twice and it is the grandchild that
- * becomes the slurmstepd process, so the slurmstepd's parent process
- * will be init, not slurmd.
+ * Fork a child which forks again and exits, so that the grandchild, which
+ * execs the slurmstepd with to_stepd as its stdin and to_slurmd as its
+ * stdout, has init rather than slurmd as its parent.
+ * RET the child's pid for the caller to reap, or -1 on error
  */
-static int
-_forkexec_slurmstepd(slurmd_step_type_t type, void *req,
-		     slurm_addr_t *cli, slurm_addr_t *self,
-		     const hostset_t step_hset)
+static pid_t
+_fork_slurmstepd(int to_stepd[2], int to_slurmd[2])
 {
 	pid_t pid;
-	int to_stepd[2] = {-1, -1};
-	int to_slurmd[2] = {-1, -1};
-
-	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
-		error("_forkexec_slurmstepd pipe failed: %m");
-		return SLURM_FAILURE;
-	}
-
-	if (_add_starting_step(type, req)) {
-		error("_forkexec_slurmstepd failed in _add_starting_step: %m");
-		return SLURM_FAILURE;
-	}
 
 	if ((pid = fork()) < 0) {
 		error("_forkexec_slurmstepd: fork: %m");
-		close(to_stepd[0]);
-		close(to_stepd[1]);
-		close(to_slurmd[0]);
-		close(to_slurmd[1]);
-		_remove_starting_step(type, req);
-		return SLURM_FAILURE;
+		return -1;
 	} else if (pid > 0) {
-		int rc = 0;
-		time_t start_time = time(NULL);
-		/*
-		 * Parent sends initialization data to the slurmstepd
-		 * over the to_stepd pipe, and waits for the return code
-		 * reply on the to_slurmd pipe.
-		 */
 		if (close(to_stepd[0]) < 0)
 			error("Unable to close read to_stepd in parent: %m");
 		if (close(to_slurmd[1]) < 0)
 			error("Unable to close write to_slurmd in parent: %m");
-
-		if ((rc = _send_slurmstepd_init(to_stepd[1], type,
-						req, cli, self,
-						step_hset)) != 0) {
-			error("Unable to init slurmstepd");
-			goto done;
-		}
-		if (read(to_slurmd[0], &rc, sizeof(int)) != sizeof(int)) {
-			error("Error reading return code message "
-			      "from slurmstepd: %m");
-			rc = SLURM_FAILURE;
-		} else {
-			int delta_time = time(NULL) - start_time;
-			if (delta_time > 5) {
-				info("Warning: slurmstepd startup took %d sec, "
-				     "possible file system problem or full "
-				     "memory", delta_time);
-			}
-		}
-
-	done:
-		if (_remove_starting_step(type, req))
-			error("Error cleaning up starting_step list");
-
-		/* Reap child */
-		if (waitpid(pid, NULL, 0) < 0)
-			error("Unable to reap slurmd child process");
-		if (close(to_stepd[1]) < 0)
-			error("close write to_stepd in parent: %m");
-		if (close(to_slurmd[0]) < 0)
-			error("close read to_slurmd in parent: %m");
-		return rc;
+		return pid;
 	} else {
 		char *const argv[2] = { (char *)conf->stepd_loc, NULL};
 		int failed = 0;
@@ -767,6 +732,282 @@ _forkexec_slurmstepd(slurmd_step_type_t type, void *req,
 	}
 }
 
+/*
+ * Send the slurmstepd its initialization data, then wait for it to send
+ * an "ok" message, meaning it has created and begun listening on its
+ * unix domain socket.  *gone is set if the slurmstepd had already exited.
+ */
+static int
+_init_slurmstepd(int to_stepd, int to_slurmd, slurmd_step_type_t type,
+		 void *req, slurm_addr_t *cli, slurm_addr_t *self,
+		 const hostset_t step_hset, bool send_conf, bool *gone)
+{
+	int rc = 0;
+	time_t start_time = time(NULL);
+
+	*gone = false;
+	if ((rc = _send_slurmstepd_init(to_stepd, type, req, cli, self,
+					step_hset, send_conf)) != 0) {
+		*gone = (rc == EPIPE);
+		error("Unable to init slurmstepd");
+		return rc;
+	}
+	if (read(to_slurmd, &rc, sizeof(int)) != sizeof(int)) {
+		error("Error reading return code message "
+		      "from slurmstepd: %m");
+		rc = SLURM_FAILURE;
+	} else {
+		int delta_time = time(NULL) - start_time;
+		if (delta_time > 5) {
+			info("Warning: slurmstepd startup took %d sec, "
+			     "possible file system problem or full "
+			     "memory", delta_time);
+		}
+	}
+	return rc;
+}
+
+/* Take the longest waiting slurmstepd from the pool, if any. The most
+ * recently started ones may still be loading their plugins. */
+static bool
+_stepd_pool_get(int *to_stepd, int *to_slurmd)
+{
+	bool found = false;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if (stepd_pool_cnt > 0) {
+		*to_stepd  = stepd_pool[0].to_stepd;
+		*to_slurmd = stepd_pool[0].to_slurmd;
+		stepd_pool_cnt--;
+		memmove(&stepd_pool[0], &stepd_pool[1],
+			sizeof(stepd_pool_entry_t) * stepd_pool_cnt);
+		found = true;
+	}
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	return found;
+}
+
+/* Start a slurmstepd, send it the slurmd configuration and add it to the
+ * pool. It loads its plugins, then waits for a launch request. */
+static int
+_stepd_pool_add(void)
+{
+	pid_t pid;
+	int to_stepd[2] = {-1, -1};
+	int to_slurmd[2] = {-1, -1};
+	int type = STEPD_POOL_INIT;
+
+	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
+		error("stepd_pool_fill pipe failed: %m");
+		return SLURM_FAILURE;
+	}
+	/* Keep later slurmstepds and scripts from holding the pipes open */
+	fd_set_close_on_exec(to_stepd[1]);
+	fd_set_close_on_exec(to_slurmd[0]);
+
+	if ((pid = _fork_slurmstepd(to_stepd, to_slurmd)) < 0) {
+		close(to_stepd[0]);
+		close(to_stepd[1]);
+		close(to_slurmd[0]);
+		close(to_slurmd[1]);
+		return SLURM_FAILURE;
+	}
+	if (waitpid(pid, NULL, 0) < 0)
+		error("Unable to reap slurmd child process");
+
+	safe_write(to_stepd[1], &type, sizeof(int));
+	if (_send_slurmd_conf_lite(to_stepd[1], conf) < 0)
+		goto rwfail;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	xrealloc(stepd_pool, sizeof(stepd_pool_entry_t) *
+		 (stepd_pool_cnt + 1));
+	stepd_pool[stepd_pool_cnt].to_stepd  = to_stepd[1];
+	stepd_pool[stepd_pool_cnt].to_slurmd = to_slurmd[0];
+	stepd_pool_cnt++;
+	slurm_mutex_unlock(&stepd_pool_mutex);
+	return SLURM_SUCCESS;
+
+rwfail:
+	error("Unable to send configuration to pooled slurmstepd");
+	close(to_stepd[1]);
+	close(to_slurmd[0]);
+	return SLURM_FAILURE;
+}
+
+/* Refill the pool whenever stepd_pool_fill() asks, so that the fork and
+ * exec of new slurmstepds is not done by the RPC threads launching steps */
+static void *
+_stepd_pool_agent(void *arg)
+{
+	int need;
+
+	while (1) {
+		slurm_mutex_lock(&stepd_pool_mutex);
+		while (!stepd_pool_fill_req && !stepd_pool_fini_req)
+			pthread_cond_wait(&stepd_pool_cond, &stepd_pool_mutex);
+		if (stepd_pool_fini_req) {
+			stepd_pool_agent = false;
+			pthread_cond_broadcast(&stepd_pool_cond);
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			break;
+		}
+		stepd_pool_fill_req = false;
+		slurm_mutex_unlock(&stepd_pool_mutex);
+
+		slurm_mutex_lock(&stepd_pool_fill_mutex);
+		while (1) {
+			slurm_mutex_lock(&stepd_pool_mutex);
+			need = conf->stepd_pool_size - stepd_pool_cnt;
+			if (stepd_pool_fini_req)
+				need = 0;
+			slurm_mutex_unlock(&stepd_pool_mutex);
+			if ((need <= 0) || (_stepd_pool_add() != SLURM_SUCCESS))
+				break;
+		}
+		slurm_mutex_unlock(&stepd_pool_fill_mutex);
+	}
+
+	return NULL;
+}
+
+void
+stepd_pool_fill(void)
+{
+	pthread_attr_t attr;
+	pthread_t id;
+
+	slurm_mutex_lock(&stepd_pool_mutex);
+	if ((conf->stepd_pool_size == 0) || stepd_pool_fini_req) {
+		slurm_mutex_unlock(&stepd_pool_mutex);
+		return;
+	}
+	if (!stepd_pool_agent) {
+		slurm_attr_init(&attr);
+		pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+		if (pthread_create(&id, &attr, &_stepd_pool_agent, NULL))
+			error("stepd_pool_fill: pthread_create: %m");
+		else
+			stepd_pool_agent = true;
+		slurm_attr_destroy(&attr);
+	}
+	stepd_pool_fill_req = true;
+	pthread_cond_signal(&stepd_pool_cond);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+}
+
+void
+stepd_pool_flush(void)
+{
+	int i;
+
+	/* A slurmstepd exits when it reads end of file while waiting */
+	slurm_mutex_lock(&stepd_pool_fill_mutex);
+	slurm_mutex_lock(&stepd_pool_mutex);
+	for (i = 0; i < stepd_pool_cnt; i++) {
+		close(stepd_pool[i].to_stepd);
+		close(stepd_pool[i].to_slurmd);
+	}
+	stepd_pool_cnt = 0;
+	slurm_mutex_unlock(&stepd_pool_mutex);
+	slurm_mutex_unlock(&stepd_pool_fill_mutex);
+}
+
+void
+stepd_pool_fini(void)
+{
+	slurm_mutex_lock(&stepd_pool_mutex);
+	stepd_pool_fini_req = true;
+	pthread_cond_broadcast(&stepd_pool_cond);
+	while (stepd_pool_agent)
+		pthread_cond_wait(&stepd_pool_cond, &stepd_pool_mutex);
+	slurm_mutex_unlock(&stepd_pool_mutex);
+
+	stepd_pool_flush();
+	xfree(stepd_pool);
+}
+
+/*
+ * Fork and exec the slurmstepd, or take one from the pool of pre-started
+ * slurmstepds, then send the slurmstepd its initialization data.  Then
+ * wait for slurmstepd to send an "ok" message before returning.  When the
+ * "ok" message is received, the slurmstepd has created and begun
+ * listening on its unix domain socket.
+ *
+ * Note that this code forks twice and it is the grandchild that
+ * becomes the slurmstepd process, so the slurmstepd's parent process
+ * will be init, not slurmd.
+ */
+static int
+_forkexec_slurmstepd(slurmd_step_type_t type, void *req,
+		     slurm_addr_t *cli, slurm_addr_t *self,
+		     const hostset_t step_hset)
+{
+	pid_t pid;
+	int to_stepd[2] = {-1, -1};
+	int to_slurmd[2] = {-1, -1};
+	int rc;
+	bool gone;
+
+	if (_add_starting_step(type, req)) {
+		error("_forkexec_slurmstepd failed in _add_starting_step: %m");
+		return SLURM_FAILURE;
+	}
+
+	/*
+	 * A pooled slurmstepd that cannot be sent the request (it has
+	 * exited) has not started anything, so fall back to a new one.
+	 */
+	while (_stepd_pool_get(&to_stepd[1], &to_slurmd[0])) {
+		rc = _init_slurmstepd(to_stepd[1], to_slurmd[0], type, req,
+				      cli, self, step_hset, false, &gone);
+		close(to_stepd[1]);
+		close(to_slurmd[0]);
+		if (!gone) {
+			if (_remove_starting_step(type, req))
+				error("Error cleaning up starting_step list");
+			return rc;
+		}
+		debug("Pooled slurmstepd has exited, trying another");
+	}
+
+	if (pipe(to_stepd) < 0 || pipe(to_slurmd) < 0) {
+		error("_forkexec_slurmstepd pipe failed: %m");
+		_remove_starting_step(type, req);
+		return SLURM_FAILURE;
+	}
+
+	if ((pid = _fork_slurmstepd(to_stepd, to_slurmd)) < 0) {
+		close(to_stepd[0]);
+		close(to_stepd[1]);
+		close(to_slurmd[0]);
+		close(to_slurmd[1]);
+		_remove_starting_step(type, req);
+		return SLURM_FAILURE;
+	}
+
+	/*
+	 * Parent sends initialization data to the slurmstepd
+	 * over the to_stepd pipe, and waits for the return code
+	 * reply on the to_slurmd pipe.
+	 */
+	rc = _init_slurmstepd(to_stepd[1], to_slurmd[0], type, req, cli, self,
+			      step_hset, true, &gone);
+
+	if (_remove_starting_step(type, req))
+		error("Error cleaning up starting_step list");
+
+	/* Reap child */
+	if (waitpid(pid, NULL, 0) < 0)
+		error("Unable to reap slurmd child process");
+	if (close(to_stepd[1]) < 0)
+		error("close write to_stepd in parent: %m");
+	if (close(to_slurmd[0]) < 0)
+		error("close read to_slurmd in parent: %m");
+	return rc;
+}
+
 
 /*
  * The job(step) credential is the only place to get a definitive
@@ -2316,6 +2557,8 @@ _rpc_daemon_status(slurm_msg_t *msg)
 	resp->step_list          = _get_step_list();
 	resp->last_slurmctld_msg = last_slurmctld_msg;
 	resp->pid                = conf->pid;
+	slurmd_rpc_stats(&resp->rpc_threads, &resp->rpc_queue_depth,
+			 &resp->rpc_queue_max);
 	resp->slurmd_debug       = conf->debug_level;
 	resp->slurmd_logfile     = xstrdup(conf->logfile);
 	resp->version            = xstrdup(SLURM_VERSION_STRING);
@@ -50,6 +50,18 @@ void slurmd_req(slurm_msg_t *msg);
 
 void destroy_starting_step(void *x);
 
-int init_gids_cache(int cache);
+/* Have a separate thread start slurmstepd processes until
+ * SlurmstepdPoolSize of them are waiting for a launch request */
+void stepd_pool_fill(void);
+
+/* Terminate the waiting slurmstepd processes, such as after the
+ * configuration they were started with has changed */
+void stepd_pool_flush(void);
+
+/* Stop the thread filling the pool and terminate the waiting slurmstepd
+ * processes, at slurmd shutdown */
+void stepd_pool_fini(void);
+
+void init_gids_cache(int cache);
 
 #endif
@@ -108,6 +108,7 @@
 #endif
 
 #define MAX_THREADS		130
+#define MAX_RPC_QUEUE		MAX_THREADS
 
 /* global, copied to STDERR_FILENO in tasks before the exec */
 int devnull = -1;
@@ -125,8 +126,37 @@ static pthread_mutex_t fork_mutex     = PTHREAD_MUTEX_INITIALIZER;
 typedef struct connection {
 	slurm_fd_t fd;
 	slurm_addr_t *cli_addr;
+	slurm_msg_t *msg;	/* NULL until the message has been read */
 } conn_t;
 
+/*
+ * RPC priority classes. Queued RPCs are serviced in this order, with
+ * connections whose message has not yet been read ahead of normal ones.
+ */
+enum {
+	RPC_PRIO_HIGH,		/* job launch, signal and termination */
+	RPC_PRIO_NORMAL,
+	RPC_PRIO_LOW,		/* ping, registration and status */
+	RPC_PRIO_CNT
+};
+
+/*
+ * RPC worker thread pool. Accepted connections wait in conn_queue for a
+ * worker to read their message, and then in rpc_queue by priority class
+ * while all workers are busy. Workers are started as needed, up to
+ * MAX_THREADS, and wait for more work when idle. Once MAX_RPC_QUEUE RPCs
+ * are waiting, no more connections are accepted until a worker takes one.
+ */
+static List            conn_queue = NULL;
+static List            rpc_queue[RPC_PRIO_CNT] = { NULL };
+static int             rpc_queue_depth = 0;
+static int             rpc_queue_max = 0;
+static int             rpc_workers = 0;
+static int             rpc_workers_idle = 0;
+static pthread_mutex_t rpc_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  rpc_cond  = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  rpc_space_cond = PTHREAD_COND_INITIALIZER;
+
 
 
 /*
@@ -144,6 +174,7 @@ static void      _decrement_thd_count(void);
 static void      _destroy_conf(void);
 static int       _drain_node(char *reason);
 static void      _fill_registration_msg(slurm_node_registration_status_msg_t *);
+static void      _free_conn(void *x);
 static void      _handle_connection(slurm_fd_t fd, slurm_addr_t *client);
 static void      _hup_handler(int);
 static void      _increment_thd_count(void);
@@ -158,12 +189,18 @@ static void      _read_config(void);
 static void      _reconfigure(void);
 static void     *_registration_engine(void *arg);
 static int       _restore_cred_state(slurm_cred_ctx_t ctx);
-static void     *_service_connection(void *);
+static conn_t   *_rpc_dequeue(void);
+static void      _rpc_pool_fini(void);
+static int       _rpc_priority(uint16_t msg_type);
+static bool      _rpc_requeue(conn_t *con);
+static void     *_rpc_worker(void *arg);
+static void      _service_connection(conn_t *con);
 static int       _set_slurmd_spooldir(void);
 static int       _set_topo_info(void);
 static int       _slurmd_init(void);
 static int       _slurmd_fini(void);
 static void      _spawn_registration_engine(void);
+static int       _spawn_rpc_worker(void);
 static void      _term_handler(int);
 static void      _update_logging(void);
 static void      _update_nice(void);
@@ -316,6 +353,7 @@ main (int argc, char *argv[])
 	slurm_conf_install_fork_handlers();
 
 	_spawn_registration_engine();
+	stepd_pool_fill();
 	_msg_engine();
 
 	/*
@@ -328,6 +366,8 @@ main (int argc, char *argv[])
 		error("Unable to remove pidfile `%s': %m", conf->pidfile);
 
 	_wait_for_all_threads();
+	_rpc_pool_fini();
+	stepd_pool_fini();
 
 	interconnect_node_fini();
 
@@ -396,6 +436,11 @@ _msg_engine(void)
 {
 	slurm_addr_t *cli;
 	slurm_fd_t sock;
+	int i;
+
+	conn_queue = list_create(_free_conn);
+	for (i = 0; i < RPC_PRIO_CNT; i++)
+		rpc_queue[i] = list_create(_free_conn);
 
 	msg_pthread = pthread_self();
 	slurmd_req(NULL);	/* initialize timer */
@@ -420,6 +465,11 @@ _msg_engine(void)
 	}
 	verbose("got shutdown request");
 	slurm_shutdown_msg_engine(conf->lfd);
+
+	/* Idle workers exit once the queued RPCs are serviced */
+	slurm_mutex_lock(&rpc_mutex);
+	pthread_cond_broadcast(&rpc_cond);
+	slurm_mutex_unlock(&rpc_mutex);
 	return;
 }
 
@@ -480,63 +530,258 @@ _wait_for_all_threads(void)
 
 static void
 _handle_connection(slurm_fd_t fd, slurm_addr_t *cli)
+{
+	conn_t *arg = xmalloc(sizeof(conn_t));
+	bool    spawn, logged = false;
+	struct timespec ts;
+
+	arg->fd       = fd;
+	arg->cli_addr = cli;
+
+	fd_set_close_on_exec(fd);
+
+	/* Leave further connections in the listen backlog while the queue
+	 * is full, so senders wait on connect() rather than on a queued
+	 * connection that may time out before it is serviced. The wait is
+	 * timed to notice a shutdown. */
+	slurm_mutex_lock(&rpc_mutex);
+	while ((rpc_queue_depth >= MAX_RPC_QUEUE) && rpc_workers &&
+	       !_shutdown) {
+		if (!logged) {
+			info("rpc_queue_depth == MAX_RPC_QUEUE(%d)",
+			     MAX_RPC_QUEUE);
+			logged = true;
+		}
+		ts.tv_sec  = time(NULL) + 1;
+		ts.tv_nsec = 0;
+		pthread_cond_timedwait(&rpc_space_cond, &rpc_mutex, &ts);
+	}
+	list_enqueue(conn_queue, arg);
+	if (++rpc_queue_depth > rpc_queue_max)
+		rpc_queue_max = rpc_queue_depth;
+	if (rpc_workers_idle)
+		pthread_cond_signal(&rpc_cond);
+	spawn = (rpc_queue_depth > rpc_workers_idle) &&
+		(rpc_workers < MAX_THREADS);
+	if (spawn)
+		rpc_workers++;
+	slurm_mutex_unlock(&rpc_mutex);
+
+	if (!spawn || (_spawn_rpc_worker() == SLURM_SUCCESS))
+		return;
+
+	slurm_mutex_lock(&rpc_mutex);
+	rpc_workers--;
+	arg = rpc_workers ? NULL : _rpc_dequeue();
+	slurm_mutex_unlock(&rpc_mutex);
+	if (arg) {
+		error("running service_connection without starting "
+		      "a new thread slurmd will be "
+		      "unresponsive until done");
+		_increment_thd_count();
+		_service_connection(arg);
+		_decrement_thd_count();
+		info("slurmd should be responsive now");
+	}
+}
+
+static int
+_spawn_rpc_worker(void)
 {
 	int            rc;
 	pthread_attr_t attr;
 	pthread_t      id;
-	conn_t         *arg = xmalloc(sizeof(conn_t));
 	int            retries = 0;
 
-	arg->fd       = fd;
-	arg->cli_addr = cli;
-
 	slurm_attr_init(&attr);
 	rc = pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
 	if (rc != 0) {
 		errno = rc;
-		xfree(arg);
 		error("Unable to set detachstate on attr: %m");
 		slurm_attr_destroy(&attr);
-		return;
+		return SLURM_ERROR;
 	}
 
-	fd_set_close_on_exec(fd);
-
-	_increment_thd_count();
-	while (pthread_create(&id, &attr, &_service_connection, (void *)arg)) {
+	while (pthread_create(&id, &attr, &_rpc_worker, NULL)) {
 		error("msg_engine: pthread_create: %m");
 		if (++retries > 3) {
-			error("running service_connection without starting "
-			      "a new thread slurmd will be "
-			      "unresponsive until done");
-
-			_service_connection((void *) arg);
-			info("slurmd should be responsive now");
-			break;
+			slurm_attr_destroy(&attr);
+			return SLURM_ERROR;
 		}
 		usleep(10);	/* sleep and again */
 	}
+	slurm_attr_destroy(&attr);
 
-	return;
+	return SLURM_SUCCESS;
 }
 
+/* Service queued RPCs until shutdown. rpc_workers already counts this
+ * thread. */
 static void *
-_service_connection(void *arg)
+_rpc_worker(void *arg)
+{
+	conn_t *con;
+
+	slurm_mutex_lock(&rpc_mutex);
+	while (1) {
+		while (!(con = _rpc_dequeue()) && !_shutdown) {
+			rpc_workers_idle++;
+			pthread_cond_wait(&rpc_cond, &rpc_mutex);
+			rpc_workers_idle--;
+		}
+		if (con == NULL)
+			break;
+		slurm_mutex_unlock(&rpc_mutex);
+
+		_increment_thd_count();
+		_service_connection(con);
+		_decrement_thd_count();
+
+		slurm_mutex_lock(&rpc_mutex);
+	}
+	rpc_workers--;
+	pthread_cond_broadcast(&rpc_cond);
+	slurm_mutex_unlock(&rpc_mutex);
+
+	return NULL;
+}
+
+/* Wait for the workers to exit once the queued RPCs are serviced, then
+ * free the queues */
+static void
+_rpc_pool_fini(void)
+{
+	struct timespec ts;
+	int i;
+
+	ts.tv_sec  = time(NULL) + 10;
+	ts.tv_nsec = 0;
+
+	slurm_mutex_lock(&rpc_mutex);
+	pthread_cond_broadcast(&rpc_cond);
+	while (rpc_workers > 0) {
+		if (pthread_cond_timedwait(&rpc_cond, &rpc_mutex, &ts) ==
+		    ETIMEDOUT) {
+			error("Timeout waiting for %d RPC workers",
+			      rpc_workers);
+			slurm_mutex_unlock(&rpc_mutex);
+			return;
+		}
+	}
+	if (conn_queue) {
+		list_destroy(conn_queue);
+		conn_queue = NULL;
+	}
+	for (i = 0; i < RPC_PRIO_CNT; i++) {
+		if (rpc_queue[i]) {
+			list_destroy(rpc_queue[i]);
+			rpc_queue[i] = NULL;
+		}
+	}
+	rpc_queue_depth = 0;
+	slurm_mutex_unlock(&rpc_mutex);
+}
+
+/* Remove and return the next RPC to service, NULL if none are queued.
+ * Call with rpc_mutex locked. */
+static conn_t *
+_rpc_dequeue(void)
+{
+	conn_t *con;
+
+	if (!(con = list_dequeue(rpc_queue[RPC_PRIO_HIGH])) &&
+	    !(con = list_dequeue(conn_queue)) &&
+	    !(con = list_dequeue(rpc_queue[RPC_PRIO_NORMAL])))
+		con = list_dequeue(rpc_queue[RPC_PRIO_LOW]);
+	if (con && (rpc_queue_depth-- == MAX_RPC_QUEUE))
+		pthread_cond_signal(&rpc_space_cond);
+
+	return con;
+}
+
+static int
+_rpc_priority(uint16_t msg_type)
+{
+	switch (msg_type) {
+	case REQUEST_BATCH_JOB_LAUNCH:
+	case REQUEST_LAUNCH_TASKS:
+	case REQUEST_SIGNAL_TASKS:
+	case REQUEST_TERMINATE_TASKS:
+	case REQUEST_KILL_PREEMPTED:
+	case REQUEST_KILL_TIMELIMIT:
+	case REQUEST_SIGNAL_JOB:
+	case REQUEST_SUSPEND:
+	case REQUEST_SUSPEND_INT:
+	case REQUEST_ABORT_JOB:
+	case REQUEST_TERMINATE_JOB:
+		return RPC_PRIO_HIGH;
+	case REQUEST_PING:
+	case REQUEST_HEALTH_CHECK:
+	case REQUEST_ACCT_GATHER_UPDATE:
+	case REQUEST_NODE_REGISTRATION_STATUS:
+	case REQUEST_JOB_STEP_STAT:
+	case REQUEST_JOB_STEP_PIDS:
+	case REQUEST_DAEMON_STATUS:
+		return RPC_PRIO_LOW;
+	default:
+		return RPC_PRIO_NORMAL;
+	}
+}
+
+/*
+ * Queue a connection whose message has just been read if an RPC of a
+ * higher class (or an unread connection, for normal and low RPCs) is
+ * waiting, so that it gets serviced first.
+ * RET true if queued, false if the caller should service it now
+ */
+static bool
+_rpc_requeue(conn_t *con)
 {
-	conn_t *con = (conn_t *) arg;
-	slurm_msg_t *msg = xmalloc(sizeof(slurm_msg_t));
+	int prio = _rpc_priority(con->msg->msg_type);
+	bool queued = false;
+
+	if (prio == RPC_PRIO_HIGH)
+		return false;
+
+	slurm_mutex_lock(&rpc_mutex);
+	if (!list_is_empty(rpc_queue[RPC_PRIO_HIGH]) ||
+	    !list_is_empty(conn_queue) ||
+	    ((prio == RPC_PRIO_LOW) &&
+	     !list_is_empty(rpc_queue[RPC_PRIO_NORMAL]))) {
+		list_enqueue(rpc_queue[prio], con);
+		if (++rpc_queue_depth > rpc_queue_max)
+			rpc_queue_max = rpc_queue_depth;
+		queued = true;
+	}
+	slurm_mutex_unlock(&rpc_mutex);
+
+	return queued;
+}
+
+static void
+_service_connection(conn_t *con)
+{
+	slurm_msg_t *msg = con->msg;
 	int rc = SLURM_SUCCESS;
 
-	debug3("in the service_connection");
-	slurm_msg_t_init(msg);
-	if ((rc = slurm_receive_msg_and_forward(con->fd, con->cli_addr, msg, 0))
-	   != SLURM_SUCCESS) {
-		error("service_connection: slurm_receive_msg: %m");
-		/* if this fails we need to make sure the nodes we forward
-		   to are taken care of and sent back. This way the control
-		   also has a better idea what happened to us */
-		slurm_send_rc_msg(msg, rc);
-		goto cleanup;
+	if (msg == NULL) {
+		debug3("in the service_connection");
+		msg = xmalloc(sizeof(slurm_msg_t));
+		slurm_msg_t_init(msg);
+		if ((rc = slurm_receive_msg_and_forward(con->fd, con->cli_addr,
+							msg, 0))
+		    != SLURM_SUCCESS) {
+			error("service_connection: slurm_receive_msg: %m");
+			/* if this fails we need to make sure the nodes we
+			   forward to are taken care of and sent back. This
+			   way the control also has a better idea what
+			   happened to us */
+			slurm_send_rc_msg(msg, rc);
+			goto cleanup;
+		}
+		con->msg = msg;
+		if (_rpc_requeue(con))
+			return;
 	}
 	debug2("got this type of message %d", msg->msg_type);
 	slurmd_req(msg);
@@ -548,8 +793,31 @@ cleanup:
 	xfree(con->cli_addr);
 	xfree(con);
 	slurm_free_msg(msg);
-	_decrement_thd_count();
-	return NULL;
+}
+
+/* Close and free a connection left queued at shutdown */
+static void
+_free_conn(void *x)
+{
+	conn_t *con = (conn_t *) x;
+
+	if (slurm_close_accepted_conn(con->fd) < 0)
+		error ("close(%d): %m", con->fd);
+	xfree(con->cli_addr);
+	if (con->msg)
+		slurm_free_msg(con->msg);
+	xfree(con);
+}
+
+extern void
+slurmd_rpc_stats(uint16_t *threads, uint32_t *queue_depth,
+		 uint32_t *queue_max)
+{
+	slurm_mutex_lock(&rpc_mutex);
+	*threads     = rpc_workers;
+	*queue_depth = rpc_queue_depth;
+	*queue_max   = rpc_queue_max;
+	slurm_mutex_unlock(&rpc_mutex);
 }
 
 extern int
@@ -902,6 +1170,7 @@ _read_config(void)
 	if (cf->slurmctld_port == 0)
 		fatal("Unable to establish controller port");
 	conf->slurmd_timeout = cf->slurmd_timeout;
+	conf->stepd_pool_size = cf->slurmstepd_pool_size;
 	conf->use_pam = cf->use_pam;
 	conf->task_plugin_param = cf->task_plugin_param;
 
@@ -982,6 +1251,10 @@ _reconfigure(void)
 	/* reconfigure energy */
 	acct_gather_energy_g_set_data(ENERGY_DATA_RECONFIG, NULL);
 
+	/* Restart pre-started slurmstepds with the new configuration */
+	stepd_pool_flush();
+	stepd_pool_fill();
+
 	/*
 	 * XXX: reopen slurmd port?
 	 */
@@ -131,6 +131,7 @@ typedef struct slurmd_config {
 	slurm_cred_ctx_t vctx;          /* slurm_cred_t verifier context   */
 
 	uint16_t	slurmd_timeout;	/* SlurmdTimeout                   */
+	uint16_t	stepd_pool_size; /* SlurmstepdPoolSize             */
 	uid_t           slurm_user_id;	/* UID that slurmctld runs as      */
 	pthread_mutex_t config_mutex;	/* lock for slurmd_config access   */
 	uint16_t        job_acct_gather_freq;
@@ -158,6 +159,15 @@ extern slurmd_conf_t * conf;
  */
 int send_registration_msg(uint32_t status, bool startup);
 
+/*
+ * slurmd_rpc_stats - report the state of the RPC worker thread pool
+ * OUT threads - count of RPC worker threads
+ * OUT queue_depth - count of RPCs waiting for a worker
+ * OUT queue_max - largest queue_depth since slurmd started
+ */
+extern void slurmd_rpc_stats(uint16_t *threads, uint32_t *queue_depth,
+			     uint32_t *queue_max);
+
 /*
  * save_cred_state - save the current credential list to a file
  * IN list - list of credentials
@@ -68,6 +68,7 @@
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <fcntl.h>
 #include <unistd.h>
 #include <errno.h>
@@ -92,6 +93,13 @@
 #include "src/slurmd/slurmstepd/fname.h"
 #include "src/slurmd/slurmstepd/slurmstepd.h"
 
+/*
+ * Most queued messages gathered into one writev() to a client, and most
+ * message buffers filled by one readv() from an unbuffered task.
+ */
+#define CLIENT_WRITE_MAX_IOV 64
+#define TASK_READ_MAX_IOV    16
+
 /**********************************************************************
  * IO client socket declarations
  **********************************************************************/
@@ -217,8 +225,13 @@ static int _send_io_init_msg(int sock, srun_key_t *key, slurmd_job_t *job);
 static void _send_eof_msg(struct task_read_info *out);
 static struct io_buf *_task_build_message(struct task_read_info *out,
 					  slurmd_job_t *job, cbuf_t cbuf);
+static void _task_pack_header(struct task_read_info *out,
+			      struct io_buf *msg, int len);
+static int  _task_read_direct(eio_obj_t *obj);
 static void *_io_thr(void *arg);
 static void _route_msg_task_to_client(eio_obj_t *obj);
+static void _route_msg_to_clients(struct task_read_info *out,
+				  struct io_buf *msg);
 static void _free_outgoing_msg(struct io_buf *msg, slurmd_job_t *job);
 static void _free_incoming_msg(struct io_buf *msg, slurmd_job_t *job);
 static void _free_all_outgoing_msgs(List msg_queue, slurmd_job_t *job);
@@ -419,6 +432,7 @@ _client_read(eio_obj_t *obj, List objs)
 				io = (struct task_write_info *)task->in->arg;
 				client->in_msg->ref_count++;
 				list_enqueue(io->msg_queue, client->in_msg);
+				eio_obj_changed(client->job->eio, task->in);
 			}
 			debug5("  message ref_count = %d", client->in_msg->ref_count);
 		} else {
@@ -431,6 +445,7 @@ _client_read(eio_obj_t *obj, List objs)
 					continue;
 				client->in_msg->ref_count++;
 				list_enqueue(io->msg_queue, client->in_msg);
+				eio_obj_changed(client->job->eio, task->in);
 				break;
 			}
 		}
@@ -441,14 +456,19 @@ _client_read(eio_obj_t *obj, List objs)
 }
 
 /*
- * Write outgoing packed messages to the client socket.
+ * Write outgoing packed messages to the client socket.  The rest of the
+ * message in progress and whole messages queued behind it are gathered
+ * into a single writev(), so a client with a deep queue costs one system
+ * call per wakeup rather than one per message.
  */
 static int
 _client_write(eio_obj_t *obj, List objs)
 {
 	struct client_io_info *client = (struct client_io_info *) obj->arg;
-	void *buf;
-	int n;
+	struct iovec iov[CLIENT_WRITE_MAX_IOV];
+	struct io_buf *msg;
+	ListIterator msgs;
+	int iovcnt, n;
 
 	xassert(client->magic == CLIENT_IO_MAGIC);
 
@@ -471,13 +491,26 @@ _client_write(eio_obj_t *obj, List objs)
 
 	debug5("  client->out_remaining = %d", client->out_remaining);
 
+	iov[0].iov_base = client->out_msg->data +
+		(client->out_msg->length - client->out_remaining);
+	iov[0].iov_len = client->out_remaining;
+	iovcnt = 1;
+	if (!list_is_empty(client->msg_queue)) {
+		msgs = list_iterator_create(client->msg_queue);
+		while ((iovcnt < CLIENT_WRITE_MAX_IOV) &&
+		       (msg = list_next(msgs))) {
+			iov[iovcnt].iov_base = msg->data;
+			iov[iovcnt].iov_len = msg->length;
+			iovcnt++;
+		}
+		list_iterator_destroy(msgs);
+	}
+
 	/*
-	 * Write message to socket.
+	 * Write messages to socket.
 	 */
-	buf = client->out_msg->data +
-		(client->out_msg->length - client->out_remaining);
 again:
-	if ((n = write(obj->fd, buf, client->out_remaining)) < 0) {
+	if ((n = writev(obj->fd, iov, iovcnt)) < 0) {
 		if (errno == EINTR) {
 			goto again;
 		} else if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
@@ -489,17 +522,24 @@ again:
 			return SLURM_SUCCESS;
 		}
 	}
-	if (n < client->out_remaining) {
-		error("Only wrote %d of %d bytes to socket", 
-		      n, client->out_remaining);
-	} else
-		debug5("Wrote %d bytes to socket", n);
-	client->out_remaining -= n;
-	if (client->out_remaining > 0)
-		return SLURM_SUCCESS;
+	debug5("Wrote %d bytes in %d messages to socket", n, iovcnt);
 
-	_free_outgoing_msg(client->out_msg, client->job);
-	client->out_msg = NULL;
+	/*
+	 * Release every message written in full.  Freeing a message may
+	 * route more task output, but only onto the tail of msg_queue, so
+	 * the messages gathered above are still at its head.
+	 */
+	while (n >= client->out_remaining) {
+		n -= client->out_remaining;
+		_free_outgoing_msg(client->out_msg, client->job);
+		client->out_msg = NULL;
+		if (n == 0)
+			break;
+		client->out_msg = list_dequeue(client->msg_queue);
+		client->out_remaining = client->out_msg->length;
+	}
+	if (client->out_msg)
+		client->out_remaining -= n;
 
 	return SLURM_SUCCESS;
 }
@@ -727,7 +767,7 @@ _create_task_out_eio(int fd, uint16_t type,
 	out->gtaskid = task->gtid;
 	out->ltaskid = task->id;
 	out->job = job;
-	out->buf = cbuf_create(MAX_MSG_LEN, MAX_MSG_LEN*4);
+	out->buf = cbuf_create(MAX_MSG_LEN, STDIO_MAX_TASK_BUF);
 	out->eof = false;
 	out->eof_msg_sent = false;
 	if (cbuf_opt_set(out->buf, CBUF_OPT_OVERWRITE, CBUF_NO_DROP) == -1)
@@ -762,7 +802,8 @@ _task_readable(eio_obj_t *obj)
 /*
  * Read output (stdout or stderr) from a task into a cbuf.  The cbuf
  * allows whole lines to be packed into messages if line buffering
- * is requested.
+ * is requested.  Without line buffering, and with nothing left in the
+ * cbuf, the output is read straight into outgoing messages instead.
  */
 static int
 _task_read(eio_obj_t *obj, List objs)
@@ -777,8 +818,12 @@ _task_read(eio_obj_t *obj, List objs)
 	len = cbuf_free(out->buf);
 	if (len > 0 && !out->eof) {
 again:
-		if ((rc = cbuf_write_from_fd(out->buf, obj->fd, len, NULL))
-		    < 0) {
+		if (!out->job->buffered_stdio && (cbuf_used(out->buf) == 0) &&
+		    _outgoing_buf_free(out->job))
+			rc = _task_read_direct(obj);
+		else
+			rc = cbuf_write_from_fd(out->buf, obj->fd, len, NULL);
+		if (rc < 0) {
 			if (errno == EINTR)
 				goto again;
 			if ((errno == EAGAIN) || (errno == EWOULDBLOCK)) {
@@ -811,6 +856,45 @@ again:
 	return SLURM_SUCCESS;
 }
 
+/*
+ * Read unbuffered task output with one readv() into the data area of up
+ * to TASK_READ_MAX_IOV free outgoing messages, then route the filled ones
+ * to the clients.  This skips the copy into and back out of the cbuf.
+ * Returns the byte count from readv(), with errno intact if it is -1.
+ */
+static int
+_task_read_direct(eio_obj_t *obj)
+{
+	struct task_read_info *out = (struct task_read_info *)obj->arg;
+	struct io_buf *msg[TASK_READ_MAX_IOV];
+	struct iovec iov[TASK_READ_MAX_IOV];
+	int cnt, i, len, n, rc, save_errno;
+
+	for (cnt = 0; (cnt < TASK_READ_MAX_IOV) &&
+		      _outgoing_buf_free(out->job); cnt++) {
+		msg[cnt] = list_dequeue(out->job->free_outgoing);
+		iov[cnt].iov_base = msg[cnt]->data + io_hdr_packed_size();
+		iov[cnt].iov_len = MAX_MSG_LEN;
+	}
+
+	rc = readv(obj->fd, iov, cnt);
+	save_errno = errno;
+
+	for (i = 0, n = rc; i < cnt; i++) {
+		len = MIN(n, MAX_MSG_LEN);
+		if (len <= 0) {
+			list_enqueue(out->job->free_outgoing, msg[i]);
+			continue;
+		}
+		n -= len;
+		_task_pack_header(out, msg[i], len);
+		_route_msg_to_clients(out, msg[i]);
+	}
+
+	errno = save_errno;
+	return rc;
+}
+
 /**********************************************************************
  * Pseudo terminal functions
  **********************************************************************/
@@ -1235,6 +1319,7 @@ _send_connection_okay_response(slurmd_job_t *job)
 		xassert(client->magic == CLIENT_IO_MAGIC);
 		if (list_enqueue(client->msg_queue, msg))
 			msg->ref_count++;
+		eio_obj_changed(job->eio, eio);
 	}
 	list_iterator_destroy(clients);
 
@@ -1281,10 +1366,7 @@ static void
 _route_msg_task_to_client(eio_obj_t *obj)
 {
 	struct task_read_info *out = (struct task_read_info *)obj->arg;
-	struct client_io_info *client;
 	struct io_buf *msg = NULL;
-	eio_obj_t *eio;
-	ListIterator clients;
 
 	/* Pack task output into messages for transfer to a client */
 	while (cbuf_used(out->buf) > 0
@@ -1294,37 +1376,51 @@ _route_msg_task_to_client(eio_obj_t *obj)
 		if (msg == NULL)
 			return;
 
-		/* Add message to the msg_queue of all clients */
-		clients = list_iterator_create(out->job->clients);
-		while ((eio = list_next(clients))) {
-			client = (struct client_io_info *)eio->arg;
-			if (client->out_eof == true)
-				continue;
+		_route_msg_to_clients(out, msg);
+		/* the task is readable again once its cbuf has room */
+		eio_obj_changed(out->job->eio, obj);
+	}
+}
 
-			/* Some clients only take certain I/O streams */
-			if (out->type==SLURM_IO_STDOUT) {
-				if (client->ltaskid_stdout != -1 &&
-				    client->ltaskid_stdout != out->ltaskid)
-					continue;
-			}
-			if (out->type==SLURM_IO_STDERR) {
-				if (client->ltaskid_stderr != -1 &&
-				    client->ltaskid_stderr != out->ltaskid)
-					continue;
-			}
+/* Add a packed task output message to the msg_queue of all clients that
+ * take its stream, and to the outgoing message cache */
+static void
+_route_msg_to_clients(struct task_read_info *out, struct io_buf *msg)
+{
+	struct client_io_info *client;
+	eio_obj_t *eio;
+	ListIterator clients;
 
-			debug5("======================== Enqueued message");
-			xassert(client->magic == CLIENT_IO_MAGIC);
-			if (list_enqueue(client->msg_queue, msg))
-				msg->ref_count++;
+	clients = list_iterator_create(out->job->clients);
+	while ((eio = list_next(clients))) {
+		client = (struct client_io_info *)eio->arg;
+		if (client->out_eof == true)
+			continue;
+
+		/* Some clients only take certain I/O streams */
+		if (out->type==SLURM_IO_STDOUT) {
+			if (client->ltaskid_stdout != -1 &&
+			    client->ltaskid_stdout != out->ltaskid)
+				continue;
+		}
+		if (out->type==SLURM_IO_STDERR) {
+			if (client->ltaskid_stderr != -1 &&
+			    client->ltaskid_stderr != out->ltaskid)
+				continue;
 		}
-		list_iterator_destroy(clients);
 
-		/* Update the outgoing message cache */
-		if (list_enqueue(out->job->outgoing_cache, msg)) {
+		debug5("======================== Enqueued message");
+		xassert(client->magic == CLIENT_IO_MAGIC);
+		if (list_enqueue(client->msg_queue, msg))
 			msg->ref_count++;
-			_shrink_msg_cache(out->job->outgoing_cache, out->job);
-		}
+		eio_obj_changed(out->job->eio, eio);
+	}
+	list_iterator_destroy(clients);
+
+	/* Update the outgoing message cache */
+	if (list_enqueue(out->job->outgoing_cache, msg)) {
+		msg->ref_count++;
+		_shrink_msg_cache(out->job->outgoing_cache, out->job);
 	}
 }
 
@@ -1336,8 +1432,11 @@ _free_incoming_msg(struct io_buf *msg, slurmd_job_t *job)
 		/* Put the message back on the free List */
 		list_enqueue(job->free_incoming, msg);
 
-		/* Kick the event IO engine */
-		eio_signal_wakeup(job->eio);
+		/* Clients stop reading stdin while every buffer is in use,
+		 * so kick the event IO engine when the first one is back */
+		if ((list_count(job->free_incoming) == 1) &&
+		    (job->incoming_count >= STDIO_MAX_FREE_BUF))
+			eio_signal_wakeup(job->eio);
 	}
 }
 
@@ -1366,8 +1465,6 @@ _free_outgoing_msg(struct io_buf *msg, slurmd_job_t *job)
 					break;
 			}
 		}
-		/* Kick the event IO engine */
-		eio_signal_wakeup(job->eio);
 	}
 }
 
@@ -1773,6 +1870,7 @@ _send_eof_msg(struct task_read_info *out)
 
 		if (list_enqueue(client->msg_queue, msg))
 			msg->ref_count++;
+		eio_obj_changed(out->job->eio, eio);
 	}
 	list_iterator_destroy(clients);
 
@@ -1786,10 +1884,8 @@ _task_build_message(struct task_read_info *out, slurmd_job_t *job, cbuf_t cbuf)
 {
 	struct io_buf *msg;
 	char *ptr;
-	Buf packbuf;
 	bool must_truncate = false;
 	int avail;
-	struct slurm_io_header header;
 	int n;
 
 	debug4("Entering _task_build_message");
@@ -1828,12 +1924,25 @@ _task_build_message(struct task_read_info *out, slurmd_job_t *job, cbuf_t cbuf)
 		}
 	}
 
+	_task_pack_header(out, msg, n);
+
+	debug4("Leaving  _task_build_message");
+	return msg;
+}
+
+/* Pack the header for len bytes of task output already in msg's data */
+static void
+_task_pack_header(struct task_read_info *out, struct io_buf *msg, int len)
+{
+	Buf packbuf;
+	struct slurm_io_header header;
+
 	header.type = out->type;
 	header.ltaskid = out->ltaskid;
 	header.gtaskid = out->gtaskid;
-	header.length = n;
+	header.length = len;
 
-	debug5("  header.length = %d", n);
+	debug5("  header.length = %d", len);
 	packbuf = create_buf(msg->data, io_hdr_packed_size());
 	if (!packbuf)
 		fatal("Failure to allocate memory for a message header");
@@ -1844,9 +1953,6 @@ _task_build_message(struct task_read_info *out, slurmd_job_t *job, cbuf_t cbuf)
 	/* free the Buf packbuf, but not the memory to which it points */
 	packbuf->head = NULL;
 	free_buf(packbuf);
-
-	debug4("Leaving  _task_build_message");
-	return msg;
 }
 
 struct io_buf *
@@ -1904,10 +2010,12 @@ static bool
 _outgoing_buf_free(slurmd_job_t *job)
 {
 	struct io_buf *buf;
+	int max_buf = MAX(STDIO_MAX_FREE_BUF,
+			  job->node_tasks * STDIO_TASK_FREE_BUF);
 
 	if (list_count(job->free_outgoing) > 0) {
 		return true;
-	} else if (job->outgoing_count < STDIO_MAX_FREE_BUF) {
+	} else if (job->outgoing_count < max_buf) {
 		buf = alloc_io_buf();
 		if (buf != NULL) {
 			list_enqueue(job->free_outgoing, buf);
@@ -47,9 +47,16 @@
 /*
  * The message cache uses up free message buffers, so STDIO_MAX_MSG_CACHE
  * must be a number smaller than STDIO_MAX_FREE_BUF.
+ *
+ * Message buffers are allocated as needed, up to STDIO_MAX_FREE_BUF or
+ * STDIO_TASK_FREE_BUF per local task, whichever is larger.  Each task's
+ * output buffer starts at one message and grows to STDIO_MAX_TASK_BUF
+ * bytes while its output arrives faster than it can be sent.
  */
 #define STDIO_MAX_FREE_BUF 1024
+#define STDIO_TASK_FREE_BUF 64
 #define STDIO_MAX_MSG_CACHE 128
+#define STDIO_MAX_TASK_BUF (MAX_MSG_LEN * 64)
 
 struct io_buf {
 	int ref_count;
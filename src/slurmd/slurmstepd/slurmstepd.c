@@ -43,10 +43,12 @@
 #  include "config.h"
 #endif
 
+#include <errno.h>
 #include <unistd.h>
 #include <stdlib.h>
 #include <signal.h>
 
+#include "src/common/checkpoint.h"
 #include "src/common/cpu_frequency.h"
 #include "src/common/gres.h"
 #include "src/common/slurm_jobacct_gather.h"
@@ -61,6 +63,7 @@
 #include "src/slurmd/common/slurmstepd_init.h"
 #include "src/slurmd/common/setproctitle.h"
 #include "src/slurmd/common/proctrack.h"
+#include "src/slurmd/common/task_plugin.h"
 #include "src/slurmd/slurmd/slurmd.h"
 #include "src/slurmd/slurmstepd/mgr.h"
 #include "src/slurmd/slurmstepd/req.h"
@@ -72,6 +75,8 @@ static int _init_from_slurmd(int sock, char **argv, slurm_addr_t **_cli,
 			     int *_ngids, gid_t **_gids);
 
 static void _dump_user_env(void);
+static void _pool_wait(int sock, int *step_type);
+static void _read_conf_from_slurmd(int sock);
 static void _send_ok_to_slurmd(int sock);
 static void _send_fail_to_slurmd(int sock);
 static slurmd_job_t *_step_setup(slurm_addr_t *cli, slurm_addr_t *self,
@@ -345,6 +350,50 @@ rwfail:
 	error("Unable to send \"fail\" to slurmd");
 }
 
+/* receive conf from slurmd */
+static void
+_read_conf_from_slurmd(int sock)
+{
+	if ((conf = read_slurmd_conf_lite (sock)) == NULL)
+		fatal("Failed to read conf from slurmd");
+	log_alter(conf->log_opts, 0, conf->logfile);
+
+	debug2("debug level is %d.", conf->debug_level);
+	/* acct info */
+	jobacct_gather_startpoll(conf->job_acct_gather_freq);
+
+	switch_g_slurmd_step_init();
+}
+
+/*
+ *  A pooled slurmstepd loads its plugins ahead of time, then blocks until
+ *  slurmd hands it a step.  slurmd closes the pipe to drop the slurmstepd
+ *  from its pool, in which case just exit.
+ */
+static void
+_pool_wait(int sock, int *step_type)
+{
+	char *ckpt_type = slurm_get_checkpoint_type();
+	int len;
+
+	/* Failures are reported again by job_manager() */
+	if ((switch_init() != SLURM_SUCCESS)			||
+	    (slurmd_task_init() != SLURM_SUCCESS)		||
+	    (slurm_proctrack_init() != SLURM_SUCCESS)		||
+	    (checkpoint_init(ckpt_type) != SLURM_SUCCESS)	||
+	    (jobacct_gather_init() != SLURM_SUCCESS))
+		debug("Unable to preload plugins in pooled slurmstepd");
+	xfree(ckpt_type);
+
+	do {
+		len = read(sock, step_type, sizeof(int));
+	} while ((len < 0) && (errno == EINTR));
+	if (len == 0)
+		exit(0);
+	if (len != sizeof(int))
+		fatal("Error reading step type from slurmd: %m");
+}
+
 /*
  *  This function handles the initialization information from slurmd
  *  sent by _send_slurmstepd_init() in src/slurmd/slurmd/req.c.
@@ -365,12 +414,18 @@ _init_from_slurmd(int sock, char **argv,
 	gid_t *gids = NULL;
 	uint16_t port;
 	char buf[16];
+	bool pooled = false;
 	log_options_t lopts = LOG_OPTS_INITIALIZER;
 
 	log_init(argv[0], lopts, LOG_DAEMON, NULL);
 
 	/* receive job type from slurmd */
 	safe_read(sock, &step_type, sizeof(int));
+	if (step_type == STEPD_POOL_INIT) {
+		pooled = true;
+		_read_conf_from_slurmd(sock);
+		_pool_wait(sock, &step_type);
+	}
 	debug3("step_type = %d", step_type);
 
 	/* receive reverse-tree info from slurmd */
@@ -385,16 +440,9 @@ _init_from_slurmd(int sock, char **argv,
 	step_complete.jobacct = jobacctinfo_create(NULL);
 	pthread_mutex_unlock(&step_complete.lock);
 
-	/* receive conf from slurmd */
-	if ((conf = read_slurmd_conf_lite (sock)) == NULL)
-		fatal("Failed to read conf from slurmd");
-	log_alter(conf->log_opts, 0, conf->logfile);
-
-	debug2("debug level is %d.", conf->debug_level);
-	/* acct info */
-	jobacct_gather_startpoll(conf->job_acct_gather_freq);
-
-	switch_g_slurmd_step_init();
+	/* A pooled slurmstepd already has its conf */
+	if (!pooled)
+		_read_conf_from_slurmd(sock);
 
 	slurm_get_ip_str(&step_complete.parent_addr, &port, buf, 16);
 	debug3("slurmstepd rank %d, parent address = %s, port = %u",
@@ -3392,6 +3392,46 @@ static int   _send_mult_job_start(slurmdbd_conn_t *slurmdbd_conn,
 	return SLURM_SUCCESS;
 }
 
+/* Return true if a message within a DBD_SEND_MULT_MSG can be batched */
+static bool _batch_step_msg(Buf req_buf)
+{
+	uint16_t msg_type;
+
+	if (unpack16(&msg_type, req_buf) != SLURM_SUCCESS)
+		return false;
+	set_buf_offset(req_buf, 0);
+
+	return ((msg_type == DBD_STEP_START) ||
+		(msg_type == DBD_STEP_COMPLETE));
+}
+
+/* Write out a batch of step messages.  On failure the replies from
+ * first on are replaced with an error so the sender keeps those
+ * messages and sends them again.
+ * RET SLURM_SUCCESS or error code */
+static int _end_batch(slurmdbd_conn_t *slurmdbd_conn, List ret_list,
+		      int first)
+{
+	char *comment = "Failed to write batched step records";
+	ListIterator itr;
+	int rc, inx = 0;
+
+	rc = jobacct_storage_g_batch(slurmdbd_conn->db_conn, false);
+	if (rc == SLURM_SUCCESS)
+		return rc;
+
+	error("CONN:%u %s", slurmdbd_conn->newsockfd, comment);
+	itr = list_iterator_create(ret_list);
+	while (list_next(itr)) {
+		if (inx++ >= first)
+			list_delete_item(itr);
+	}
+	list_iterator_destroy(itr);
+	list_append(ret_list, make_dbd_rc_msg(slurmdbd_conn->rpc_version,
+					      rc, comment, DBD_SEND_MULT_MSG));
+	return rc;
+}
+
 static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			    Buf in_buffer, Buf *out_buffer,
 			    uint32_t *uid)
@@ -3401,7 +3441,7 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 	char *comment = NULL;
 	ListIterator itr = NULL;
 	Buf req_buf = NULL, ret_buf = NULL;
-	int rc = SLURM_SUCCESS;
+	int rc = SLURM_SUCCESS, batch_first = -1;
 
 	if (*uid != slurmdbd_conf->slurm_user_id) {
 		comment = "DBD_SEND_MULT_MSG message from invalid uid";
@@ -3425,8 +3465,26 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 
 	list_msg.my_list = list_create(slurmdbd_free_buffer);
 
+	/* Runs of step starts and completions are handed to the storage
+	 * as a batch, and nothing is acknowledged unless the batch is
+	 * written.  Other messages end the batch first so everything is
+	 * still stored in the order sent. */
 	itr = list_iterator_create(get_msg->my_list);
 	while ((req_buf = list_next(itr))) {
+		if (_batch_step_msg(req_buf)) {
+			if (batch_first < 0) {
+				jobacct_storage_g_batch(
+					slurmdbd_conn->db_conn, true);
+				batch_first = list_count(list_msg.my_list);
+			}
+		} else if (batch_first >= 0) {
+			rc = _end_batch(slurmdbd_conn, list_msg.my_list,
+					batch_first);
+			batch_first = -1;
+			if (rc != SLURM_SUCCESS)
+				break;
+		}
+
 		ret_buf = NULL;
 		rc = proc_req(slurmdbd_conn, get_buf_data(req_buf),
 			      size_buf(req_buf), 0, &ret_buf, uid);
@@ -3436,6 +3494,8 @@ static int   _send_mult_msg(slurmdbd_conn_t *slurmdbd_conn,
 			break;
 	}
 	list_iterator_destroy(itr);
+	if (batch_first >= 0)
+		_end_batch(slurmdbd_conn, list_msg.my_list, batch_first);
 
 	slurmdbd_free_list_msg(get_msg);
 
@@ -189,9 +189,8 @@ _print_job ( bool clear_old )
 							 params.user_id,
 							 show_flags);
 		} else {
-			error_code = slurm_load_jobs(
-				old_job_ptr->last_update,
-				&new_job_ptr, show_flags);
+			error_code = slurm_load_jobs_delta(
+				old_job_ptr, &new_job_ptr, show_flags);
 		}
 		if (error_code ==  SLURM_SUCCESS)
 			slurm_free_job_info_msg( old_job_ptr );
@@ -0,0 +1,337 @@
+/* Benchmark of the association, user and QOS indexes in
+ * src/common/assoc_mgr.c
+ *
+ * Builds users, QOS and a root, account and user association tree, saves
+ * it with dump_assoc_mgr_state() and loads it back the way slurmctld does
+ * when the database is down, so the lists are posted and indexed by
+ * assoc_mgr itself.  The lookups a job submission makes (user by uid,
+ * association by uid, account and partition, QOS by name) and association
+ * lookups by id are then timed through the assoc_mgr_fill_in_*()
+ * functions and compared with the list scans they replaced, and both are
+ * verified to find the same records.
+ *
+ * Usage: assoc-mgr-bench [associations [lookups]]
+ *	associations defaults to 10000, lookups to 10000.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "src/common/assoc_mgr.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "bench.h"
+
+#define BENCH_CLUSTER	"bench"
+#define BENCH_QOS_CNT	32
+#define USERS_PER_ACCT	100
+#define FIRST_UID	100000
+
+/* The association scan formerly used by assoc_mgr_fill_in_assoc() */
+static slurmdb_association_rec_t *_old_find_assoc(
+	slurmdb_association_rec_t *assoc)
+{
+	ListIterator itr;
+	slurmdb_association_rec_t *found_assoc, *ret_assoc = NULL;
+
+	itr = list_iterator_create(assoc_mgr_association_list);
+	while ((found_assoc = list_next(itr))) {
+		if (assoc->id) {
+			if (assoc->id == found_assoc->id) {
+				ret_assoc = found_assoc;
+				break;
+			}
+			continue;
+		}
+		if ((assoc->uid == NO_VAL) && (found_assoc->uid != NO_VAL))
+			continue;
+		else if (assoc->uid != found_assoc->uid)
+			continue;
+		if (found_assoc->acct
+		    && strcasecmp(assoc->acct, found_assoc->acct))
+			continue;
+		if (found_assoc->cluster
+		    && strcasecmp(assoc->cluster, found_assoc->cluster))
+			continue;
+		if (assoc->partition) {
+			if (!found_assoc->partition) {
+				ret_assoc = found_assoc;
+				continue;
+			} else if (strcasecmp(assoc->partition,
+					      found_assoc->partition))
+				continue;
+		} else if (found_assoc->partition)
+			continue;
+		ret_assoc = found_assoc;
+		break;
+	}
+	list_iterator_destroy(itr);
+
+	return ret_assoc;
+}
+
+/* The user scan formerly used by assoc_mgr_fill_in_user() */
+static slurmdb_user_rec_t *_old_find_user(uint32_t uid)
+{
+	ListIterator itr;
+	slurmdb_user_rec_t *found_user;
+
+	itr = list_iterator_create(assoc_mgr_user_list);
+	while ((found_user = list_next(itr))) {
+		if (uid == found_user->uid)
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	return found_user;
+}
+
+/* The QOS scan formerly used by assoc_mgr_fill_in_qos() */
+static slurmdb_qos_rec_t *_old_find_qos(char *name)
+{
+	ListIterator itr;
+	slurmdb_qos_rec_t *found_qos;
+
+	itr = list_iterator_create(assoc_mgr_qos_list);
+	while ((found_qos = list_next(itr))) {
+		if (!strcasecmp(name, found_qos->name))
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	return found_qos;
+}
+
+/* Build the lists with assoc_cnt associations in all, about one account
+ * per USERS_PER_ACCT users, and every tenth user with an extra
+ * association for the "debug" partition. */
+static void _build_lists(int assoc_cnt)
+{
+	slurmdb_association_rec_t *assoc;
+	slurmdb_user_rec_t *user;
+	slurmdb_qos_rec_t *qos;
+	uint32_t id = 1, acct_id = 0;
+	int i, user_cnt = 0;
+
+	assoc_mgr_user_list = list_create(slurmdb_destroy_user_rec);
+	assoc_mgr_qos_list = list_create(slurmdb_destroy_qos_rec);
+	assoc_mgr_association_list =
+		list_create(slurmdb_destroy_association_rec);
+
+	for (i = 0; i < BENCH_QOS_CNT; i++) {
+		qos = xmalloc(sizeof(slurmdb_qos_rec_t));
+		slurmdb_init_qos_rec(qos, 0);
+		qos->id = i + 1;
+		qos->name = xstrdup_printf("qos%d", i);
+		qos->usage = create_assoc_mgr_qos_usage();
+		list_append(assoc_mgr_qos_list, qos);
+	}
+
+	assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+	slurmdb_init_association_rec(assoc, 0);
+	assoc->usage = create_assoc_mgr_association_usage();
+	assoc->id = id++;
+	assoc->acct = xstrdup("root");
+	assoc->cluster = xstrdup(BENCH_CLUSTER);
+	list_append(assoc_mgr_association_list, assoc);
+
+	while (id <= assoc_cnt) {
+		if ((user_cnt % USERS_PER_ACCT) == 0) {
+			assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+			slurmdb_init_association_rec(assoc, 0);
+			assoc->usage = create_assoc_mgr_association_usage();
+			assoc->id = acct_id = id++;
+			assoc->parent_id = 1;
+			assoc->acct = xstrdup_printf("acct%u", acct_id);
+			assoc->cluster = xstrdup(BENCH_CLUSTER);
+			list_append(assoc_mgr_association_list, assoc);
+		}
+
+		/* Numeric names so uid_from_string() needs no passwd entry */
+		user = xmalloc(sizeof(slurmdb_user_rec_t));
+		user->name = xstrdup_printf("%d", FIRST_UID + user_cnt);
+		user->default_acct = xstrdup_printf("acct%u", acct_id);
+		user->admin_level = SLURMDB_ADMIN_NONE;
+		list_append(assoc_mgr_user_list, user);
+
+		for (i = 0; (i < 2) && (id <= assoc_cnt); i++) {
+			if (i && (user_cnt % 10))
+				break;
+			assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+			slurmdb_init_association_rec(assoc, 0);
+			assoc->usage = create_assoc_mgr_association_usage();
+			assoc->id = id++;
+			assoc->parent_id = acct_id;
+			assoc->acct = xstrdup_printf("acct%u", acct_id);
+			assoc->cluster = xstrdup(BENCH_CLUSTER);
+			assoc->user = xstrdup(user->name);
+			if (i)
+				assoc->partition = xstrdup("debug");
+			list_append(assoc_mgr_association_list, assoc);
+		}
+		user_cnt++;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	int assoc_cnt = 10000, lookups = 10000;
+	int i, errors = 0, user_cnt;
+	char dir[] = "/tmp/assoc-mgr-bench.XXXXXX", *file;
+	char *state_files[] = { "assoc_mgr_state", "assoc_usage",
+				"qos_usage", NULL };
+	slurmdb_association_rec_t **users, **targets, *assoc_ptr;
+	slurmdb_association_rec_t **old_res, **new_res;
+	slurmdb_user_rec_t **old_user, **new_user;
+	slurmdb_qos_rec_t **old_qos, **new_qos;
+	slurmdb_association_rec_t assoc;
+	slurmdb_user_rec_t user;
+	slurmdb_qos_rec_t qos;
+	ListIterator itr;
+	struct timeval tv1, tv2, tv3;
+	char *qos_names[BENCH_QOS_CNT];
+
+	if (argc > 1)
+		assoc_cnt = atoi(argv[1]);
+	if (argc > 2)
+		lookups = atoi(argv[2]);
+	if ((assoc_cnt < 3) || (lookups < 1)) {
+		printf("associations must be at least 3 "
+		       "and lookups at least 1\n");
+		return 1;
+	}
+	if (!mkdtemp(dir)) {
+		printf("can't create a state directory\n");
+		return 1;
+	}
+
+	_build_lists(assoc_cnt);
+	dump_assoc_mgr_state(dir);
+	assoc_mgr_fini(NULL);
+	if (load_assoc_mgr_state(dir) != SLURM_SUCCESS) {
+		printf("can't load association state from %s\n", dir);
+		return 1;
+	}
+	for (i = 0; state_files[i]; i++) {
+		file = xstrdup_printf("%s/%s", dir, state_files[i]);
+		unlink(file);
+		xfree(file);
+		file = xstrdup_printf("%s/%s.old", dir, state_files[i]);
+		unlink(file);
+		xfree(file);
+	}
+	rmdir(dir);
+
+	/* The user associations to look up, spread evenly over the list
+	 * so the list scans do not only find records near its head */
+	users = xmalloc(sizeof(slurmdb_association_rec_t *) * assoc_cnt);
+	user_cnt = 0;
+	itr = list_iterator_create(assoc_mgr_association_list);
+	while ((assoc_ptr = list_next(itr))) {
+		if (assoc_ptr->user)
+			users[user_cnt++] = assoc_ptr;
+	}
+	list_iterator_destroy(itr);
+	targets = xmalloc(sizeof(slurmdb_association_rec_t *) * lookups);
+	for (i = 0; i < lookups; i++)
+		targets[i] = users[((int64_t) i * user_cnt) / lookups];
+	for (i = 0; i < BENCH_QOS_CNT; i++)
+		qos_names[i] = xstrdup_printf("qos%d", i);
+
+	old_res  = xmalloc(sizeof(slurmdb_association_rec_t *) * lookups);
+	new_res  = xmalloc(sizeof(slurmdb_association_rec_t *) * lookups);
+	old_user = xmalloc(sizeof(slurmdb_user_rec_t *) * lookups);
+	new_user = xmalloc(sizeof(slurmdb_user_rec_t *) * lookups);
+	old_qos  = xmalloc(sizeof(slurmdb_qos_rec_t *) * lookups);
+	new_qos  = xmalloc(sizeof(slurmdb_qos_rec_t *) * lookups);
+
+	printf("%d associations, %d users, %d lookups\n",
+	       list_count(assoc_mgr_association_list),
+	       list_count(assoc_mgr_user_list), lookups);
+	bench_header("lookup");
+
+	/* A submission: user by uid, association by uid, account and
+	 * partition, then the job's QOS by name */
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < lookups; i++) {
+		assoc_ptr = targets[i];
+		old_user[i] = _old_find_user(assoc_ptr->uid);
+		memset(&assoc, 0, sizeof(slurmdb_association_rec_t));
+		assoc.uid = assoc_ptr->uid;
+		assoc.acct = old_user[i]->default_acct;
+		assoc.cluster = BENCH_CLUSTER;
+		assoc.partition = assoc_ptr->partition;
+		old_res[i] = _old_find_assoc(&assoc);
+		old_qos[i] = _old_find_qos(qos_names[i % BENCH_QOS_CNT]);
+	}
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < lookups; i++) {
+		assoc_ptr = targets[i];
+		memset(&user, 0, sizeof(slurmdb_user_rec_t));
+		user.uid = assoc_ptr->uid;
+		assoc_mgr_fill_in_user(NULL, &user, ACCOUNTING_ENFORCE_ASSOCS,
+				       &new_user[i]);
+		memset(&assoc, 0, sizeof(slurmdb_association_rec_t));
+		assoc.uid = assoc_ptr->uid;
+		assoc.acct = user.default_acct;
+		assoc.cluster = BENCH_CLUSTER;
+		assoc.partition = assoc_ptr->partition;
+		assoc_mgr_fill_in_assoc(NULL, &assoc,
+					ACCOUNTING_ENFORCE_ASSOCS,
+					&new_res[i]);
+		memset(&qos, 0, sizeof(slurmdb_qos_rec_t));
+		qos.name = qos_names[i % BENCH_QOS_CNT];
+		assoc_mgr_fill_in_qos(NULL, &qos, ACCOUNTING_ENFORCE_QOS,
+				      &new_qos[i]);
+	}
+	gettimeofday(&tv3, NULL);
+	for (i = 0; i < lookups; i++) {
+		if (!new_res[i] || (old_res[i] != new_res[i]) ||
+		    (new_res[i] != targets[i]) ||
+		    (old_user[i] != new_user[i]) ||
+		    !new_qos[i] || (old_qos[i] != new_qos[i]))
+			errors++;
+	}
+	bench_report("submit", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < lookups; i++) {
+		memset(&assoc, 0, sizeof(slurmdb_association_rec_t));
+		assoc.id = targets[i]->id;
+		old_res[i] = _old_find_assoc(&assoc);
+	}
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < lookups; i++) {
+		memset(&assoc, 0, sizeof(slurmdb_association_rec_t));
+		assoc.id = targets[i]->id;
+		assoc_mgr_fill_in_assoc(NULL, &assoc,
+					ACCOUNTING_ENFORCE_ASSOCS,
+					&new_res[i]);
+	}
+	gettimeofday(&tv3, NULL);
+	for (i = 0; i < lookups; i++) {
+		if ((old_res[i] != new_res[i]) ||
+		    (new_res[i] != targets[i]))
+			errors++;
+	}
+	bench_report("association id", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	assoc_mgr_fini(NULL);
+	for (i = 0; i < BENCH_QOS_CNT; i++)
+		xfree(qos_names[i]);
+	xfree(users);
+	xfree(targets);
+	xfree(old_res);
+	xfree(new_res);
+	xfree(old_user);
+	xfree(new_user);
+	xfree(old_qos);
+	xfree(new_qos);
+
+	return bench_fini(errors);
+}
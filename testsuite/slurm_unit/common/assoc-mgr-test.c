@@ -0,0 +1,410 @@
+/* Test of the association, user and QOS indexes in src/common/assoc_mgr.c
+ *
+ * Builds users, QOS and a root, account and user association tree, saves
+ * it with dump_assoc_mgr_state() and loads it back the way slurmctld does
+ * when the database is down, so the lists are posted and indexed by
+ * assoc_mgr itself.  Lookups through the assoc_mgr_fill_in_*() functions
+ * are compared with list scans, before and after the indexes are updated
+ * by assoc_mgr_update_assocs(), assoc_mgr_update_users() and
+ * assoc_mgr_update_qos().
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "src/common/assoc_mgr.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+#define TEST_CLUSTER	"test"
+#define TEST_ASSOC_CNT	1000
+#define TEST_QOS_CNT	8
+#define USERS_PER_ACCT	10
+#define FIRST_UID	100000
+
+/* Association scan matching what assoc_mgr_fill_in_assoc() returns */
+static slurmdb_association_rec_t *_scan_assoc(
+	slurmdb_association_rec_t *assoc)
+{
+	ListIterator itr;
+	slurmdb_association_rec_t *found_assoc, *ret_assoc = NULL;
+
+	itr = list_iterator_create(assoc_mgr_association_list);
+	while ((found_assoc = list_next(itr))) {
+		if (assoc->id) {
+			if (assoc->id == found_assoc->id) {
+				ret_assoc = found_assoc;
+				break;
+			}
+			continue;
+		}
+		if ((assoc->uid == NO_VAL) && (found_assoc->uid != NO_VAL))
+			continue;
+		else if (assoc->uid != found_assoc->uid)
+			continue;
+		if (found_assoc->acct
+		    && strcasecmp(assoc->acct, found_assoc->acct))
+			continue;
+		if (found_assoc->cluster
+		    && strcasecmp(assoc->cluster, found_assoc->cluster))
+			continue;
+		if (assoc->partition) {
+			if (!found_assoc->partition) {
+				ret_assoc = found_assoc;
+				continue;
+			} else if (strcasecmp(assoc->partition,
+					      found_assoc->partition))
+				continue;
+		} else if (found_assoc->partition)
+			continue;
+		ret_assoc = found_assoc;
+		break;
+	}
+	list_iterator_destroy(itr);
+
+	return ret_assoc;
+}
+
+static slurmdb_user_rec_t *_scan_user(uint32_t uid)
+{
+	ListIterator itr;
+	slurmdb_user_rec_t *found_user;
+
+	itr = list_iterator_create(assoc_mgr_user_list);
+	while ((found_user = list_next(itr))) {
+		if (uid == found_user->uid)
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	return found_user;
+}
+
+static slurmdb_qos_rec_t *_scan_qos(uint32_t id, char *name)
+{
+	ListIterator itr;
+	slurmdb_qos_rec_t *found_qos;
+
+	itr = list_iterator_create(assoc_mgr_qos_list);
+	while ((found_qos = list_next(itr))) {
+		if (id && (id == found_qos->id))
+			break;
+		if (!id && !strcasecmp(name, found_qos->name))
+			break;
+	}
+	list_iterator_destroy(itr);
+
+	return found_qos;
+}
+
+static slurmdb_user_rec_t *_find_user(uint32_t uid)
+{
+	slurmdb_user_rec_t user, *user_ptr = NULL;
+
+	memset(&user, 0, sizeof(slurmdb_user_rec_t));
+	user.uid = uid;
+	(void) assoc_mgr_fill_in_user(NULL, &user, ACCOUNTING_ENFORCE_ASSOCS,
+				      &user_ptr);
+	return user_ptr;
+}
+
+/* Find an association by id if set, else by uid, account and partition.
+ * Also compare with the list scan, counting differences in *errors. */
+static slurmdb_association_rec_t *_find_assoc(uint32_t id, uint32_t uid,
+					      char *acct, char *partition,
+					      int *errors)
+{
+	slurmdb_association_rec_t assoc, *assoc_ptr = NULL;
+
+	memset(&assoc, 0, sizeof(slurmdb_association_rec_t));
+	assoc.id = id;
+	assoc.uid = uid;
+	assoc.acct = acct;
+	assoc.cluster = TEST_CLUSTER;
+	assoc.partition = partition;
+	(void) assoc_mgr_fill_in_assoc(NULL, &assoc,
+				       ACCOUNTING_ENFORCE_ASSOCS, &assoc_ptr);
+	if (assoc_ptr != _scan_assoc(&assoc))
+		(*errors)++;
+	return assoc_ptr;
+}
+
+static slurmdb_qos_rec_t *_find_qos(uint32_t id, char *name)
+{
+	slurmdb_qos_rec_t qos, *qos_ptr = NULL;
+
+	memset(&qos, 0, sizeof(slurmdb_qos_rec_t));
+	qos.id = id;
+	qos.name = name;
+	(void) assoc_mgr_fill_in_qos(NULL, &qos, ACCOUNTING_ENFORCE_QOS,
+				     &qos_ptr);
+	return qos_ptr;
+}
+
+/* Build the lists with assoc_cnt associations in all, an account per
+ * USERS_PER_ACCT users, and every tenth user with an extra association for
+ * the "debug" partition. */
+static void _build_lists(int assoc_cnt)
+{
+	slurmdb_association_rec_t *assoc;
+	slurmdb_user_rec_t *user;
+	slurmdb_qos_rec_t *qos;
+	uint32_t id = 1, acct_id = 0;
+	int i, user_cnt = 0;
+
+	assoc_mgr_user_list = list_create(slurmdb_destroy_user_rec);
+	assoc_mgr_qos_list = list_create(slurmdb_destroy_qos_rec);
+	assoc_mgr_association_list =
+		list_create(slurmdb_destroy_association_rec);
+
+	for (i = 0; i < TEST_QOS_CNT; i++) {
+		qos = xmalloc(sizeof(slurmdb_qos_rec_t));
+		slurmdb_init_qos_rec(qos, 0);
+		qos->id = i + 1;
+		qos->name = xstrdup_printf("qos%d", i);
+		qos->usage = create_assoc_mgr_qos_usage();
+		list_append(assoc_mgr_qos_list, qos);
+	}
+
+	assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+	slurmdb_init_association_rec(assoc, 0);
+	assoc->usage = create_assoc_mgr_association_usage();
+	assoc->id = id++;
+	assoc->acct = xstrdup("root");
+	assoc->cluster = xstrdup(TEST_CLUSTER);
+	list_append(assoc_mgr_association_list, assoc);
+
+	while (id <= assoc_cnt) {
+		if ((user_cnt % USERS_PER_ACCT) == 0) {
+			assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+			slurmdb_init_association_rec(assoc, 0);
+			assoc->usage = create_assoc_mgr_association_usage();
+			assoc->id = acct_id = id++;
+			assoc->parent_id = 1;
+			assoc->acct = xstrdup_printf("acct%u", acct_id);
+			assoc->cluster = xstrdup(TEST_CLUSTER);
+			list_append(assoc_mgr_association_list, assoc);
+		}
+
+		/* Numeric names so uid_from_string() needs no passwd entry */
+		user = xmalloc(sizeof(slurmdb_user_rec_t));
+		user->name = xstrdup_printf("%d", FIRST_UID + user_cnt);
+		user->default_acct = xstrdup_printf("acct%u", acct_id);
+		user->admin_level = SLURMDB_ADMIN_NONE;
+		list_append(assoc_mgr_user_list, user);
+
+		for (i = 0; (i < 2) && (id <= assoc_cnt); i++) {
+			if (i && (user_cnt % 10))
+				break;
+			assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+			slurmdb_init_association_rec(assoc, 0);
+			assoc->usage = create_assoc_mgr_association_usage();
+			assoc->id = id++;
+			assoc->parent_id = acct_id;
+			assoc->acct = xstrdup_printf("acct%u", acct_id);
+			assoc->cluster = xstrdup(TEST_CLUSTER);
+			assoc->user = xstrdup(user->name);
+			if (i)
+				assoc->partition = xstrdup("debug");
+			list_append(assoc_mgr_association_list, assoc);
+		}
+		user_cnt++;
+	}
+}
+
+/* Save and load the lists so assoc_mgr posts and indexes them */
+static int _load_lists(void)
+{
+	char dir[] = "/tmp/assoc-mgr-test.XXXXXX", *file;
+	char *state_files[] = { "assoc_mgr_state", "assoc_usage",
+				"qos_usage", NULL };
+	int i, rc;
+
+	if (!mkdtemp(dir))
+		return SLURM_ERROR;
+	dump_assoc_mgr_state(dir);
+	assoc_mgr_fini(NULL);
+	rc = load_assoc_mgr_state(dir);
+	for (i = 0; state_files[i]; i++) {
+		file = xstrdup_printf("%s/%s", dir, state_files[i]);
+		(void) unlink(file);
+		xfree(file);
+		file = xstrdup_printf("%s/%s.old", dir, state_files[i]);
+		(void) unlink(file);
+		xfree(file);
+	}
+	(void) rmdir(dir);
+
+	return rc;
+}
+
+/* RET count of lookups of every user association, its user and every QOS
+ * that differ from the list scans */
+static int _check_all(void)
+{
+	ListIterator itr;
+	slurmdb_association_rec_t *assoc;
+	slurmdb_user_rec_t *user;
+	slurmdb_qos_rec_t *qos;
+	int errors = 0;
+
+	itr = list_iterator_create(assoc_mgr_association_list);
+	while ((assoc = list_next(itr))) {
+		if (!assoc->user)
+			continue;
+		user = _find_user(assoc->uid);
+		if (!user || (user != _scan_user(assoc->uid)) ||
+		    (_find_assoc(0, assoc->uid, user->default_acct,
+				 assoc->partition, &errors) != assoc) ||
+		    (_find_assoc(assoc->id, 0, NULL, NULL, &errors) != assoc))
+			errors++;
+	}
+	list_iterator_destroy(itr);
+
+	itr = list_iterator_create(assoc_mgr_qos_list);
+	while ((qos = list_next(itr))) {
+		if ((_find_qos(0, qos->name) != qos) ||
+		    (_find_qos(qos->id, NULL) != qos))
+			errors++;
+	}
+	list_iterator_destroy(itr);
+
+	return errors;
+}
+
+/* Run one update of the given type on a single object */
+static int _update(uint16_t type, void *object)
+{
+	slurmdb_update_object_t update;
+	int rc = SLURM_ERROR;
+
+	memset(&update, 0, sizeof(slurmdb_update_object_t));
+	update.type = type;
+	update.objects = list_create(NULL);
+	list_append(update.objects, object);
+	switch (type) {
+	case SLURMDB_ADD_ASSOC:
+	case SLURMDB_REMOVE_ASSOC:
+		rc = assoc_mgr_update_assocs(&update);
+		break;
+	case SLURMDB_MODIFY_USER:
+		rc = assoc_mgr_update_users(&update);
+		break;
+	case SLURMDB_REMOVE_QOS:
+		rc = assoc_mgr_update_qos(&update);
+		break;
+	}
+	list_destroy(update.objects);
+
+	return rc;
+}
+
+int
+main(int argc, char *argv[])
+{
+	slurmdb_association_rec_t *assoc, *user_assoc;
+	slurmdb_user_rec_t *user;
+	slurmdb_qos_rec_t *qos;
+	uint32_t uid = FIRST_UID + 10, new_uid = FIRST_UID + 100000;
+	uint32_t new_id = TEST_ASSOC_CNT + 1;
+	char *acct;
+	int errors = 0;
+
+	_build_lists(TEST_ASSOC_CNT);
+	TEST(_load_lists() == SLURM_SUCCESS, "load association state");
+	if (!assoc_mgr_association_list) {
+		totals();
+		return failed;
+	}
+
+	note("Testing lookups");
+	TEST(_check_all() == 0, "lookups match list scans");
+	TEST(_find_user(FIRST_UID - 1) == NULL, "unknown user");
+	TEST(_find_assoc(new_id, 0, NULL, NULL, &errors) == NULL,
+	     "unknown association id");
+	TEST(_find_qos(0, "normal") == NULL, "unknown qos");
+
+	note("Testing association add and remove");
+	user = _find_user(uid);
+	acct = user ? user->default_acct : "acct2";
+	user_assoc = _find_assoc(0, uid, acct, NULL, &errors);
+	assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+	slurmdb_init_association_rec(assoc, 0);
+	assoc->id = new_id;
+	assoc->parent_id = user_assoc ? user_assoc->parent_id : 0;
+	assoc->acct = xstrdup(acct);
+	assoc->cluster = xstrdup(TEST_CLUSTER);
+	assoc->user = xstrdup_printf("%u", uid);
+	assoc->partition = xstrdup("batch");
+	TEST(_update(SLURMDB_ADD_ASSOC, assoc) == SLURM_SUCCESS,
+	     "add association");
+	TEST(_find_assoc(new_id, 0, NULL, NULL, &errors) == assoc,
+	     "find added association by id");
+	TEST(_find_assoc(0, uid, acct, "batch", &errors) == assoc,
+	     "find added association by partition");
+	TEST(_find_assoc(0, uid, acct, NULL, &errors) == user_assoc,
+	     "find other association of user");
+
+	assoc = xmalloc(sizeof(slurmdb_association_rec_t));
+	slurmdb_init_association_rec(assoc, 0);
+	assoc->id = new_id;
+	assoc->cluster = xstrdup(TEST_CLUSTER);
+	TEST(_update(SLURMDB_REMOVE_ASSOC, assoc) == SLURM_SUCCESS,
+	     "remove association");
+	TEST(_find_assoc(new_id, 0, NULL, NULL, &errors) == NULL,
+	     "removed association not found by id");
+	TEST(_find_assoc(0, uid, acct, "batch", &errors) == user_assoc,
+	     "removed partition falls back to user association");
+	TEST(_check_all() == 0, "lookups match list scans");
+
+	note("Testing user rename");
+	user = xmalloc(sizeof(slurmdb_user_rec_t));
+	user->old_name = xstrdup_printf("%u", uid);
+	user->name = xstrdup_printf("%u", new_uid);
+	user->admin_level = SLURMDB_ADMIN_NOTSET;
+	TEST(_update(SLURMDB_MODIFY_USER, user) == SLURM_SUCCESS,
+	     "rename user");
+	user = _find_user(new_uid);
+	TEST(user && (user->uid == new_uid), "find renamed user by new uid");
+	TEST(_find_user(uid) == NULL, "renamed user not found by old uid");
+	assoc = _find_assoc(0, new_uid, acct, NULL, &errors);
+	TEST(assoc && (assoc == user_assoc) && (assoc->uid == new_uid),
+	     "find association of renamed user by new uid");
+	TEST(_find_assoc(0, uid, acct, NULL, &errors) == NULL,
+	     "association of renamed user not found by old uid");
+	TEST(_find_assoc(0, new_uid, acct, "debug", &errors) != NULL,
+	     "find partition association of renamed user");
+	TEST(_check_all() == 0, "lookups match list scans");
+
+	note("Testing QOS removal");
+	qos = xmalloc(sizeof(slurmdb_qos_rec_t));
+	slurmdb_init_qos_rec(qos, 0);
+	qos->id = 3;
+	qos->name = xstrdup("qos2");
+	TEST(_update(SLURMDB_REMOVE_QOS, qos) == SLURM_SUCCESS, "remove qos");
+	TEST(_find_qos(0, "qos2") == NULL, "removed qos not found by name");
+	TEST(_find_qos(3, NULL) == NULL, "removed qos not found by id");
+	TEST((_scan_qos(0, "qos2") == NULL) && (_scan_qos(3, NULL) == NULL),
+	     "removed qos not in list");
+	TEST(list_count(assoc_mgr_qos_list) == (TEST_QOS_CNT - 1),
+	     "other qos kept");
+	TEST(_check_all() == 0, "lookups match list scans");
+
+	TEST(errors == 0, "lookups by uid, account and partition match scans");
+
+	assoc_mgr_fini(NULL);
+	totals();
+	return failed;
+}
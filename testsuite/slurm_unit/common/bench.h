@@ -0,0 +1,44 @@
+/* Timing and reporting shared by the benchmarks in this directory.
+ *
+ * Each benchmark times the current implementation against the one it
+ * replaced, reports both, and counts result mismatches between them.
+ * The equivalence checks proper are in the unit tests run by "make check".
+ */
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stdio.h>
+#include <sys/time.h>
+
+/* RET microseconds from tv1 to tv2 */
+static inline long bench_delta_usec(struct timeval *tv1,
+				     struct timeval *tv2)
+{
+	return ((tv2->tv_sec - tv1->tv_sec) * 1000000) +
+	       (tv2->tv_usec - tv1->tv_usec);
+}
+
+static inline void bench_header(char *what)
+{
+	printf("%-22s %12s %12s %9s\n", what, "old usec", "new usec",
+	       "speedup");
+}
+
+static inline void bench_report(char *name, long old_usec, long new_usec)
+{
+	printf("%-22s %12ld %12ld %8.1fx\n", name, old_usec, new_usec,
+	       new_usec ? ((double) old_usec / new_usec) : 0.0);
+}
+
+/* RET the benchmark's exit code */
+static inline int bench_fini(int errors)
+{
+	if (errors) {
+		printf("FAILED: %d result mismatches\n", errors);
+		return 1;
+	}
+	return 0;
+}
+
+#endif /* __BENCH_H__ */
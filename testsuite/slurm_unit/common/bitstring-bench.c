@@ -0,0 +1,218 @@
+/* Benchmark of the word level kernels in src/common/bitstring.c
+ *
+ * Compares bit_set_count() and bit_overlap() with the shift and mask
+ * hamming weight they replaced, bit_ffs() and bit_nffc() with the bit at a
+ * time searches they replaced, plus bit_overlap() and bit_overlap_any() with
+ * the copy, and, count sequence they avoid, and verifies that both give
+ * the same results.
+ *
+ * Usage: bitstring-bench [bits [iterations]]
+ *	bits defaults to 10000 (a bitmap per node of a large cluster),
+ *	iterations to 10000.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/common/bitstring.h"
+
+#include "bench.h"
+
+/* The hamming weight formerly used by bitstring.c, 32 bit words only */
+static uint32_t _hweight(uint32_t w)
+{
+	uint32_t res;
+
+	res = (w   & 0x55555555) + ((w >> 1)    & 0x55555555);
+	res = (res & 0x33333333) + ((res >> 2)  & 0x33333333);
+	res = (res & 0x0F0F0F0F) + ((res >> 4)  & 0x0F0F0F0F);
+	res = (res & 0x00FF00FF) + ((res >> 8)  & 0x00FF00FF);
+	res = (res & 0x0000FFFF) + ((res >> 16) & 0x0000FFFF);
+
+	return res;
+}
+
+static int _scalar_set_count(bitstr_t *b)
+{
+	bitoff_t bit;
+	int count = 0, word_size = sizeof(bitstr_t) * 8;
+
+	for (bit = 0; (bit + word_size) <= bit_size(b); bit += word_size)
+		count += _hweight(b[_bit_word(bit)]);
+	for ( ; bit < bit_size(b); bit++) {
+		if (bit_test(b, bit))
+			count++;
+	}
+	return count;
+}
+
+static int _scalar_overlap(bitstr_t *b1, bitstr_t *b2)
+{
+	bitoff_t bit;
+	int count = 0, word_size = sizeof(bitstr_t) * 8;
+
+	for (bit = 0; (bit + word_size) <= bit_size(b1); bit += word_size) {
+		count += _hweight(b1[_bit_word(bit)] &
+				  b2[_bit_word(bit)]);
+	}
+	for ( ; bit < bit_size(b1); bit++) {
+		if (bit_test(b1, bit) && bit_test(b2, bit))
+			count++;
+	}
+	return count;
+}
+
+static bitoff_t _scalar_ffs(bitstr_t *b)
+{
+	bitoff_t bit = 0;
+	int word_size = sizeof(bitstr_t) * 8;
+
+	while (bit < bit_size(b)) {
+		if (((bit % word_size) == 0) && (b[_bit_word(bit)] == 0)) {
+			bit += word_size;
+			continue;
+		}
+		if (bit_test(b, bit))
+			return bit;
+		bit++;
+	}
+	return -1;
+}
+
+static bitoff_t _scalar_nffc(bitstr_t *b, int n)
+{
+	bitoff_t bit;
+	int cnt = 0;
+
+	for (bit = 0; bit < bit_size(b); bit++) {
+		if (bit_test(b, bit)) {
+			cnt = 0;
+		} else if (++cnt >= n) {
+			return (bit - (cnt - 1));
+		}
+	}
+	return -1;
+}
+
+static int _copy_and_count(bitstr_t *b1, bitstr_t *b2)
+{
+	bitstr_t *tmp = bit_copy(b1);
+	int count;
+
+	bit_and(tmp, b2);
+	count = bit_set_count(tmp);
+	bit_free(tmp);
+	return count;
+}
+
+int main(int argc, char *argv[])
+{
+	int nbits = 10000, iters = 10000;
+	int i, errors = 0;
+	long old_sum, new_sum;
+	bitstr_t *b1, *b2, *b3;
+	struct timeval tv1, tv2, tv3;
+
+	if (argc > 1)
+		nbits = atoi(argv[1]);
+	if (argc > 2)
+		iters = atoi(argv[2]);
+	if (nbits < 100) {
+		printf("bits must be at least 100\n");
+		return 1;
+	}
+
+	/* b1 and b2 random, b3 mostly allocated with one late gap */
+	b1 = bit_alloc(nbits);
+	b2 = bit_alloc(nbits);
+	b3 = bit_alloc(nbits);
+	srand(nbits);
+	for (i = 0; i < nbits; i++) {
+		if (rand() % 2)
+			bit_set(b1, i);
+		if (rand() % 3 == 0)
+			bit_set(b2, i);
+	}
+	bit_nset(b3, 0, nbits - 1);
+	bit_nclear(b3, nbits - 40, nbits - 9);
+
+	bench_header("kernel");
+
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += _scalar_set_count(b1);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_set_count(b1);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("bit_set_count", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += _scalar_overlap(b1, b2);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_overlap(b1, b2);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("bit_overlap", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += _copy_and_count(b1, b2);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_overlap(b1, b2);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("copy/and/count", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += (bit_overlap(b3, b2) != 0);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_overlap_any(b3, b2);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("bit_overlap_any", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	bit_nclear(b2, 0, nbits - 2);
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += _scalar_ffs(b2);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_ffs(b2);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("bit_ffs", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	old_sum = new_sum = 0;
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < iters; i++)
+		old_sum += _scalar_nffc(b3, 32);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < iters; i++)
+		new_sum += bit_nffc(b3, 32);
+	gettimeofday(&tv3, NULL);
+	errors += (old_sum != new_sum);
+	bench_report("bit_nffc", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+
+	bit_free(b1);
+	bit_free(b2);
+	bit_free(b3);
+
+	return bench_fini(errors);
+}
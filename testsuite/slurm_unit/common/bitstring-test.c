@@ -14,6 +14,55 @@
 		pass( _msg );		\
 } while (0)
 
+/* Bit at a time references for the word level functions */
+static int _ref_set_count(bitstr_t *b)
+{
+	bitoff_t bit;
+	int count = 0;
+
+	for (bit = 0; bit < bit_size(b); bit++) {
+		if (bit_test(b, bit))
+			count++;
+	}
+	return count;
+}
+
+static int _ref_overlap(bitstr_t *b1, bitstr_t *b2)
+{
+	bitoff_t bit;
+	int count = 0;
+
+	for (bit = 0; bit < bit_size(b1); bit++) {
+		if (bit_test(b1, bit) && bit_test(b2, bit))
+			count++;
+	}
+	return count;
+}
+
+static bitoff_t _ref_ffs(bitstr_t *b)
+{
+	bitoff_t bit;
+
+	for (bit = 0; bit < bit_size(b); bit++) {
+		if (bit_test(b, bit))
+			return bit;
+	}
+	return -1;
+}
+
+static bitoff_t _ref_nffc(bitstr_t *b, int n)
+{
+	bitoff_t bit;
+	int cnt = 0;
+
+	for (bit = 0; bit < bit_size(b); bit++) {
+		if (bit_test(b, bit))
+			cnt = 0;
+		else if (++cnt >= n)
+			return (bit - (cnt - 1));
+	}
+	return -1;
+}
 
 int
 main(int argc, char *argv[])
@@ -179,6 +228,99 @@ main(int argc, char *argv[])
 		bit_free(bs);
 	}
 
+	note("Testing word boundaries and unused bits");
+	{
+		bitstr_t *bs1 = bit_alloc(100), *bs2 = bit_alloc(100);
+
+		TEST(bit_ffs(bs1) == -1, "ffs empty");
+		TEST(bit_fls(bs1) == -1, "fls empty");
+		TEST(bit_ffc(bs1) == 0, "ffc empty");
+		bit_not(bs1);		/* also sets unused bits 100-127 */
+		TEST(bit_set_count(bs1) == 100, "count after not");
+		TEST(bit_ffc(bs1) == -1, "ffc full");
+		TEST(bit_fls(bs1) == 99, "fls full");
+		bit_nclear(bs1, 0, 63);
+		TEST(bit_ffs(bs1) == 64, "ffs word boundary");
+		TEST(bit_ffc(bs1) == 0, "ffc");
+		TEST(bit_nffc(bs1, 64) == 0, "nffc whole words");
+		TEST(bit_nffc(bs1, 65) == -1, "nffc");
+		TEST(bit_set_count_range(bs1, 30, 97) == 33, "count range");
+
+		bit_set(bs2, 99);
+		TEST(bit_overlap(bs1, bs2) == 1, "overlap");
+		TEST(bit_overlap_any(bs1, bs2) == 1, "overlap any");
+		bit_clear(bs2, 99);
+		bit_set(bs2, 63);
+		TEST(bit_overlap(bs1, bs2) == 0, "no overlap");
+		TEST(bit_overlap_any(bs1, bs2) == 0, "no overlap any");
+		bit_set(bs2, 64);
+		TEST(bit_overlap_any(bs1, bs2) == 1, "overlap any");
+		TEST(bit_super_set(bs2, bs1) == 0, "super set");
+		bit_clear(bs2, 63);
+		TEST(bit_super_set(bs2, bs1) == 1, "super set");
+
+		bit_not(bs2);		/* unused bits of both bitmaps set */
+		bit_nclear(bs2, 64, 99);
+		TEST(bit_overlap(bs1, bs2) == 0, "overlap unused bits");
+		TEST(bit_overlap_any(bs1, bs2) == 0,
+		     "overlap any unused bits");
+
+		bit_free(bs1);
+		bit_free(bs2);
+	}
+
+	note("Testing word level functions against bit at a time scans");
+	{
+		int sizes[] = { 1, 31, 32, 33, 63, 64, 65, 100, 1000, 10000, 0 };
+		int i, j, n, errors = 0;
+		bitstr_t *bs1, *bs2, *bs3;
+
+		srand(1);
+		for (i = 0; (n = sizes[i]); i++) {
+			bs1 = bit_alloc(n);
+			bs2 = bit_alloc(n);
+			for (j = 0; j < n; j++) {
+				if (rand() % 2)
+					bit_set(bs1, j);
+				if (rand() % 3 == 0)
+					bit_set(bs2, j);
+			}
+			/* bs3 mostly set with one late gap */
+			bs3 = bit_alloc(n);
+			bit_nset(bs3, 0, n - 1);
+			if (n > 40)
+				bit_nclear(bs3, n - 40, n - 9);
+
+			errors += (bit_set_count(bs1) != _ref_set_count(bs1));
+			errors += (bit_set_count(bs3) != _ref_set_count(bs3));
+			errors += (bit_overlap(bs1, bs2) !=
+				   _ref_overlap(bs1, bs2));
+			errors += (bit_overlap_any(bs1, bs2) !=
+				   (_ref_overlap(bs1, bs2) != 0));
+			errors += (bit_overlap_any(bs3, bs2) !=
+				   (_ref_overlap(bs3, bs2) != 0));
+			for (j = 1; (j <= 64) && (j < n); j *= 2) {
+				errors += (bit_nffc(bs1, j) !=
+					   _ref_nffc(bs1, j));
+				errors += (bit_nffc(bs3, j) !=
+					   _ref_nffc(bs3, j));
+			}
+			errors += (bit_ffs(bs1) != _ref_ffs(bs1));
+			bit_nclear(bs2, 0, n - 1);
+			errors += (bit_ffs(bs2) != -1);
+			errors += (bit_overlap_any(bs1, bs2) != 0);
+			bit_set(bs2, n - 1);
+			errors += (bit_ffs(bs2) != n - 1);
+			errors += (bit_overlap(bs3, bs2) !=
+				   _ref_overlap(bs3, bs2));
+
+			bit_free(bs1);
+			bit_free(bs2);
+			bit_free(bs3);
+		}
+		TEST(errors == 0, "word level functions");
+	}
+
 	note("Testing bit_unfmt");
 	{
 		bitstr_t *bs = bit_alloc(1024);
@@ -0,0 +1,172 @@
+/* Benchmark of list_sort() in src/common/list.c
+ *
+ * Compares list_sort() against the insertion sort it replaced, on lists of
+ * random keys containing duplicates, and verifies that the result is
+ * ordered and stable.
+ *
+ * Usage: list-sort-bench [max_count [max_insertion_count]]
+ *	max_count defaults to 1000000. The insertion sort is O(n^2), so it is
+ *	only timed for lists up to max_insertion_count (default 10000).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "src/common/list.h"
+
+#include "bench.h"
+
+typedef struct {
+	int key;
+	int seq;	/* original position, to verify stability */
+} bench_rec_t;
+
+typedef struct bench_node {
+	void *data;
+	struct bench_node *next;
+} bench_node_t;
+
+static int _cmp_rec(void *x, void *y)
+{
+	bench_rec_t *rec1 = (bench_rec_t *) x;
+	bench_rec_t *rec2 = (bench_rec_t *) y;
+
+	if (rec1->key < rec2->key)
+		return -1;
+	if (rec1->key > rec2->key)
+		return 1;
+	return 0;
+}
+
+/* The algorithm formerly used by list_sort(), applied to a bare linked list
+ * with the same node layout */
+static void _insertion_sort(bench_node_t **head, ListCmpF f)
+{
+	bench_node_t **pp, **ppPrev, **ppPos, *pTmp;
+
+	if (!*head)
+		return;
+	ppPrev = head;
+	pp = &(*ppPrev)->next;
+	while (*pp) {
+		if (f((*pp)->data, (*ppPrev)->data) < 0) {
+			ppPos = head;
+			while (f((*pp)->data, (*ppPos)->data) >= 0)
+				ppPos = &(*ppPos)->next;
+			pTmp = (*pp)->next;
+			(*pp)->next = *ppPos;
+			*ppPos = *pp;
+			*pp = pTmp;
+			if (ppPrev == ppPos)
+				ppPrev = &(*ppPrev)->next;
+		} else {
+			ppPrev = pp;
+			pp = &(*pp)->next;
+		}
+	}
+}
+
+/* Return 0 if records are in key order with ties in original order */
+static int _check_order(bench_rec_t *prev, bench_rec_t *rec)
+{
+	if (!prev)
+		return 0;
+	if (prev->key > rec->key)
+		return 1;
+	if ((prev->key == rec->key) && (prev->seq > rec->seq))
+		return 1;
+	return 0;
+}
+
+static long _bench_list_sort(bench_rec_t *recs, int count, int *errors)
+{
+	List list = list_create(NULL);
+	ListIterator iter;
+	bench_rec_t *rec, *prev = NULL;
+	struct timeval tv1, tv2;
+	int i;
+
+	for (i = 0; i < count; i++)
+		list_append(list, &recs[i]);
+
+	gettimeofday(&tv1, NULL);
+	list_sort(list, _cmp_rec);
+	gettimeofday(&tv2, NULL);
+
+	iter = list_iterator_create(list);
+	for (i = 0; (rec = list_next(iter)); i++) {
+		*errors += _check_order(prev, rec);
+		prev = rec;
+	}
+	list_iterator_destroy(iter);
+	if (i != count)
+		(*errors)++;
+	list_destroy(list);
+
+	return bench_delta_usec(&tv1, &tv2);
+}
+
+static long _bench_insertion_sort(bench_rec_t *recs, int count, int *errors)
+{
+	bench_node_t *nodes, *head = NULL, *node;
+	bench_rec_t *prev = NULL;
+	struct timeval tv1, tv2;
+	int i;
+
+	nodes = malloc(sizeof(bench_node_t) * count);
+	for (i = count - 1; i >= 0; i--) {
+		nodes[i].data = &recs[i];
+		nodes[i].next = head;
+		head = &nodes[i];
+	}
+
+	gettimeofday(&tv1, NULL);
+	_insertion_sort(&head, _cmp_rec);
+	gettimeofday(&tv2, NULL);
+
+	for (i = 0, node = head; node; i++, node = node->next) {
+		*errors += _check_order(prev, node->data);
+		prev = node->data;
+	}
+	if (i != count)
+		(*errors)++;
+	free(nodes);
+
+	return bench_delta_usec(&tv1, &tv2);
+}
+
+int main(int argc, char *argv[])
+{
+	int max_count = 1000000, max_insertion = 10000;
+	int count, errors = 0, i;
+	bench_rec_t *recs;
+	long usec;
+
+	if (argc > 1)
+		max_count = atoi(argv[1]);
+	if (argc > 2)
+		max_insertion = atoi(argv[2]);
+
+	printf("%10s %16s %16s\n", "count", "list_sort usec",
+	       "insertion usec");
+	for (count = 1000; count <= max_count; count *= 10) {
+		recs = malloc(sizeof(bench_rec_t) * count);
+		srand(count);
+		for (i = 0; i < count; i++) {
+			recs[i].key = rand() % (count / 2 + 1);
+			recs[i].seq = i;
+		}
+
+		printf("%10d ", count);
+		usec = _bench_list_sort(recs, count, &errors);
+		printf("%16ld ", usec);
+		if (count <= max_insertion) {
+			usec = _bench_insertion_sort(recs, count, &errors);
+			printf("%16ld\n", usec);
+		} else
+			printf("%16s\n", "skipped");
+		fflush(stdout);
+		free(recs);
+	}
+
+	return bench_fini(errors);
+}
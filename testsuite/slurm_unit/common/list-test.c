@@ -0,0 +1,116 @@
+/* Test of list_sort() in src/common/list.c
+ */
+#include <stdlib.h>
+
+#include "src/common/list.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+typedef struct {
+	int key;
+	int seq;	/* original position, to verify stability */
+} test_rec_t;
+
+static int _cmp_rec(void *x, void *y)
+{
+	test_rec_t *rec1 = (test_rec_t *) x;
+	test_rec_t *rec2 = (test_rec_t *) y;
+
+	if (rec1->key < rec2->key)
+		return -1;
+	if (rec1->key > rec2->key)
+		return 1;
+	return 0;
+}
+
+/* Sort count records with keys from key_f and check the result
+ * RET 0 if all records are in key order with ties in original order */
+static int _sort_check(int count, int (*key_f)(int))
+{
+	List list = list_create(NULL);
+	ListIterator iter;
+	test_rec_t *recs, *rec, *prev = NULL;
+	int i, errors = 0;
+
+	recs = xmalloc(sizeof(test_rec_t) * (count + 1));
+	for (i = 0; i < count; i++) {
+		recs[i].key = key_f(i);
+		recs[i].seq = i;
+		list_append(list, &recs[i]);
+	}
+	list_sort(list, _cmp_rec);
+
+	iter = list_iterator_create(list);
+	for (i = 0; (rec = list_next(iter)); i++) {
+		if (prev && ((prev->key > rec->key) ||
+			     ((prev->key == rec->key) &&
+			      (prev->seq > rec->seq))))
+			errors++;
+		prev = rec;
+	}
+	list_iterator_destroy(iter);
+	if ((i != count) || (list_count(list) != count))
+		errors++;
+
+	/* The list must still be usable at both ends */
+	list_append(list, &recs[count]);
+	if (list_count(list) != (count + 1))
+		errors++;
+	list_destroy(list);
+	xfree(recs);
+
+	return errors;
+}
+
+static int _random_key(int i)
+{
+	return rand() % 100;
+}
+
+static int _ascending_key(int i)
+{
+	return i;
+}
+
+static int _descending_key(int i)
+{
+	return -i;
+}
+
+static int _equal_key(int i)
+{
+	return 7;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int sizes[] = { 0, 1, 2, 3, 10, 1000, 100000, -1 };
+	int i;
+	char *msg;
+
+	note("Testing list_sort");
+	srand(1);
+	for (i = 0; sizes[i] >= 0; i++) {
+		msg = xstrdup_printf("sort %d random keys", sizes[i]);
+		TEST(_sort_check(sizes[i], _random_key) == 0, msg);
+		xfree(msg);
+	}
+	TEST(_sort_check(1000, _ascending_key) == 0, "sort sorted keys");
+	TEST(_sort_check(1000, _descending_key) == 0, "sort reversed keys");
+	TEST(_sort_check(1000, _equal_key) == 0, "sort equal keys");
+
+	totals();
+	return failed;
+}
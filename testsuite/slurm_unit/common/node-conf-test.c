@@ -0,0 +1,111 @@
+/* Test of the node name hash and ranges in src/common/node_conf.c
+ */
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/bitstring.h"
+#include "src/common/node_conf.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+/* Build a node table of nodes names like fmt, as read_slurm_conf() would */
+static void _build_table(int nodes, char *fmt)
+{
+	int i;
+
+	node_record_count = nodes;
+	node_record_table_ptr = xmalloc(sizeof(struct node_record) * nodes);
+	for (i = 0; i < nodes; i++) {
+		node_record_table_ptr[i].magic = NODE_MAGIC;
+		node_record_table_ptr[i].name  = xstrdup_printf(fmt, i);
+	}
+	rehash_node();
+}
+
+static void _free_table(void)
+{
+	int i;
+
+	for (i = 0; i < node_record_count; i++)
+		xfree(node_record_table_ptr[i].name);
+	xfree(node_record_table_ptr);
+	node_record_count = 0;
+}
+
+/* RET count of names find_node_record() does not map to their own record */
+static int _find_all(void)
+{
+	int i, errors = 0;
+
+	for (i = 0; i < node_record_count; i++) {
+		if (find_node_record(node_record_table_ptr[i].name) !=
+		    &node_record_table_ptr[i])
+			errors++;
+	}
+	return errors;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int sizes[] = { 1, 2, 3, 100, 1000, 20001, 0 };
+	int i;
+	char *msg;
+	bitstr_t *bitmap = NULL;
+
+	note("Testing find_node_record");
+	for (i = 0; sizes[i]; i++) {
+		_build_table(sizes[i], "nid%05d");
+		msg = xstrdup_printf("find %d nodes", sizes[i]);
+		TEST(_find_all() == 0, msg);
+		xfree(msg);
+		_free_table();
+	}
+
+	_build_table(1000, "tux%d");
+	node_record_table_ptr = xrealloc(node_record_table_ptr,
+					 sizeof(struct node_record) * 3000);
+	for (i = 1000; i < 3000; i++) {
+		node_record_table_ptr[i].magic = NODE_MAGIC;
+		node_record_table_ptr[i].name  = xstrdup_printf("tux%d", i);
+	}
+	node_record_count = 3000;
+	rehash_node();
+	TEST(_find_all() == 0, "find nodes after growing the table");
+	_free_table();
+
+	note("Testing node_name2bitmap");
+	_build_table(1000, "nid%05d");
+	TEST(node_name2bitmap("nid[00010-00019,00500]", false, &bitmap) ==
+	     SLURM_SUCCESS, "map a range");
+	TEST(bit_set_count(bitmap) == 11, "range count");
+	TEST((bit_ffs(bitmap) == 10) && (bit_fls(bitmap) == 500),
+	     "range bits");
+	TEST(bit_nffs(bitmap, 10) == 10, "range bits contiguous");
+	FREE_NULL_BITMAP(bitmap);
+	TEST(node_name2bitmap("nid[00000-00999]", false, &bitmap) ==
+	     SLURM_SUCCESS, "map every node");
+	TEST(bit_set_count(bitmap) == 1000, "every node count");
+	FREE_NULL_BITMAP(bitmap);
+	TEST(node_name2bitmap("nid[00998-00999],nid00001", false, &bitmap) ==
+	     SLURM_SUCCESS, "map a range and a name");
+	TEST(bit_set_count(bitmap) == 3, "range and name count");
+	TEST(bit_test(bitmap, 1) && bit_test(bitmap, 999),
+	     "range and name bits");
+	FREE_NULL_BITMAP(bitmap);
+	_free_table();
+
+	totals();
+	return failed;
+}
@@ -0,0 +1,129 @@
+/* Benchmark of the node name hash in src/common/node_conf.c
+ *
+ * Builds a node table of names like nid00001 and resolves every name
+ * through find_node_record() until the requested number of lookups is
+ * reached, comparing with the sum of char*position hash modulo
+ * node_record_count it replaced, and verifies that both find the same
+ * records.
+ *
+ * Usage: node-hash-bench [nodes [lookups]]
+ *	nodes defaults to 20000, lookups to 100000.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "src/common/node_conf.h"
+#include "src/common/xmalloc.h"
+#include "src/common/xstring.h"
+
+#include "bench.h"
+
+/* The hash formerly used by node_conf.c */
+static int _old_hash_index(char *name)
+{
+	int index = 0;
+	int j;
+
+	for (j = 1; *name; name++, j++)
+		index += (int)*name * j;
+	index %= node_record_count;
+	if (index < 0)
+		index += node_record_count;
+
+	return index;
+}
+
+/* Chain heads and links for the old hash, kept apart from node_next so
+ * both tables can be probed from the same node records */
+static int *old_head = NULL, *old_next = NULL;
+
+static void _old_rehash(void)
+{
+	int i, inx;
+
+	old_head = xmalloc(sizeof(int) * node_record_count);
+	old_next = xmalloc(sizeof(int) * node_record_count);
+	for (i = 0; i < node_record_count; i++)
+		old_head[i] = -1;
+	for (i = 0; i < node_record_count; i++) {
+		inx = _old_hash_index(node_record_table_ptr[i].name);
+		old_next[i] = old_head[inx];
+		old_head[inx] = i;
+	}
+}
+
+static struct node_record *_old_find(char *name, int *probes)
+{
+	int i;
+
+	for (i = old_head[_old_hash_index(name)]; i >= 0; i = old_next[i]) {
+		(*probes)++;
+		if (!strcmp(node_record_table_ptr[i].name, name))
+			return &node_record_table_ptr[i];
+	}
+	return NULL;
+}
+
+int main(int argc, char *argv[])
+{
+	int nodes = 20000, lookups = 100000;
+	int i, errors = 0, probes = 0;
+	char **names;
+	struct node_record **old_res, **new_res;
+	struct timeval tv1, tv2, tv3;
+
+	if (argc > 1)
+		nodes = atoi(argv[1]);
+	if (argc > 2)
+		lookups = atoi(argv[2]);
+	if (nodes < 1) {
+		printf("nodes must be at least 1\n");
+		return 1;
+	}
+
+	node_record_count = nodes;
+	node_record_table_ptr = xmalloc(sizeof(struct node_record) * nodes);
+	for (i = 0; i < nodes; i++) {
+		node_record_table_ptr[i].magic = NODE_MAGIC;
+		node_record_table_ptr[i].name  = xstrdup_printf("nid%05d", i);
+	}
+	rehash_node();
+	_old_rehash();
+
+	names   = xmalloc(sizeof(char *) * lookups);
+	old_res = xmalloc(sizeof(struct node_record *) * lookups);
+	new_res = xmalloc(sizeof(struct node_record *) * lookups);
+	for (i = 0; i < lookups; i++)
+		names[i] = node_record_table_ptr[i % nodes].name;
+
+	bench_header("kernel");
+
+	gettimeofday(&tv1, NULL);
+	for (i = 0; i < lookups; i++)
+		old_res[i] = _old_find(names[i], &probes);
+	gettimeofday(&tv2, NULL);
+	for (i = 0; i < lookups; i++)
+		new_res[i] = find_node_record(names[i]);
+	gettimeofday(&tv3, NULL);
+	for (i = 0; i < lookups; i++) {
+		if ((old_res[i] != new_res[i]) ||
+		    (new_res[i] != &node_record_table_ptr[i % nodes]))
+			errors++;
+	}
+	bench_report("find_node_record", bench_delta_usec(&tv1, &tv2),
+		     bench_delta_usec(&tv2, &tv3));
+	printf("old hash averaged %.1f probes per lookup\n",
+	       (double) probes / lookups);
+
+	for (i = 0; i < nodes; i++)
+		xfree(node_record_table_ptr[i].name);
+	xfree(node_record_table_ptr);
+	xfree(old_head);
+	xfree(old_next);
+	xfree(names);
+	xfree(old_res);
+	xfree(new_res);
+
+	return bench_fini(errors);
+}
@@ -0,0 +1,278 @@
+/* Test of the SlurmDBD RPC spool in src/common/slurmdbd_defs.c
+ *
+ * The spool functions are static, so the source is included here with
+ * small segments to exercise segment rollover.
+ */
+#define SPOOL_SEG_SIZE	4096
+#include "src/common/slurmdbd_defs.c"
+
+#include <testsuite/dejagnu.h>
+
+/* Test for failure:
+*/
+#define TEST(_tst, _msg) do {		\
+	if (! (_tst))			\
+		fail( _msg );		\
+	else				\
+		pass( _msg );		\
+} while (0)
+
+static char state_dir[] = "/tmp/slurmdbd-spool-test.XXXXXX";
+
+/* An RPC identified by its cpu_count */
+static Buf _rpc(uint32_t id)
+{
+	slurmdbd_msg_t req;
+	dbd_cluster_cpus_msg_t msg;
+
+	memset(&msg, 0, sizeof(dbd_cluster_cpus_msg_t));
+	msg.cpu_count = id;
+	msg.cluster_nodes = "tux[0-15]";
+	req.msg_type = DBD_CLUSTER_CPUS;
+	req.data = &msg;
+	return pack_slurmdbd_msg(&req, SLURMDBD_VERSION);
+}
+
+static uint32_t _rpc_id(Buf buffer)
+{
+	slurmdbd_msg_t resp;
+	uint32_t id = NO_VAL;
+
+	set_buf_offset(buffer, 0);
+	if (unpack_slurmdbd_msg(&resp, SLURMDBD_VERSION, buffer)
+	    == SLURM_SUCCESS) {
+		id = ((dbd_cluster_cpus_msg_t *) resp.data)->cpu_count;
+		slurmdbd_free_cluster_cpus_msg(resp.data);
+	}
+	return id;
+}
+
+static int _open(void)
+{
+	agent_list = list_create(slurmdbd_free_buffer);
+	return _spool_open();
+}
+
+/* Close the spool as the agent does when it exits */
+static void _close(void)
+{
+	_save_dbd_state();
+	list_destroy(agent_list);
+	agent_list = NULL;
+}
+
+/* Drop the spool without saving its head, as if the daemon died */
+static void _crash(void)
+{
+	(void) close(spool->head_fd);
+	(void) close(spool->write_fd);
+	if (spool->read_map)
+		(void) munmap(spool->read_map, spool->read_map_len);
+	list_destroy(spool->mem_list);
+	xfree(spool->dir);
+	xfree(spool);
+	list_destroy(agent_list);
+	agent_list = NULL;
+}
+
+static void _add(uint32_t first, uint32_t cnt)
+{
+	uint32_t i;
+
+	for (i = 0; i < cnt; i++)
+		(void) _agent_enqueue(_rpc(first + i));
+}
+
+/* Take up to cnt RPCs as the agent does once the SlurmDBD has them
+ * RET how many of them were in order from *next */
+static uint32_t _take(uint32_t cnt, uint32_t *next)
+{
+	uint32_t i;
+	Buf buffer;
+
+	for (i = 0; i < cnt; i++) {
+		_spool_fill();
+		if (!(buffer = _agent_dequeue()))
+			break;
+		if (_rpc_id(buffer) != *next) {
+			free_buf(buffer);
+			break;
+		}
+		free_buf(buffer);
+		(*next)++;
+	}
+	return i;
+}
+
+static int _seg_cnt(void)
+{
+	DIR *dir = opendir(state_dir);
+	struct dirent *ent;
+	int cnt = 0;
+
+	while (dir && (ent = readdir(dir))) {
+		if (!strncmp(ent->d_name, "dbd.spool.", 10) &&
+		    isdigit((int) ent->d_name[10]))
+			cnt++;
+	}
+	if (dir)
+		closedir(dir);
+	return cnt;
+}
+
+/* RET offset of the magic ending the first RPC after the version header
+ * of a segment, records being the size, data and magic */
+static off_t _first_rpc_magic(char *fname)
+{
+	uint32_t hdr_size = 0, msg_size = 0;
+	off_t off;
+	int fd = open(fname, O_RDONLY);
+
+	if (fd < 0)
+		return 0;
+	if (read(fd, &hdr_size, sizeof(uint32_t)) != sizeof(uint32_t))
+		hdr_size = 0;
+	off = hdr_size + 2 * sizeof(uint32_t);
+	if (pread(fd, &msg_size, sizeof(uint32_t), off) != sizeof(uint32_t))
+		msg_size = 0;
+	(void) close(fd);
+	return off + sizeof(uint32_t) + msg_size;
+}
+
+static void _cleanup(void)
+{
+	DIR *dir = opendir(state_dir);
+	struct dirent *ent;
+	char *fname;
+
+	while (dir && (ent = readdir(dir))) {
+		if (ent->d_name[0] == '.')
+			continue;
+		fname = xstrdup_printf("%s/%s", state_dir, ent->d_name);
+		(void) unlink(fname);
+		xfree(fname);
+	}
+	if (dir)
+		closedir(dir);
+	(void) rmdir(state_dir);
+}
+
+int
+main(int argc, char *argv[])
+{
+	char *conf, *fname;
+	uint32_t next, last_seg, magic = 0;
+	int fd, segs;
+	struct stat stat_buf;
+	FILE *fp;
+
+	if (!mkdtemp(state_dir)) {
+		perror("mkdtemp");
+		return 1;
+	}
+	conf = xstrdup_printf("%s/slurm.conf", state_dir);
+	fp = fopen(conf, "w");
+	fprintf(fp, "ControlMachine=localhost\nClusterName=test\n"
+		"PluginDir=%s\nStateSaveLocation=%s\n", state_dir, state_dir);
+	fclose(fp);
+	setenv("SLURM_CONF", conf, 1);
+
+	note("Testing append and dequeue across segments");
+	TEST(_open() == SLURM_SUCCESS, "open empty spool");
+	_add(0, 1000);
+	TEST(spool->rec_cnt == 1000, "append 1000 RPCs");
+	segs = _seg_cnt();
+	TEST(segs > 2, "append rolls over to new segments");
+	next = 0;
+	TEST(_take(500, &next) == 500, "dequeue 500 RPCs in order");
+	TEST(spool->rec_cnt == 500, "dequeue counts RPCs taken");
+	TEST(_seg_cnt() < segs, "dequeue removes finished segments");
+
+	note("Testing reopen after a crash");
+	_crash();
+	TEST(_open() == SLURM_SUCCESS, "reopen spool after crash");
+	next = 1000 - spool->rec_cnt;
+	TEST((next > 0) && (next <= 500),
+	     "reopen resumes from a saved head");
+	(void) _take(1000, &next);
+	TEST(next == 1000, "reopen resends the rest in order");
+	TEST(spool->rec_cnt == 0, "spool is empty");
+	_close();
+
+	note("Testing reopen with a truncated tail");
+	TEST(_open() == SLURM_SUCCESS, "reopen empty spool");
+	TEST(spool->rec_cnt == 0, "reopen finds nothing pending");
+	_add(1000, 10);
+	last_seg = spool->write_seg;
+	_close();
+	fname = xstrdup_printf("%s/dbd.spool.%u", state_dir, last_seg);
+	if ((stat(fname, &stat_buf) == 0) && (stat_buf.st_size > 3) &&
+	    truncate(fname, stat_buf.st_size - 3))
+		perror("truncate");
+	xfree(fname);
+	TEST(_open() == SLURM_SUCCESS, "reopen truncated spool");
+	TEST(spool->rec_cnt == 9, "reopen cuts off the truncated RPC");
+	_add(2000, 1);
+	next = 1000;
+	TEST(_take(9, &next) == 9, "reopen resends whole RPCs in order");
+	next = 2000;
+	TEST(_take(1, &next) == 1, "append after the truncated RPC");
+	TEST(spool->rec_cnt == 0, "spool is empty");
+	_close();
+
+	note("Testing a corrupted spool");
+	TEST(_open() == SLURM_SUCCESS, "reopen spool");
+	_add(3000, 20);
+	last_seg = spool->write_seg;
+	_close();
+	TEST(_open() == SLURM_SUCCESS, "reopen spool with 20 RPCs");
+	TEST(spool->rec_cnt == 20, "reopen counts 20 RPCs");
+	fname = xstrdup_printf("%s/dbd.spool.%u", state_dir, last_seg);
+	fd = open(fname, O_WRONLY);
+	/* Clobber the magic ending the first RPC in the last segment */
+	if (pwrite(fd, &magic, sizeof(uint32_t), _first_rpc_magic(fname))
+	    != sizeof(uint32_t))
+		perror("pwrite");
+	(void) close(fd);
+	xfree(fname);
+	next = 3000;
+	(void) _take(20, &next);
+	TEST(next < 3020, "corrupted RPCs are skipped");
+	TEST(list_count(agent_list) == 0, "agent list is empty");
+	TEST(spool->rec_cnt == 0, "skipped RPCs are not counted");
+	_close();
+
+	note("Testing RPCs the spool can not take");
+	TEST(_open() == SLURM_SUCCESS, "reopen spool");
+	fd = spool->write_fd;
+	spool->write_fd = open("/dev/null", O_RDONLY);
+	_add(4000, 2);
+	TEST(spool->rec_cnt == 0, "failed writes are not spooled");
+	TEST(list_count(spool->mem_list) == 2, "failed writes are queued");
+	(void) close(spool->write_fd);
+	spool->write_fd = fd;
+	_add(4002, 1);
+	TEST(list_count(spool->mem_list) == 3,
+	     "queue keeps order behind failed writes");
+	next = 4000;
+	TEST(_take(3, &next) == 3, "queued RPCs dequeued in order");
+	_add(4003, 1);
+	TEST(spool->rec_cnt == 1, "spooling resumes once queue drains");
+	TEST(_take(1, &next) == 1, "spooled RPC follows queued ones");
+	fd = spool->write_fd;
+	spool->write_fd = open("/dev/null", O_RDONLY);
+	_add(4004, 1);
+	(void) close(spool->write_fd);
+	spool->write_fd = fd;
+	_close();
+	TEST(_open() == SLURM_SUCCESS, "reopen spool");
+	_load_dbd_state();
+	TEST(spool->rec_cnt == 1, "queued RPC saved over restart");
+	TEST(_take(1, &next) == 1, "saved RPC resent");
+	_close();
+
+	_cleanup();
+	xfree(conf);
+	totals();
+	return failed;
+}